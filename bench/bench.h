@@ -0,0 +1,194 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file bench.h
+ * @brief 微基準框架：逐次計時、扣除量測開銷，AVR 上另報告堆疊最高水位
+ * @details 每個案例由 prepare（不計時，重置狀態 / 清空輸出佇列）與 run（計時）組成，
+ *          每次呼叫單獨計時並記錄最小 / 平均 / 最大值：
+ *          - AVR（env:bench_avr）：Timer1 無分頻計數 CPU 週期，計時期間關中斷，
+ *            在 simavr 下結果逐週期精確；執行前以 BENCH_STACK_PAINT 塗滿堆疊空閒區，
+ *            之後找出被改寫的最低位址，即為該案例的堆疊使用量
+ *          - native（env:bench）：CLOCK_MONOTONIC 奈秒，不報告堆疊
+ *          結果以固定欄位文字輸出，便於 CI 以腳本比較基準線。
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "hal.h"
+
+#if defined(ARDUINO_ARCH_AVR)
+#include <avr/io.h>
+#define BENCH_ITERS         64
+#define BENCH_UNIT          "cycles"
+#define BENCH_STACK_PAINT   0xC5
+#define BENCH_STACK_MARGIN  32        // 塗色時保留給目前框架的位元組
+#else
+#include <time.h>
+#define BENCH_ITERS         20000
+#define BENCH_UNIT          "ns"
+#endif
+
+struct BenchCase {
+  const char* name;   // PROGMEM
+  void (*prepare)();  // 每次計時前呼叫（可為 NULL）
+  void (*run)();
+};
+
+struct BenchResult {
+  uint32_t min;
+  uint32_t max;
+  uint32_t mean;
+  int stack;          // 位元組；-1 = 不支援
+};
+
+// ============================================
+// 計時
+// ============================================
+
+#if defined(ARDUINO_ARCH_AVR)
+
+// Timer1 正常模式、無分頻：每個 CPU 週期加一，溢位一次（>65535 週期）由 TOV1 補償
+static inline void benchTimerStart() {
+  TCCR1A = 0;
+  TCCR1B = _BV(CS10);
+  TIFR1 = _BV(TOV1);
+  TCNT1 = 0;
+}
+
+static inline uint32_t benchTimerStop() {
+  uint16_t t = TCNT1;
+  return (TIFR1 & _BV(TOV1)) ? (uint32_t)t + 65536UL : t;
+}
+
+#else
+
+static uint64_t benchT0;
+
+static inline uint64_t benchNowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void benchTimerStart() { benchT0 = benchNowNs(); }
+static inline uint32_t benchTimerStop() { return (uint32_t)(benchNowNs() - benchT0); }
+
+#endif
+
+// ============================================
+// 堆疊最高水位（AVR）
+// ============================================
+
+#if defined(ARDUINO_ARCH_AVR)
+
+extern uint8_t __heap_start;
+extern char* __brkval;
+
+static uint8_t* benchStackFloor() {
+  return __brkval ? (uint8_t*)__brkval : &__heap_start;
+}
+
+// 塗滿 heap 頂端到目前 SP 之間的空閒區，返回塗色起點
+static uint8_t* benchStackPaint() {
+  uint8_t* lo = benchStackFloor();
+  uint8_t* hi = (uint8_t*)SP - BENCH_STACK_MARGIN;
+  for (uint8_t* p = lo; p < hi; p++) *p = BENCH_STACK_PAINT;
+  return lo;
+}
+
+// 自塗色區底部往上找第一個被改寫的位元組
+static uint8_t* benchStackLowest(uint8_t* lo) {
+  uint8_t* hi = (uint8_t*)SP - BENCH_STACK_MARGIN;
+  while (lo < hi && *lo == BENCH_STACK_PAINT) lo++;
+  return lo;
+}
+
+#endif
+
+// ============================================
+// 執行
+// ============================================
+
+static BenchResult benchRun(const BenchCase& c, uint32_t overhead) {
+  BenchResult r = { 0xFFFFFFFFUL, 0, 0, -1 };
+  uint64_t sum = 0;
+
+#if defined(ARDUINO_ARCH_AVR)
+  uint8_t* painted = benchStackPaint();
+  uint8_t* top = (uint8_t*)SP;
+#endif
+
+  for (uint16_t i = 0; i < BENCH_ITERS; i++) {
+    if (c.prepare) c.prepare();
+    uint32_t t;
+    {
+      HalAtomic lock;
+      benchTimerStart();
+      c.run();
+      t = benchTimerStop();
+    }
+    t = t > overhead ? t - overhead : 0;
+    if (t < r.min) r.min = t;
+    if (t > r.max) r.max = t;
+    sum += t;
+  }
+  r.mean = (uint32_t)(sum / BENCH_ITERS);
+
+#if defined(ARDUINO_ARCH_AVR)
+  r.stack = (int)(top - benchStackLowest(painted));
+#endif
+  return r;
+}
+
+// 以空案例的最小值作為量測開銷（計時器讀寫與函數呼叫）
+static uint32_t benchCalibrate(void (*empty)()) {
+  BenchCase c = { "", NULL, empty };
+  return benchRun(c, 0).min;
+}
+
+// s 位於 PROGMEM
+static void benchPrintPadded(Print& out, const char* s, uint8_t width) {
+  out.print((const __FlashStringHelper*)s);
+  for (size_t n = strlen_P(s); n < width; n++) out.write(' ');
+}
+
+static void benchPrintHeader(Print& out) {
+  benchPrintPadded(out, PSTR("benchmark"), 32);
+  out.print(F("iters      min     mean      max  unit    stack\n"));
+}
+
+static void benchPrintNum(Print& out, uint32_t v, uint8_t width) {
+  char buf[12];
+  snprintf(buf, sizeof(buf), "%*lu", width, (unsigned long)v);
+  out.print(buf);
+}
+
+static void benchPrintResult(Print& out, const char* name, const BenchResult& r) {
+  benchPrintPadded(out, name, 32);
+  benchPrintNum(out, BENCH_ITERS, 5);
+  benchPrintNum(out, r.min, 9);
+  benchPrintNum(out, r.mean, 9);
+  benchPrintNum(out, r.max, 9);
+  out.print(F("  "));
+  benchPrintPadded(out, PSTR(BENCH_UNIT), 6);
+  if (r.stack >= 0) benchPrintNum(out, (uint32_t)r.stack, 7);
+  else out.print(F("      -"));
+  out.print('\n');
+}
+
+#endif // BENCH_H
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file bench_main.cpp
+ * @brief 固件熱路徑微基準（env:bench = 主機、env:bench_avr = ATmega328P / simavr）
+ * @details 直接編入 src/main.cpp（其 setup()/loop() 改名）以呼叫檔內 static 函數，
+ *          不啟動背景搬運、不連接舵機：僅設定舵機 ID，讓命令處理走正常路徑。
+ *          每次計時前清空 PC / 總線傳送佇列，因此量到的是命令本身的成本，
+ *          不含串口實際傳送時間。
+ *
+ *          AVR 執行：simavr -m atmega328p -f 16000000 .pio/build/bench_avr/firmware.elf
+ *          （結果經 UART0 輸出；結束時關中斷休眠，simavr 隨之退出）
+ */
+
+#define setup firmwareSetup
+#define loop firmwareLoop
+#include "../src/main.cpp"
+#undef setup
+#undef loop
+
+#include "bench.h"
+
+#if defined(ARDUINO_ARCH_AVR)
+#include <avr/sleep.h>
+#endif
+
+static volatile int benchSink;
+static volatile int benchAngle = 0;
+static ReadJob benchJob;
+static char benchLine[CMD_MAX_LENGTH];   // handlePcLine 就地解析，每次計時前重新填入
+
+// ============================================
+// 前置（不計時）
+// ============================================
+
+static void benchReset() {
+  pcOut.clear();
+  busOut.clear();
+  trajEnabled = TRAJ_ENABLED_DEFAULT;
+}
+
+static void benchNextAngle() {
+  benchReset();
+  benchAngle = (benchAngle + 37) % (SERVO_MAX_ANGLE + 1);
+}
+
+// line 位於 PROGMEM
+static void benchSetLine(const char* line) {
+  benchReset();
+  strncpy_P(benchLine, line, sizeof(benchLine) - 1);
+}
+
+static void benchPrepLed() { benchSetLine(PSTR("<LED:1>")); }
+static void benchPrepMove() { benchSetLine(PSTR("<MOVE:90,45>")); }
+static void benchPrepPos() { benchSetLine(PSTR("<POS>")); }
+static void benchPrepUnknown() { benchSetLine(PSTR("<NOPE:1>")); }
+static void benchPrepRaw() { benchSetLine(PSTR("#001P1500T1000!")); }
+
+static void benchDirectMove() {
+  benchPrepMove();
+  trajEnabled = false;
+}
+
+// 追蹤中：每次計時為一個控制週期（兩軸 PID + 設定點送出）
+static void benchPrepTrack() {
+  benchReset();
+  trackUpdate(40, -20, 40);
+}
+
+static void benchFeedLine() {
+  benchReset();
+  clearBuf(pcBuf, pcBufLen);
+  for (const char* p = "<LED:1>\n"; *p; p++) pcRx.push((uint8_t)*p);
+}
+
+// ============================================
+// 計時案例
+// ============================================
+
+static void benchEmpty() {}
+
+static void benchLineRun() { handlePcLine(benchLine); }
+static void benchTaskPcRx() { taskPcRx(); }
+
+static void benchParseArgs() {
+  CmdArgs args;
+  cmdScanArgs("90,45", ARGS_INT2, args);
+  benchSink = args.v[1];
+}
+
+static void benchParseTokens() {
+  CmdArgs args;
+  cmdScanArgs("POS+TEMP,100", ARGS_TOKENS, args);
+  benchSink = args.v[2];
+}
+
+// 表中最後一列：線性查表的最差情況
+static void benchFindCommand() {
+  CmdEntry cmd;
+  benchSink = findCommand(cmdHash("VOLTAGE"), cmd);
+}
+
+static void benchAngleToPos() { benchSink = angleToPosition(benchAngle); }
+static void benchPosToAngle() { benchSink = positionToAngle(benchAngle * 3); }
+
+// 逐位元組送入（與 taskBusRx 相同），總成本即每筆回覆的解析成本
+static void benchParseBusReply() {
+  static const char reply[] = "#001V7400T035!";
+  BusReplyParser p;
+  for (const char* s = reply; *s; s++) p.feed(*s);
+  benchSink = p.reply().v[1];
+}
+
+static void benchTaskTrack() { taskTrack(); }
+
+static void benchSendOk() { sendOk(); }
+static void benchEmitStatusJson() { benchJob.reply.binary = false; emitStatus(benchJob); }
+static void benchEmitStatusBin() { benchJob.reply.binary = true; emitStatus(benchJob); }
+
+static void benchCrc16Bytes() {
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i < 16; i++) crc = crc8Update(crc, (uint8_t)(i * 29));
+  benchSink = crc;
+}
+
+// 案例清單：名稱存於 PROGMEM，表本身也留在 Flash，執行時逐列讀出
+#define BENCH_LIST(X) \
+  X(LINE_LED,     "handlePcLine <LED:1>",        benchPrepLed,     benchLineRun) \
+  X(LINE_MOVE,    "handlePcLine <MOVE:90,45>",   benchPrepMove,    benchLineRun) \
+  X(LINE_DIRECT,  "handlePcLine <MOVE> direct",  benchDirectMove,  benchLineRun) \
+  X(LINE_POS,     "handlePcLine <POS>",          benchPrepPos,     benchLineRun) \
+  X(LINE_UNKNOWN, "handlePcLine unknown",        benchPrepUnknown, benchLineRun) \
+  X(LINE_RAW,     "handlePcLine #...! passthru", benchPrepRaw,     benchLineRun) \
+  X(PC_RX,        "taskPcRx line + dispatch",    benchFeedLine,    benchTaskPcRx) \
+  X(PARSE_ARGS,   "cmdScanArgs INT2",            NULL,             benchParseArgs) \
+  X(PARSE_TOKENS, "cmdScanArgs TOKENS",          NULL,             benchParseTokens) \
+  X(FIND_CMD,     "findCommand (last entry)",    NULL,             benchFindCommand) \
+  X(ANGLE_POS,    "angleToPosition",             benchNextAngle,   benchAngleToPos) \
+  X(POS_ANGLE,    "positionToAngle",             benchNextAngle,   benchPosToAngle) \
+  X(BUS_REPLY,    "BusReplyParser PRTV",         NULL,             benchParseBusReply) \
+  X(TASK_TRACK,   "taskTrack PID tick",          benchPrepTrack,   benchTaskTrack) \
+  X(SEND_OK,      "sendOk JSON",                 benchReset,       benchSendOk) \
+  X(STATUS_JSON,  "emitStatus JSON",             benchReset,       benchEmitStatusJson) \
+  X(STATUS_BIN,   "emitStatus binary",           benchReset,       benchEmitStatusBin) \
+  X(CRC8,         "crc8 16 bytes",               NULL,             benchCrc16Bytes)
+
+#define BENCH_NAME(id, label, prepare, run) static const char BENCH_NAME_##id[] PROGMEM = label;
+#define BENCH_ENTRY(id, label, prepare, run) { BENCH_NAME_##id, prepare, run },
+
+BENCH_LIST(BENCH_NAME)
+
+static const BenchCase BENCH_CASES[] PROGMEM = {
+  BENCH_LIST(BENCH_ENTRY)
+};
+
+#undef BENCH_NAME
+#undef BENCH_ENTRY
+
+// ============================================
+// 進入點
+// ============================================
+
+#if !defined(ARDUINO_ARCH_AVR)
+// 主機端報告直接寫到 stdout（PC 埠保留給固件輸出佇列）
+class StdoutPrint : public Print {
+ public:
+  size_t write(uint8_t b) override { return fputc(b, stdout) == EOF ? 0 : 1; }
+  using Print::write;
+};
+static StdoutPrint benchOut;
+#endif
+
+static void benchMain(Print& out) {
+  panServoId = DEFAULT_PAN_SERVO_ID;
+  tiltServoId = DEFAULT_TILT_SERVO_ID;
+  servoIdDetected = true;
+  for (uint8_t i = 0; i < FIELD_COUNT; i++) benchJob.val[i] = 7400 - i * 1111;
+
+  uint32_t overhead = benchCalibrate(benchEmpty);
+  out.print(F("PT2D firmware microbenchmarks v"));
+  out.print(FIRMWARE_VERSION);
+  out.print(F(", overhead "));
+  out.print((unsigned long)overhead);
+  out.print(' ');
+  out.print(BENCH_UNIT);
+  out.print('\n');
+  benchPrintHeader(out);
+
+  for (uint8_t i = 0; i < sizeof(BENCH_CASES) / sizeof(BENCH_CASES[0]); i++) {
+    BenchCase c;
+    memcpy_P(&c, &BENCH_CASES[i], sizeof(c));
+    BenchResult r = benchRun(c, overhead);
+    benchPrintResult(out, c.name, r);
+  }
+  benchReset();
+}
+
+#if defined(ARDUINO_ARCH_AVR)
+
+void setup() {
+  halSerialBegin(HAL_PORT_PC, SERIAL_BAUDRATE);
+  benchMain(halSerialPort(HAL_PORT_PC));
+  halSerialPort(HAL_PORT_PC).flush();
+  // 關中斷休眠：simavr 偵測到後結束模擬
+  set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+  cli();
+  sleep_enable();
+  sleep_cpu();
+}
+
+void loop() {}
+
+#else
+
+int main() {
+  benchMain(benchOut);
+  return 0;
+}
+
+#endif
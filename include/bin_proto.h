@@ -0,0 +1,99 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file bin_proto.h
+ * @brief PC 端二進位幀協議（與 <CMD:PARAMS> 文字協議並存）
+ * @details 幀格式：
+ *            SYNC(0xA5) | LEN | OPCODE | PAYLOAD[LEN-1] | CRC8
+ *          - LEN = OPCODE + PAYLOAD 的位元組數（1..BIN_MAX_LEN）
+ *          - 多位元組欄位一律為小端序 int16
+ *          - CRC8 為 CRC-8/SMBUS（多項式 0x07，初值 0x00），涵蓋 LEN..PAYLOAD
+ *          回覆的 OPCODE = 請求 OPCODE | 0x80。
+ *          需先以文字命令 <BINARY:ON> 啟用；python/pt2d_controller.py 有對應編解碼。
+ */
+
+#ifndef BIN_PROTO_H
+#define BIN_PROTO_H
+
+#include <stdint.h>
+
+#define BIN_SYNC            0xA5
+#define BIN_MAX_LEN         16        // OPCODE + PAYLOAD 最大長度
+#define BIN_FRAME_TIMEOUT   50        // 幀內位元組間最大間隔（毫秒），逾時丟棄半幀
+#define BIN_REPLY_FLAG      0x80
+
+// 請求操作碼
+enum BinOpcode {
+  BIN_OP_PING    = 0x01,  // 無參數            → ACK
+  BIN_OP_MOVE    = 0x02,  // int16 pan, tilt   → ACK
+  BIN_OP_MOVEBY  = 0x03,  // int16 dpan, dtilt → ACK
+  BIN_OP_STOP    = 0x04,  // 無參數            → ACK
+  BIN_OP_HOME    = 0x05,  // 無參數            → ACK
+  BIN_OP_POS     = 0x06,  // [uint8 verify]    → POS（無 payload = 位置模型）
+  BIN_OP_STATUS  = 0x07,  // 無參數            → STATUS
+  BIN_OP_LASER   = 0x08,  // uint8 on          → ACK
+  BIN_OP_SPEED   = 0x09,  // uint8 speed       → ACK
+  BIN_OP_SUBSCRIBE = 0x0A,  // uint8 fields, uint16 period → ACK，之後週期推送 TELEMETRY（fields = 0 取消）
+  BIN_OP_TRACK   = 0x0B,  // int16 ex, ey, uint16 age_ms → ACK（視覺伺服誤差；無 payload = 停止）
+  BIN_OP_TEXT    = 0x0F,  // 無參數，退出二進位模式 → ACK
+};
+
+// 回覆操作碼
+enum BinReply {
+  BIN_RSP_ACK    = BIN_REPLY_FLAG | 0x00,  // uint8 req_opcode, uint8 status
+  BIN_RSP_POS    = BIN_REPLY_FLAG | BIN_OP_POS,     // int16 pan, tilt
+  BIN_RSP_STATUS = BIN_REPLY_FLAG | BIN_OP_STATUS,  // int16 pan, tilt, pan_temp, tilt_temp, pan_volt, tilt_volt
+  // 主動推送：uint8 fields, uint16 t（採樣時間 millis 低 16 位），其後依 fields 位元
+  // 按 STATUS 順序排列的 int16（pan, tilt / pan_temp, tilt_temp / pan_volt, tilt_volt）
+  BIN_RSP_TELEMETRY = BIN_REPLY_FLAG | BIN_OP_SUBSCRIBE,
+};
+
+// ACK 狀態碼
+enum BinStatus {
+  BIN_STATUS_OK      = 0,
+  BIN_STATUS_ERROR   = 1,  // 命令執行失敗（對應文字協議 status:error）
+  BIN_STATUS_BAD_CRC = 2,
+  BIN_STATUS_BAD_LEN = 3,
+  BIN_STATUS_UNKNOWN = 4,  // 未知操作碼
+};
+
+// 遙測欄位位元（BIN_OP_SUBSCRIBE 的 fields，亦用於文字協議 <SUBSCRIBE>）
+enum BinSubField {
+  BIN_SUB_POS  = 0x01,  // 雙軸角度（PRAD）
+  BIN_SUB_TEMP = 0x02,  // 雙軸溫度（PRTV）
+  BIN_SUB_VOLT = 0x04,  // 雙軸電壓（PRTV）
+};
+
+// CRC-8/SMBUS 單位元組更新
+static inline uint8_t crc8Update(uint8_t crc, uint8_t b) {
+  crc ^= b;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+  }
+  return crc;
+}
+
+static inline int16_t readLe16(const uint8_t* p) {
+  return (int16_t)((uint16_t)p[0] | ((uint16_t)p[1] << 8));
+}
+
+static inline void writeLe16(uint8_t* p, int16_t v) {
+  p[0] = (uint8_t)((uint16_t)v & 0xFF);
+  p[1] = (uint8_t)((uint16_t)v >> 8);
+}
+
+#endif // BIN_PROTO_H
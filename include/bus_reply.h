@@ -0,0 +1,171 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file bus_reply.h
+ * @brief ZL 舵機回覆的增量解析器：逐位元組解出 ID、回覆類型與數值欄位
+ * @details 回覆文法：'#' DIGIT{3} FIELD* '!'，FIELD = LETTER+ DIGIT*。
+ *          每收到一個位元組即推進狀態機並累加數值，收到 '!' 時依欄位形狀判定類型，
+ *          不需等到結尾再重新掃描字串：
+ *
+ *            #001P1500!      → BUSR_POS      v[0] = 1500
+ *            #001V7400T035!  → BUSR_VOLTEMP  v[0] = 7400（mV），v[1] = 35（°C）
+ *            #001P! / #001PMOD1! / #001PVZL1.0! → BUSR_OTHER（確認、查詢字串等）
+ *
+ *          形狀不符（例如 #001P15x0!、數值超過 int16）一律視為 BUSR_OTHER，
+ *          不會被當成位置 / 電壓溫度讀數；'#'、ID 或結尾錯誤則為 BUSP_ERROR。
+ */
+
+#ifndef BUS_REPLY_H
+#define BUS_REPLY_H
+
+#include <stdint.h>
+
+// 回覆類型（依欄位形狀判定）
+enum BusReplyType {
+  BUSR_OTHER = 0,  // 格式正確但非讀數（確認、版本、模式等），不帶數值
+  BUSR_POS,        // P<數字>
+  BUSR_VOLTEMP,    // V<數字>T<數字>
+};
+
+// 解碼後的總線回覆
+struct BusReply {
+  uint8_t id;     // 回覆來源舵機 ID
+  char tag;       // ID 後第一個字母（P = 位置，V = 電壓/溫度）
+  uint8_t type;   // BusReplyType
+  uint8_t count;  // v[] 有效個數（BUSR_POS 為 1，BUSR_VOLTEMP 為 2，其餘為 0）
+  int v[2];
+};
+
+// feed() 的結果
+enum BusParseResult {
+  BUSP_MORE = 0,  // 尚未結束
+  BUSP_DONE,      // 收到 '!'，reply() 有效
+  BUSP_ERROR,     // 收到結尾（'!'、CR 或 LF）但不是合法回覆
+};
+
+class BusReplyParser {
+ public:
+  BusReplyParser() { reset(); }
+
+  // 準備解析下一筆回覆
+  void reset() {
+    state_ = S_HASH;
+    acc_ = 0;
+    digits_ = 0;
+    fields_ = 0;
+    shape_ = true;
+    r_.id = 0;
+    r_.tag = 0;
+    r_.type = BUSR_OTHER;
+    r_.count = 0;
+  }
+
+  // 送入一個位元組；返回 BUSP_DONE / BUSP_ERROR 後須先 reset() 再送下一筆
+  uint8_t feed(char c) {
+    if (c == '!' || c == '\r' || c == '\n') {
+      bool ok = (c == '!') && (state_ == S_LETTER || state_ == S_DIGIT);
+      if (ok) finish();
+      state_ = S_END;
+      return ok ? BUSP_DONE : BUSP_ERROR;
+    }
+
+    bool digit = (c >= '0' && c <= '9');
+    bool letter = (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+    switch (state_) {
+      case S_HASH:
+        state_ = (c == '#') ? S_ID : S_SKIP;
+        break;
+      case S_ID:
+        if (!digit) { state_ = S_SKIP; break; }
+        acc_ = acc_ * 10 + (uint16_t)(c - '0');
+        if (++digits_ == 3) {
+          if (acc_ > 255) { state_ = S_SKIP; break; }
+          r_.id = (uint8_t)acc_;
+          state_ = S_FIELD;
+        }
+        break;
+      case S_FIELD:
+        if (!letter) { state_ = S_SKIP; break; }  // ID 之後必須是字母
+        r_.tag = c;
+        startField(c);
+        state_ = S_LETTER;
+        break;
+      case S_LETTER:
+        if (digit) {
+          acc_ = (uint16_t)(c - '0');
+          state_ = S_DIGIT;
+        } else {
+          shape_ = false;  // 多字母欄位名（PMOD、PV...）或非英數字元：非讀數
+        }
+        break;
+      case S_DIGIT:
+        if (digit) {
+          // int16 以外的數值視為形狀不符
+          if (acc_ > 3276 || (acc_ == 3276 && c > '7')) shape_ = false;
+          else acc_ = acc_ * 10 + (uint16_t)(c - '0');
+        } else if (letter) {
+          endValue();
+          startField(c);
+          state_ = S_LETTER;
+        } else {
+          shape_ = false;
+        }
+        break;
+      default:  // S_SKIP / S_END：等待結尾
+        break;
+    }
+    return BUSP_MORE;
+  }
+
+  const BusReply& reply() const { return r_; }
+
+ private:
+  enum State { S_HASH = 0, S_ID, S_FIELD, S_LETTER, S_DIGIT, S_SKIP, S_END };
+
+  void startField(char c) {
+    if (fields_ < 2) fieldTag_[fields_] = c;
+    else shape_ = false;
+    fields_++;
+  }
+
+  void endValue() {
+    if (fields_ <= 2) r_.v[fields_ - 1] = (int)acc_;
+  }
+
+  // 依欄位形狀判定類型：每個欄位恰一個字母且都有數值（最後一個欄位以數字結尾）
+  void finish() {
+    bool valued = shape_ && state_ == S_DIGIT;
+    if (valued) endValue();
+    if (valued && fields_ == 1 && fieldTag_[0] == 'P') {
+      r_.type = BUSR_POS;
+      r_.count = 1;
+    } else if (valued && fields_ == 2 && fieldTag_[0] == 'V' && fieldTag_[1] == 'T') {
+      r_.type = BUSR_VOLTEMP;
+      r_.count = 2;
+    }
+  }
+
+  BusReply r_;
+  uint16_t acc_;
+  uint8_t state_;
+  uint8_t digits_;   // 已收到的 ID 位數
+  uint8_t fields_;
+  char fieldTag_[2];
+  bool shape_;
+};
+
+#endif // BUS_REPLY_H
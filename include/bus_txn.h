@@ -0,0 +1,217 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file bus_txn.h
+ * @brief 總線查詢交易引擎：多筆 #ID...! 查詢排隊送出，回覆依 ID 配對
+ * @details 每筆交易記錄目標 ID、查詢類型、期限與完成回呼，存放於固定大小槽位。
+ *          已送出未回覆的交易數不超過 WINDOW，其餘排隊等待，前一筆配對或逾時後由 poll() 補送
+ *          （半雙工單線總線上 WINDOW 須為 1，見 config.h 的 BUS_TXN_WINDOW）；回覆依
+ *          「ID + 回覆類型」（BusReplyParser 依欄位形狀判定）配對到最早送出的交易，BUS_ID_ANY 交易只接收
+ *          沒有精確配對者的回覆。逾時交易以 r == NULL 呼叫回呼，
+ *          不會阻塞其他交易（取代舊的單一聚合狀態機與 2 秒整體逾時）。
+ *          總線的所有寫入都經引擎：不需回覆的指令（運動幀、PDST、透傳）以 post() 寫入，
+ *          有查詢在等回覆時暫存在 POST 位元組的緩衝區，回覆配對或逾時後先於下一筆查詢送出，
+ *          避免壓在舵機回覆上。
+ */
+
+#ifndef BUS_TXN_H
+#define BUS_TXN_H
+
+#include <string.h>
+
+#include "hal.h"
+#include "bus_reply.h"
+
+#define BUS_ID_ANY  255  // 廣播查詢：接受任何 ID 的回覆
+
+// 查詢類型（決定送出的 ZL 指令與可配對的回覆）
+enum BusQuery {
+  BUSQ_READ_POS = 0,  // #IDPRAD!      → #IDPxxxx!（BUSR_POS）
+  BUSQ_READ_VOLTEMP,  // #IDPRTV!      → #IDVxxxxTxxx!（BUSR_VOLTEMP）
+  BUSQ_SET_ID,        // #IDPIDnnn!    → 任意 #...!
+};
+
+// 完成回呼：r 為 NULL 表示逾時
+typedef void (*BusTxnDone)(uint8_t ctx, const BusReply* r);
+
+enum BusTxnState { TXN_FREE = 0, TXN_QUEUED, TXN_SENT };
+
+struct BusTxn {
+  BusTxnDone done;
+  unsigned long deadline;  // TXN_SENT：回覆期限（millis）；TXN_QUEUED：逾時長度
+  unsigned long sentUs;    // 查詢寫入總線佇列的時間（micros，量測往返延遲）
+  uint16_t arg;            // BUSQ_SET_ID 的新 ID
+  uint8_t id;
+  uint8_t query;
+  uint8_t ctx;             // 呼叫端自訂（回呼時原樣傳回）
+  uint8_t state;
+};
+
+template <uint8_t SLOTS, uint8_t WINDOW, uint8_t POST>
+class BusTxnEngine {
+ public:
+  explicit BusTxnEngine(Print& bus) : bus_(bus), inFlight_(0), postLen_(0), posted_(false), postedAt_(0), lastRttUs_(0) {
+    for (uint8_t i = 0; i < SLOTS; i++) slots_[i].state = TXN_FREE;
+  }
+
+  // 新增交易；槽位已滿返回 false（呼叫端應回報忙碌）
+  bool submit(uint8_t query, uint8_t id, uint16_t arg, uint16_t timeoutMs,
+              BusTxnDone done, uint8_t ctx) {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+      BusTxn& t = slots_[i];
+      if (t.state != TXN_FREE) continue;
+      t.done = done;
+      t.deadline = timeoutMs;
+      t.arg = arg;
+      t.id = id;
+      t.query = query;
+      t.ctx = ctx;
+      t.state = TXN_QUEUED;
+      pump();
+      return true;
+    }
+    return false;
+  }
+
+  // 寫入不需回覆的指令：總線空閒直接送出，否則暫存到目前查詢的回覆結束；暫存區放不下返回 false
+  bool post(const char* frame) {
+    size_t n = strlen(frame);
+    if (inFlight_ == 0 && postLen_ == 0) {
+      bus_.print(frame);
+      markPosted();
+      return true;
+    }
+    if (n > (size_t)(POST - postLen_)) return false;
+    memcpy(post_ + postLen_, frame, n);
+    postLen_ += n;
+    return true;
+  }
+
+  // 暫存區剩餘位元組（週期串流的呼叫端據此決定本次是否送出）
+  uint8_t postRoom() const { return POST - postLen_; }
+
+  // 是否有 post() 指令仍在暫存，或在 now 之前 ms 毫秒內才實際寫入總線
+  bool postedWithin(unsigned long now, unsigned long ms) const {
+    return postLen_ > 0 || (posted_ && now - postedAt_ < ms);
+  }
+
+  // 配對一筆回覆並呼叫回呼；無對應交易時返回 false（由呼叫端透傳）
+  bool complete(const BusReply& r) {
+    BusTxn* match = NULL;
+    for (uint8_t pass = 0; pass < 2 && !match; pass++) {
+      for (uint8_t i = 0; i < SLOTS; i++) {
+        BusTxn& t = slots_[i];
+        if (t.state != TXN_SENT || !accepts(t, r)) continue;
+        if (pass == 0 ? t.id != r.id : t.id != BUS_ID_ANY) continue;
+        if (!match || (long)(t.deadline - match->deadline) < 0) match = &t;
+      }
+    }
+    if (!match) return false;
+    finish(*match, &r);
+    return true;
+  }
+
+  // 週期呼叫：處理逾時並補送排隊中的交易
+  void poll(unsigned long now) {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+      BusTxn& t = slots_[i];
+      if (t.state == TXN_SENT && (long)(now - t.deadline) >= 0) finish(t, NULL);
+    }
+    pump();
+  }
+
+  bool idle() const {
+    for (uint8_t i = 0; i < SLOTS; i++) {
+      if (slots_[i].state != TXN_FREE) return false;
+    }
+    return true;
+  }
+
+  // 最近一筆成功配對的交易自送出到回覆配對的時間（µs）
+  unsigned long lastRttUs() const { return lastRttUs_; }
+
+  uint8_t freeSlots() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SLOTS; i++) {
+      if (slots_[i].state == TXN_FREE) n++;
+    }
+    return n;
+  }
+
+ private:
+  static bool accepts(const BusTxn& t, const BusReply& r) {
+    switch (t.query) {
+      case BUSQ_READ_POS:     return r.type == BUSR_POS;
+      case BUSQ_READ_VOLTEMP: return r.type == BUSR_VOLTEMP;
+      default:                return true;
+    }
+  }
+
+  // 總線上沒有待回覆的查詢時先送出暫存指令（維持寫入順序），再補送排隊中的查詢
+  void pump() {
+    if (inFlight_ == 0 && postLen_ > 0) {
+      bus_.write((const uint8_t*)post_, postLen_);
+      postLen_ = 0;
+      markPosted();
+    }
+    for (uint8_t i = 0; i < SLOTS && inFlight_ < WINDOW; i++) {
+      if (slots_[i].state == TXN_QUEUED) send(slots_[i]);
+    }
+  }
+
+  void markPosted() {
+    posted_ = true;
+    postedAt_ = halMillis();
+  }
+
+  void send(BusTxn& t) {
+    char buf[16];
+    if (t.query == BUSQ_READ_POS) {
+      snprintf_P(buf, sizeof(buf), PSTR("#%03dPRAD!"), t.id);
+    } else if (t.query == BUSQ_READ_VOLTEMP) {
+      snprintf_P(buf, sizeof(buf), PSTR("#%03dPRTV!"), t.id);
+    } else {
+      snprintf_P(buf, sizeof(buf), PSTR("#%03dPID%03u!"), t.id, t.arg);
+    }
+    bus_.print(buf);
+    t.sentUs = halMicros();
+    t.deadline = halMillis() + t.deadline;
+    t.state = TXN_SENT;
+    inFlight_++;
+  }
+
+  // 釋放槽位後再呼叫回呼，使回呼內可立即提交新交易
+  void finish(BusTxn& t, const BusReply* r) {
+    BusTxnDone done = t.done;
+    uint8_t ctx = t.ctx;
+    if (r) lastRttUs_ = halMicros() - t.sentUs;
+    t.state = TXN_FREE;
+    inFlight_--;
+    if (done) done(ctx, r);
+  }
+
+  Print& bus_;
+  BusTxn slots_[SLOTS];
+  uint8_t inFlight_;
+  uint8_t postLen_;
+  char post_[POST];
+  bool posted_;
+  unsigned long postedAt_;
+  unsigned long lastRttUs_;
+};
+
+#endif // BUS_TXN_H
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file cmd_parse.h
+ * @brief 就地單次掃描的命令分詞器
+ * @details 直接掃描接收緩衝區中的 CMD[:ARG{,ARG}] 內容（不含 < >），不複製任何字元：
+ *          cmdScanName() 邊轉大寫邊計算命令名雜湊，查表得到參數格式後，
+ *          cmdScanArgs() 從同一位置繼續，把每個參數解析為整數（int16，溢位即報錯）
+ *          或關鍵字雜湊，最後依格式驗證個數與型別。每個字元只看一次。
+ *
+ *          文法：ARG = ['-'] DIGIT+ | ALPHA (ALNUM | '_')*，分隔符為 ',' '+' '|'，
+ *          參數前後允許空白。ARGS_RAW 不分詞，text 指向原始參數。
+ */
+
+#ifndef CMD_PARSE_H
+#define CMD_PARSE_H
+
+#include "cmd_table.h"
+
+static inline bool cmdIsDigit(char c) { return c >= '0' && c <= '9'; }
+static inline bool cmdIsAlpha(char c) { return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'); }
+static inline char cmdUpper(char c) { return (c >= 'a' && c <= 'z') ? (char)(c - 32) : c; }
+
+// 命令名：自 p 掃描到 ':' 或結尾並計算雜湊，返回參數起點（已跳過 ':'）
+static inline const char* cmdScanName(const char* p, uint16_t& hash) {
+  hash = CMD_HASH_SEED;
+  while (*p && *p != ':') hash = cmdHashStep(hash, cmdUpper(*p++));
+  return *p == ':' ? p + 1 : p;
+}
+
+// 單一參數：整數或關鍵字，p 前進到參數之後
+static inline uint8_t cmdScanToken(const char*& p, uint8_t& kind, int& v) {
+  if (cmdIsAlpha(*p)) {
+    uint16_t h = CMD_HASH_SEED;
+    while (cmdIsAlpha(*p) || cmdIsDigit(*p) || *p == '_') h = cmdHashStep(h, cmdUpper(*p++));
+    kind = ARG_WORD;
+    v = (int)h;
+    return CMD_OK;
+  }
+
+  bool neg = (*p == '-');
+  if (neg) p++;
+  if (!cmdIsDigit(*p)) return CMD_ERR_SYNTAX;
+  // 累加到超過 32768 即停止累加（仍掃完數字），避免 16 位元 long 以外的溢位
+  uint16_t acc = 0;
+  bool over = false;
+  while (cmdIsDigit(*p)) {
+    if (!over) {
+      acc = acc * 10 + (uint16_t)(*p - '0');
+      if (acc > 32768u) over = true;
+    }
+    p++;
+  }
+  if (over || acc > (neg ? 32768u : 32767u)) return CMD_ERR_RANGE;
+  kind = ARG_INT;
+  v = neg ? (int)(0 - (long)acc) : (int)acc;
+  return CMD_OK;
+}
+
+// 依參數格式驗證已分詞的參數；ARGS_SWITCH 轉為 v[0] = 1/0
+static inline uint8_t cmdCheckSchema(uint8_t schema, CmdArgs& args) {
+  switch (schema) {
+    case ARGS_NONE:
+      return args.count == 0 ? CMD_OK : CMD_ERR_COUNT;
+    case ARGS_INT1:
+    case ARGS_INT2: {
+      uint8_t want = (schema == ARGS_INT1) ? 1 : 2;
+      if (args.count != want) return CMD_ERR_COUNT;
+      for (uint8_t i = 0; i < want; i++) {
+        if (args.kind[i] != ARG_INT) return CMD_ERR_TYPE;
+        if (i > 0 && args.sep[i] != ',') return CMD_ERR_SYNTAX;
+      }
+      return CMD_OK;
+    }
+    case ARGS_SWITCH:
+      if (args.count != 1) return CMD_ERR_COUNT;
+      if (cmdArgIs(args, 0, cmdHash("ON"))) args.v[0] = 1;
+      else if (cmdArgIs(args, 0, cmdHash("OFF"))) args.v[0] = 0;
+      else if (args.kind[0] != ARG_INT || (args.v[0] != 0 && args.v[0] != 1)) return CMD_ERR_TYPE;
+      args.kind[0] = ARG_INT;
+      return CMD_OK;
+    default:  // ARGS_TOKENS
+      return CMD_OK;
+  }
+}
+
+// 參數：自 p（cmdScanName 的返回值）單次掃描到結尾，依格式分詞並驗證
+static inline uint8_t cmdScanArgs(const char* p, uint8_t schema, CmdArgs& args) {
+  args.count = 0;
+  args.text = p;
+  if (schema == ARGS_RAW) return CMD_OK;
+
+  while (*p == ' ') p++;
+  char sep = ':';
+  while (*p) {
+    if (args.count == CMD_MAX_ARGS) return CMD_ERR_COUNT;
+    uint8_t i = args.count++;
+    args.sep[i] = sep;
+    uint8_t err = cmdScanToken(p, args.kind[i], args.v[i]);
+    if (err != CMD_OK) return err;
+
+    while (*p == ' ') p++;
+    if (*p == '\0') break;
+    if (*p != ',' && *p != '+' && *p != '|') return CMD_ERR_SYNTAX;
+    sep = *p++;
+    while (*p == ' ') p++;
+    if (*p == '\0') return CMD_ERR_SYNTAX;  // 結尾多一個分隔符
+  }
+  return cmdCheckSchema(schema, args);
+}
+
+#endif // CMD_PARSE_H
@@ -0,0 +1,103 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file cmd_table.h
+ * @brief 表驅動命令分發：編譯期命令名雜湊與參數格式定義
+ * @details 命令名（含別名）在編譯期以 cmdHash() 轉為 16 位元鍵，
+ *          與處理函數、參數格式一起存放於 PROGMEM 命令表；
+ *          執行期只需計算一次輸入命令名的雜湊並比較整數鍵，
+ *          不再逐一 strcmp，也不在 SRAM 保留命令名字串。
+ *          雜湊碰撞由 cmdTableUnique() 在編譯期以 static_assert 檢出。
+ */
+
+#ifndef CMD_TABLE_H
+#define CMD_TABLE_H
+
+#include <stdint.h>
+
+#define CMD_HASH_SEED   5381u
+#define CMD_MAX_ARGS    4
+
+// 編譯期命令名雜湊（Bernstein djb2-xor，16 位元；命令名須為大寫）
+constexpr uint16_t cmdHash(const char* s, uint16_t h = CMD_HASH_SEED) {
+  return *s ? cmdHash(s + 1, (uint16_t)((uint16_t)((h << 5) + h) ^ (uint8_t)*s)) : h;
+}
+
+// 執行期增量雜湊（與 cmdHash 相同演算法），c 須已轉為大寫
+static inline uint16_t cmdHashStep(uint16_t h, char c) {
+  return (uint16_t)((uint16_t)((h << 5) + h) ^ (uint8_t)c);
+}
+
+// 參數格式
+enum ArgSchema {
+  ARGS_NONE = 0,  // 無參數
+  ARGS_INT1,      // 1 個整數
+  ARGS_INT2,      // 2 個逗號分隔整數
+  ARGS_SWITCH,    // ON/OFF（或 1/0），解析為 v[0] = 1/0
+  ARGS_TOKENS,    // 整數 / 關鍵字序列，由處理函數依 kind / sep 驗證
+  ARGS_RAW,       // 原樣字串（text），不分詞
+};
+
+// 參數型別
+enum ArgKind {
+  ARG_INT = 0,    // v = 數值（int16 範圍）
+  ARG_WORD,       // v = 關鍵字大寫雜湊（與 cmdHash 相同，可直接與 cmdHash("ON") 比較）
+};
+
+// 解析錯誤碼（JSON 錯誤回應的 code 欄位）
+enum CmdError {
+  CMD_OK = 0,
+  CMD_ERR_UNKNOWN,     // 未知命令
+  CMD_ERR_SYNTAX,      // 非法字元、空參數或分隔符錯誤
+  CMD_ERR_RANGE,       // 整數超出 int16 範圍
+  CMD_ERR_COUNT,       // 參數個數不符
+  CMD_ERR_TYPE,        // 參數型別不符（例如需整數卻為關鍵字）
+  CMD_ERR_TOO_LONG,    // 命令超過接收緩衝區
+};
+
+// 解析後的命令參數（均指向接收緩衝區內部，不複製）
+struct CmdArgs {
+  uint8_t count;
+  int v[CMD_MAX_ARGS];
+  uint8_t kind[CMD_MAX_ARGS];   // ArgKind
+  char sep[CMD_MAX_ARGS];       // 參數前的分隔符：第一個為 ':'，其後為 ',' '+' '|'
+  const char* text;             // 原始參數字串（ARGS_RAW 使用）
+};
+
+// 第 i 個參數是否為關鍵字 h（h 取 cmdHash("...")）
+static inline bool cmdArgIs(const CmdArgs& a, uint8_t i, uint16_t h) {
+  return i < a.count && a.kind[i] == ARG_WORD && (uint16_t)a.v[i] == h;
+}
+
+typedef void (*CmdHandler)(const CmdArgs& args);
+
+struct CmdEntry {
+  uint16_t hash;
+  uint8_t schema;
+  CmdHandler fn;
+};
+
+// 編譯期檢查：命令表中雜湊鍵兩兩不同
+constexpr bool cmdHashNotIn(const CmdEntry* t, unsigned n, unsigned j, uint16_t h) {
+  return j >= n ? true : (t[j].hash != h && cmdHashNotIn(t, n, j + 1, h));
+}
+
+constexpr bool cmdTableUnique(const CmdEntry* t, unsigned n, unsigned i = 0) {
+  return i >= n ? true : (cmdHashNotIn(t, n, i + 1, t[i].hash) && cmdTableUnique(t, n, i + 1));
+}
+
+#endif // CMD_TABLE_H
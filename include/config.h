@@ -85,6 +85,18 @@
 #define SERIAL_BAUDRATE     115200    // 上位機串口波特率
 #define SERVO_BAUDRATE      115200    // 舵機總線波特率（常見：9600/115200）
 
+// 中斷驅動接收環形緩衝區（容量須為 2 的冪，最大 256）
+#define PC_RX_RING_SIZE     128       // PC 串口接收緩衝
+#define BUS_RX_RING_SIZE    64        // 舵機總線接收緩衝
+#define RX_PUMP_HZ          2000      // Timer2 搬運頻率（Hz）：115200bps 下每次約 6 位元組
+
+// 非同步傳送佇列（容量須為 2 的冪，最大 256）
+#define PC_TX_QUEUE_SIZE    128       // PC 回覆傳送佇列
+#define BUS_TX_QUEUE_SIZE   64        // 舵機總線傳送佇列
+#define BUS_TX_BURST        4         // SoftwareSerial 每次中斷最多送出位元組數（忙等傳送）
+#define BUS_FRAME_MAX       20        // 單幀總線指令組裝緩衝（最長 #254P1000T65535! 含 NUL 為 17 位元組）
+#define JSON_BUF_SIZE       96        // JSON 回覆組裝緩衝（須小於 PC_TX_QUEUE_SIZE；較長的回覆分段送出）
+
 // ============================================
 // 總線舵機配置
 // ============================================
@@ -92,6 +104,8 @@
 // 如果是 Uno/Nano，需使用 SoftwareSerial
 #if defined(__AVR_ATmega2560__)
   #define SERVO_SERIAL      Serial1   // Mega: 使用 Serial1 (TX1=18, RX1=19)
+#elif defined(PT2D_NATIVE)
+  // env:native：總線為偽終端或記憶體串流（見 hal_native.h）
 #else
   #include <SoftwareSerial.h>
   extern SoftwareSerial ServoSerial;
@@ -102,6 +116,8 @@
 
 // 舵機 ID 配置（廢棄預設值，啟動時必須自動掃描）
 #define AUTO_DETECT_SERVO_ID    true      // 啟動時強制自動掃描舵機ID（不使用預設值）
+#define DEFAULT_PAN_SERVO_ID    1         // 預設 Pan 舵機 ID（驗證用）
+#define DEFAULT_TILT_SERVO_ID   2         // 預設 Tilt 舵機 ID（驗證用）
 
 // 自動掃描超時設置
 #define SERVO_DETECT_TIMEOUT    500       // 掃描超時（毫秒）
@@ -109,6 +125,27 @@
 #define SERVO_DETECT_RETRIES    3         // 掃描重試次數（每個舵機）
 #define SERVO_STARTUP_DELAY     1000      // 啟動等待延遲（毫秒，等待舵機初始化）
 #define SERVO_DETECT_RETRY_DELAY 500      // 掃描重試延遲（毫秒）
+#define SERVO_VERIFY_WAIT       200       // 單軸驗證等待回應時間（毫秒）
+#define SERVO_CONFIG_WAIT       300       // CONFIGSERVO 等待舵機確認時間（毫秒）
+
+// 總線查詢交易引擎（見 bus_txn.h）
+#define BUS_TXN_SLOTS           8         // 等待中的總線查詢上限（含排隊）
+// 已送出未回覆的查詢上限。ZL 總線為半雙工單線，舵機收完查詢約 300 µs 即開始回覆，
+// 此時主機若仍在送下一筆查詢就會在線上碰撞（UNO/Nano 的 SoftwareSerial 送出期間也無法接收），
+// 因此一次只送一筆，其餘在交易引擎排隊、回覆配對後立即補送。回覆走獨立線路的總線才可調大
+#define BUS_TXN_WINDOW          1
+#define BUS_TXN_TIMEOUT         100       // 單筆查詢等待回覆時間（毫秒）
+#define BUS_POST_SIZE           64        // 查詢等回覆期間暫存的運動/透傳指令（位元組，至少容納一個雙軸群組幀）
+#define BUS_JOB_SLOTS           4         // 同時進行的 PC 讀取請求上限（POS/STATUS/READ*）
+
+// 遙測訂閱（<SUBSCRIBE:fields,period_ms>，固件自行排程 PRAD/PRTV 並推送結果）
+#define SUB_DEFAULT_PERIOD      100       // 未指定週期時的推送週期（毫秒）
+#define SUB_MIN_PERIOD          20        // 最短推送週期（毫秒）：50 Hz
+#define SUB_MAX_PERIOD          10000     // 最長推送週期（毫秒）
+
+// 延遲量測（<STATS>，見 latency_hist.h）：桶 0 < 16 µs，之後每桶加倍，最後一桶 ≥ 65 ms
+#define LAT_BUCKETS             14
+#define LAT_BUCKET_SHIFT        4
 
 // ============================================
 // 舵機角度範圍
@@ -132,8 +169,17 @@
 #define MIN_SPEED           1         // 最小速度
 #define MAX_SPEED           100       // 最大速度
 
-#define SMOOTH_MOVE_STEP    1         // 平滑移動步進 (度)
-#define UPDATE_INTERVAL     20        // 更新間隔 (毫秒)
+#define SMOOTH_MOVE_STEP    1         // 平滑移動步進 (度)：設定點變化達此值才送出新位置
+#define UPDATE_INTERVAL     20        // 更新間隔 (毫秒)：軌跡規劃與設定點串流週期
+
+// 軌跡規劃（S 曲線：速度、加速度、加加速度皆受限；<TRAJ:OFF> 改回單幀直接移動）
+#define TRAJ_ENABLED_DEFAULT true
+#define TRAJ_MAX_VEL_PAN    180.0f    // Pan 最大速度（度/秒，SPEED=100 時；依 SPEED 等比縮放）
+#define TRAJ_MAX_VEL_TILT   120.0f    // Tilt 最大速度（度/秒）
+#define TRAJ_MAX_ACC_PAN    720.0f    // Pan 最大加速度（度/秒²）
+#define TRAJ_MAX_ACC_TILT   480.0f    // Tilt 最大加速度（度/秒²）
+#define TRAJ_MAX_JERK_PAN   6000.0f   // Pan 最大加加速度（度/秒³）
+#define TRAJ_MAX_JERK_TILT  4000.0f   // Tilt 最大加加速度（度/秒³）
 
 // ============================================
 // 自動掃描模式參數
@@ -143,6 +189,34 @@
 #define SCAN_RANGE          120       // 掃描範圍（度）
 #define SCAN_SPEED          20        // 掃描速度（慢速）
 #define SCAN_UPDATE_INTERVAL 100      // 掃描更新間隔（毫秒）
+#define SCAN_ROWS           3         // 光柵掃描的 Tilt 行數（自 SCAN_TILT_ANGLE 向上）
+#define SCAN_ROW_STEP       15        // 光柵掃描行距（度）
+#define SCAN_DWELL_MS       500       // 隨機掃描到點後停留時間（毫秒）
+
+// ============================================
+// 裝置端視覺伺服（<TRACK:ex,ey,age_ms>，PID 見 pid.h）
+// ============================================
+#define TRACK_INTERVAL      20        // 控制週期（毫秒）：50 Hz，影像更新之間以自身轉動量插值
+#define TRACK_TIMEOUT_MS    500       // 超過此時間未收到新誤差即停止追蹤（停在目前指令角度）
+#define TRACK_MDEG_PER_PX   94        // 每像素對應角度（毫度）：水平視場角 / 影像寬度，例如 60° / 640
+#define TRACK_TILT_SIGN     -1        // 影像 Y 向下為正，Tilt 角度向上為正
+#define TRACK_KP_DEFAULT    15000     // 比例增益（×0.001 /秒）：誤差 1° → 15°/s
+#define TRACK_KI_DEFAULT    3000      // 積分增益（×0.001 /秒²）
+#define TRACK_KD_DEFAULT    150       // 微分增益（×0.001）
+#define TRACK_DEADBAND_PX   3         // 死區（像素）
+#define TRACK_D_ALPHA       0.3f      // 微分低通係數（0-1，越小越平滑）
+#define TRACK_MAX_VEL       120.0f    // 輸出角速度上限（度/秒）
+#define TRACK_HISTORY       10        // 角度歷史筆數（× TRACK_INTERVAL = 可補償的最大影像延遲）
+
+// ============================================
+// 任務排程（協作式，非阻塞）
+// ============================================
+#define KEY_SCAN_INTERVAL   5         // 按鍵掃描週期（毫秒）
+#define KEY_DEBOUNCE_MS     20        // 按鍵防抖時間（毫秒）
+#define BEEP_TOGGLE_MS      100       // 蜂鳴器開/關各段時長（毫秒）
+#define WDT_SERVICE_INTERVAL 50       // 看門狗餵狗週期（毫秒）
+#define WDT_TIMEOUT_MS      2000      // 看門狗逾時（毫秒，需與 halWatchdogEnable() 一致）
+#define SERVO_NOTIFY_INTERVAL 3000    // 軟停機提示節流週期（毫秒）
 
 // ============================================
 // 串口通訊協議
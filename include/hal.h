@@ -0,0 +1,92 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file hal.h
+ * @brief 硬體抽象層：串口、GPIO、時鐘、看門狗與背景搬運
+ * @details 橋接邏輯（main.cpp 與 include/ 下各元件）只透過本介面存取硬體。
+ *          - AVR 後端（src/hal_avr.cpp）：Arduino 核心、SoftwareSerial、Timer2 中斷
+ *          - native 後端（src/hal_native.cpp，env:native）：POSIX 時鐘、執行緒、
+ *            偽終端或記憶體串流，使固件可在 Linux 上以一般執行檔運行
+ *          Print、F()、PROGMEM 等仍沿用 Arduino 介面，native 由 include/native/Arduino.h 提供。
+ */
+
+#ifndef HAL_H
+#define HAL_H
+
+#include <Arduino.h>
+
+// 串口埠
+enum HalPort {
+  HAL_PORT_PC = 0,  // 上位機（硬體 UART）
+  HAL_PORT_BUS,     // 舵機總線（UNO/Nano：SoftwareSerial；Mega：Serial1）
+  HAL_PORT_COUNT
+};
+
+// 串口
+void halSerialBegin(uint8_t port, unsigned long baud);
+int halSerialRead(uint8_t port);           // 無資料返回 -1（僅由背景搬運呼叫）
+uint8_t halSerialWriteRoom(uint8_t port);  // 本次可不忙等寫出的位元組數（僅由背景搬運呼叫）
+Print& halSerialPort(uint8_t port);        // 直接寫出（TxQueue 的下游）
+
+// 時鐘
+unsigned long halMillis();
+unsigned long halMicros();
+
+// GPIO（mode 為 Arduino 的 INPUT/OUTPUT/INPUT_PULLUP）
+void halPinMode(uint8_t pin, uint8_t mode);
+void halDigitalWrite(uint8_t pin, uint8_t level);
+int halDigitalRead(uint8_t pin);
+
+// 看門狗（逾時 2 秒）
+void halWatchdogEnable();
+void halWatchdogDisable();
+void halWatchdogReset();
+
+// 本次開機的重置原因（位元可組合，與 AVR MCUSR 低 4 位相同）
+enum HalResetCause {
+  HAL_RESET_POWERON  = 0x01,
+  HAL_RESET_EXTERNAL = 0x02,
+  HAL_RESET_BROWNOUT = 0x04,
+  HAL_RESET_WATCHDOG = 0x08,
+};
+uint8_t halResetCause();
+
+// 重置時不清除的變數（AVR：.noinit 段，上電時內容隨機，須自行以 magic 驗證；
+// native 無重置，等同一般零初始化的靜態變數）
+#if defined(ARDUINO_ARCH_AVR)
+#define HAL_NOINIT  __attribute__((section(".noinit")))
+#else
+#define HAL_NOINIT
+#endif
+
+// 背景搬運：以 RX_PUMP_HZ 頻率呼叫 fn（AVR：Timer2 中斷；native：執行緒），不可重入
+void halStartPump(void (*fn)());
+
+// 等待背景搬運騰出空間的忙等迴圈內呼叫（AVR 為空；native 虛擬時鐘下推進時間並搬運）
+void halIdle();
+
+// 臨界區（RAII）：區塊內不會執行背景搬運
+class HalAtomic {
+ public:
+  HalAtomic();
+  ~HalAtomic();
+
+ private:
+  uint8_t saved_;
+};
+
+#endif // HAL_H
@@ -0,0 +1,54 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file hal_native.h
+ * @brief native 後端專用控制介面（env:native 的測試、基準與模擬器使用）
+ * @details 串口埠可接到：
+ *          - 偽終端：halNativeOpenPty()，上位機 Python 或 sim/ 模擬器直接開啟從端路徑
+ *          - 既有檔案描述子：halNativeAttachFd()（stdin/stdout、已開啟的 tty）
+ *          - 記憶體串流：halNativeUseMemory()，以 halNativeFeed()/halNativeTake() 收送
+ *          虛擬時鐘模式下不建立執行緒：時間只隨 halNativeAdvance() 與每次讀取時鐘（+1 µs，
+ *          避免 setup() 內的忙等迴圈停滯）前進，背景搬運在虛擬時間跨過搬運週期時就地執行，
+ *          整個執行過程完全可重現。
+ *          預設 main() 可以 -DPT2D_NATIVE_NO_MAIN 關閉，由測試程式自行呼叫 setup()/loop()。
+ */
+
+#ifndef HAL_NATIVE_H
+#define HAL_NATIVE_H
+
+#include "hal.h"
+
+// 串口埠連接方式（須在 setup() 之前設定）
+const char* halNativeOpenPty(uint8_t port);  // 返回從端路徑，失敗返回 NULL
+void halNativeAttachFd(uint8_t port, int rxFd, int txFd);
+void halNativeUseMemory(uint8_t port);
+
+// 記憶體串流：注入待接收位元組 / 取出已送出位元組，返回實際處理數
+size_t halNativeFeed(uint8_t port, const uint8_t* data, size_t len);
+size_t halNativeTake(uint8_t port, uint8_t* out, size_t max);
+
+// 每次背景搬運結束後呼叫 hook（在記憶體串流另一端放置舵機模型等；NULL 取消）
+void halNativeOnPump(void (*hook)());
+
+// GPIO：由外部驅動輸入腳位（例如模擬按鍵按下 = LOW）
+void halNativeSetPin(uint8_t pin, uint8_t level);
+
+// 虛擬時鐘（須在 setup() 之前啟用）
+void halNativeUseVirtualClock();
+void halNativeAdvance(unsigned long us);  // 推進虛擬時間並執行期間到期的背景搬運
+
+#endif // HAL_NATIVE_H
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file json_writer.h
+ * @brief 零配置串流 JSON 輸出（單行物件）
+ * @details 鍵名來自 PROGMEM（PSTR），數值直接轉成十進位字元，全部寫入固定大小的
+ *          緩衝區；緩衝區滿或 end() 時以一次 write(buf, len) 交給輸出端
+ *          （TxQueue 會等到能整段容納才寫入）。N 不小於一行時整行一次入佇列。
+ *          逗號由寫入器自動插入，呼叫端只需依序寫欄位：
+ *
+ *            json.begin().field(PSTR("pan"), 90).field(PSTR("tilt"), 45).end();
+ *            → {"pan":90,"tilt":45}\r\n
+ *
+ *          巢狀物件 / 陣列以 object()/array() 開啟、closeObject()/closeArray() 關閉，
+ *          陣列元素以 item() 寫入。不檢查括號是否成對。
+ */
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "hal.h"
+
+template <uint8_t N>
+class JsonWriter {
+ public:
+  explicit JsonWriter(Print& out) : out_(out), len_(0), first_(true) {}
+
+  // 開始一行（寫入 '{'）
+  JsonWriter& begin() {
+    flush();
+    put('{');
+    first_ = true;
+    return *this;
+  }
+
+  // 結束一行：'}' + CRLF（與 println 相同），並交給輸出端
+  void end() {
+    put('}');
+    put('\r');
+    put('\n');
+    flush();
+  }
+
+  // 鍵名（PROGMEM），之後必須接一個值
+  JsonWriter& key(const char* k) {
+    sep();
+    put('"');
+    putP(k);
+    put('"');
+    put(':');
+    return *this;
+  }
+
+  JsonWriter& field(const char* k, int v) { key(k); putInt(v); return *this; }
+  JsonWriter& field(const char* k, long v) { key(k); putInt(v); return *this; }
+  JsonWriter& field(const char* k, unsigned int v) { key(k); putUint(v); return *this; }
+  JsonWriter& field(const char* k, unsigned long v) { key(k); putUint(v); return *this; }
+  JsonWriter& fieldBool(const char* k, bool v) { key(k); putP(v ? PSTR("true") : PSTR("false")); return *this; }
+
+  // 字串值：s 位於 SRAM，跳脫 '"' 與 '\\'，控制字元以空白取代
+  JsonWriter& fieldStr(const char* k, const char* s) {
+    key(k);
+    put('"');
+    for (; *s; s++) {
+      char c = *s;
+      if (c == '"' || c == '\\') put('\\');
+      put((uint8_t)c < 0x20 ? ' ' : c);
+    }
+    put('"');
+    return *this;
+  }
+
+  // 字串值：s 位於 PROGMEM（常數訊息，不跳脫）
+  JsonWriter& fieldStrP(const char* k, const char* s) {
+    key(k);
+    put('"');
+    putP(s);
+    put('"');
+    return *this;
+  }
+
+  // 巢狀物件 / 陣列
+  JsonWriter& object(const char* k) { key(k); put('{'); first_ = true; return *this; }
+  JsonWriter& array(const char* k) { key(k); put('['); first_ = true; return *this; }
+  JsonWriter& closeObject() { put('}'); first_ = false; return *this; }
+  JsonWriter& closeArray() { put(']'); first_ = false; return *this; }
+
+  // 陣列元素
+  JsonWriter& item(int v) { sep(); putInt(v); return *this; }
+  JsonWriter& item(unsigned int v) { sep(); putUint(v); return *this; }
+  JsonWriter& item(long v) { sep(); putInt(v); return *this; }
+  JsonWriter& item(unsigned long v) { sep(); putUint(v); return *this; }
+
+  // 寫出緩衝區內容
+  void flush() {
+    if (len_ == 0) return;
+    out_.write((const uint8_t*)buf_, len_);
+    len_ = 0;
+  }
+
+ private:
+  void put(char c) {
+    if (len_ == N) flush();
+    buf_[len_++] = c;
+  }
+
+  void putP(const char* s) {
+    for (char c; (c = (char)pgm_read_byte(s)) != '\0'; s++) put(c);
+  }
+
+  void putUint(unsigned long v) {
+    char tmp[10];
+    uint8_t n = 0;
+    do {
+      tmp[n++] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v);
+    while (n) put(tmp[--n]);
+  }
+
+  void putInt(long v) {
+    if (v < 0) {
+      put('-');
+      putUint(0UL - (unsigned long)v);
+    } else {
+      putUint((unsigned long)v);
+    }
+  }
+
+  // 同一層第二個起的元素前加逗號
+  void sep() {
+    if (!first_) put(',');
+    first_ = false;
+  }
+
+  Print& out_;
+  char buf_[N];
+  uint8_t len_;
+  bool first_;
+};
+
+#endif // JSON_WRITER_H
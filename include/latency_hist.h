@@ -0,0 +1,61 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file latency_hist.h
+ * @brief 固定桶 log2 延遲直方圖（微秒）
+ * @details 桶 0 為 < 2^LAT_BUCKET_SHIFT µs，桶 k（1 ≤ k < LAT_BUCKETS-1）為
+ *          [2^(k+SHIFT-1), 2^(k+SHIFT)) µs，最後一桶收納其餘較大值。
+ *          計數飽和於 65535 不回繞；另記錄總和（求平均）與最大值。
+ *          只在主迴圈更新，ISR 只提供時間戳，因此不需原子操作。
+ */
+
+#ifndef LATENCY_HIST_H
+#define LATENCY_HIST_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifndef LAT_BUCKETS
+#define LAT_BUCKETS         14
+#endif
+#ifndef LAT_BUCKET_SHIFT
+#define LAT_BUCKET_SHIFT    4
+#endif
+
+struct LatHist {
+  uint16_t bucket[LAT_BUCKETS];
+  uint16_t count;
+  uint32_t sumUs;
+  uint32_t maxUs;
+
+  void record(uint32_t us) {
+    uint8_t k = 0;
+    for (uint32_t v = us >> LAT_BUCKET_SHIFT; v && k < LAT_BUCKETS - 1; v >>= 1) k++;
+    if (bucket[k] != 0xFFFF) bucket[k]++;
+    if (count != 0xFFFF) {
+      count++;
+      sumUs = (sumUs + us < sumUs) ? 0xFFFFFFFFUL : sumUs + us;
+    }
+    if (us > maxUs) maxUs = us;
+  }
+
+  uint32_t meanUs() const { return count ? sumUs / count : 0; }
+
+  void reset() { memset(this, 0, sizeof(*this)); }
+};
+
+#endif // LATENCY_HIST_H
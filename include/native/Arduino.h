@@ -0,0 +1,123 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file Arduino.h
+ * @brief env:native 用的最小 Arduino 相容層（僅 -Iinclude/native 時生效）
+ * @details 只提供橋接邏輯用到的語言層介面：Print、F()/PSTR/PROGMEM、pgm_read_*、
+ *          map()/random() 與基本型別。硬體相關功能一律經 hal.h，
+ *          因此這裡刻意不提供 millis()、digitalWrite()、Serial 等。
+ */
+
+#ifndef PT2D_NATIVE_ARDUINO_H
+#define PT2D_NATIVE_ARDUINO_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+typedef bool boolean;
+typedef uint8_t byte;
+
+#define HIGH          1
+#define LOW           0
+#define INPUT         0
+#define OUTPUT        1
+#define INPUT_PULLUP  2
+
+#define A0  14
+#define A1  15
+#define A2  16
+#define A3  17
+#define A4  18
+#define A5  19
+#define A6  20
+#define A7  21
+
+#define DEC 10
+#define HEX 16
+
+// PROGMEM：主機上與一般記憶體相同
+#define PROGMEM
+#define PSTR(s)                 (s)
+#define pgm_read_byte(p)        (*(const uint8_t*)(p))
+#define pgm_read_word(p)        (*(const uint16_t*)(p))
+#define pgm_read_dword(p)       (*(const uint32_t*)(p))
+#define pgm_read_float(p)       (*(const float*)(p))
+#define pgm_read_ptr(p)         (*(void* const*)(p))
+#define strcasecmp_P            strcasecmp
+#define strncasecmp_P           strncasecmp
+#define strcmp_P                strcmp
+#define strncmp_P               strncmp
+#define strlen_P                strlen
+#define memcpy_P                memcpy
+#define strncpy_P               strncpy
+#define snprintf_P              snprintf
+
+class __FlashStringHelper;
+#define F(s) (reinterpret_cast<const __FlashStringHelper*>(PSTR(s)))
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+long random(long howBig);
+long random(long howSmall, long howBig);
+void randomSeed(unsigned long seed);
+
+// 與 Arduino 核心 Print 相同的輸出介面（print 數值時不使用 heap）
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t b) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len--) n += write(*buf++);
+    return n;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  virtual int availableForWrite() { return 0; }
+  virtual void flush() {}
+
+  size_t print(const __FlashStringHelper* s) { return write((const char*)s); }
+  size_t print(const char* s) { return write(s); }
+  size_t print(char c) { return write((uint8_t)c); }
+  size_t print(unsigned char v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(int v, int base = DEC) { return print((long)v, base); }
+  size_t print(unsigned int v, int base = DEC) { return print((unsigned long)v, base); }
+  size_t print(long v, int base = DEC) {
+    char t[24];
+    snprintf(t, sizeof(t), base == HEX ? "%lx" : "%ld", v);
+    return write(t);
+  }
+  size_t print(unsigned long v, int base = DEC) {
+    char t[24];
+    snprintf(t, sizeof(t), base == HEX ? "%lx" : "%lu", v);
+    return write(t);
+  }
+  size_t print(double v, int digits = 2) {
+    char t[32];
+    snprintf(t, sizeof(t), "%.*f", digits, v);
+    return write(t);
+  }
+
+  size_t println() { return write("\r\n"); }
+  template <typename T> size_t println(T v) { size_t n = print(v); return n + println(); }
+  template <typename T> size_t println(T v, int fmt) { size_t n = print(v, fmt); return n + println(); }
+};
+
+#endif // PT2D_NATIVE_ARDUINO_H
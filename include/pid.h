@@ -0,0 +1,74 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file pid.h
+ * @brief 單軸 PID 控制器（死區、抗積分飽和、微分濾波），固定週期呼叫
+ * @details u = kp·e + ∫ki·e dt + kd·de/dt，輸出限制在 ±outMax：
+ *          - 死區：|e| < deadband 時視為 0，且不累加積分，避免在目標附近來回抖動
+ *          - 抗飽和：積分項本身限制在 ±outMax；輸出已飽和且誤差同向時停止累加（條件積分）
+ *          - 微分：對誤差變化率做一階低通 d += alpha·(raw - d)，抑制影像量測雜訊；
+ *            第一筆誤差不計微分（避免起步時的微分衝擊）
+ */
+
+#ifndef PID_H
+#define PID_H
+
+struct PidGains {
+  float kp;
+  float ki;
+  float kd;
+};
+
+struct PidState {
+  float integ;    // 積分項（已乘 ki，與輸出同單位）
+  float dFilt;    // 濾波後的誤差變化率
+  float prevErr;
+  bool primed;    // 已有前一筆誤差
+};
+
+static inline void pidReset(PidState& s) {
+  s.integ = 0.0f;
+  s.dFilt = 0.0f;
+  s.prevErr = 0.0f;
+  s.primed = false;
+}
+
+static inline float pidClamp(float v, float lim) {
+  return v > lim ? lim : (v < -lim ? -lim : v);
+}
+
+// 推進一步：err 為誤差，dt 為週期（秒），返回限制後的輸出
+static inline float pidStep(PidState& s, const PidGains& g, float err, float dt,
+                            float deadband, float dAlpha, float outMax) {
+  if (err < deadband && err > -deadband) err = 0.0f;
+
+  float raw = s.primed ? (err - s.prevErr) / dt : 0.0f;
+  s.dFilt += dAlpha * (raw - s.dFilt);
+  s.prevErr = err;
+  s.primed = true;
+
+  float pd = g.kp * err + g.kd * s.dFilt;
+  float out = pd + s.integ;
+  bool saturated = (out >= outMax && err > 0.0f) || (out <= -outMax && err < 0.0f);
+  if (!saturated) {
+    s.integ = pidClamp(s.integ + g.ki * err * dt, outMax);
+    out = pd + s.integ;
+  }
+  return pidClamp(out, outMax);
+}
+
+#endif // PID_H
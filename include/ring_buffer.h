@@ -0,0 +1,74 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file ring_buffer.h
+ * @brief 單生產者/單消費者（SPSC）無鎖環形緩衝區
+ * @details 容量須為 2 的冪（以遮罩取代取模），最大 256 位元組，
+ *          使 8 位元索引在 AVR 上可原子讀寫。生產者只寫 head，
+ *          消費者只寫 tail，因此 ISR 與主迴圈之間無需關中斷。
+ *          滿時丟棄新位元組並累計 overflows。
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stdint.h>
+
+template <uint16_t N>
+struct RingBuffer {
+  static_assert(N >= 2 && N <= 256 && (N & (N - 1)) == 0,
+                "RingBuffer size must be a power of two in [2, 256]");
+
+  static const uint8_t MASK = (uint8_t)(N - 1);
+
+  uint8_t data[N];
+  volatile uint8_t head;        // 下一個寫入位置（生產者）
+  volatile uint8_t tail;        // 下一個讀取位置（消費者）
+  volatile uint16_t overflows;  // 因緩衝區滿而丟棄的位元組數（生產者寫）
+
+  // 生產者端：寫入一個位元組，滿時返回 false
+  bool push(uint8_t b) {
+    uint8_t h = head;
+    uint8_t next = (uint8_t)(h + 1) & MASK;
+    if (next == tail) {
+      overflows++;
+      return false;
+    }
+    data[h] = b;
+    head = next;
+    return true;
+  }
+
+  // 消費者端：讀出一個位元組，空時返回 -1
+  int pop() {
+    uint8_t t = tail;
+    if (t == head) return -1;
+    uint8_t b = data[t];
+    tail = (uint8_t)(t + 1) & MASK;
+    return b;
+  }
+
+  bool empty() const { return head == tail; }
+
+  // 目前已存位元組數
+  uint8_t size() const { return (uint8_t)(head - tail) & MASK; }
+
+  // 剩餘可寫空間（保留一格區分空/滿）
+  uint8_t space() const { return (uint8_t)(N - 1 - size()); }
+};
+
+#endif // RING_BUFFER_H
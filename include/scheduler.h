@@ -0,0 +1,107 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file scheduler.h
+ * @brief 協作式任務排程器
+ * @details 固定大小任務表，以 halMillis() 期限驅動，不使用動態配置。
+ *          任務本身必須非阻塞（不得呼叫 delay()），每次執行後立即返回。
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <string.h>
+#include "hal.h"
+
+typedef void (*TaskFn)();
+
+struct Task {
+  TaskFn fn;               // 任務函數
+  uint16_t periodMs;       // 執行週期（毫秒），0 = 每輪都執行
+  unsigned long nextRun;   // 下次執行時間（millis）
+};
+
+// 任務執行時間統計（與任務表逐列對應）
+struct TaskStats {
+  uint16_t maxUs;          // 單次執行最長時間（µs，飽和於 65535）
+  uint16_t runs;           // 統計次數（達上限時與 totalUs 一起減半，平均值偏向近期）
+  unsigned long totalUs;
+};
+
+#define SCHED_IDLE      0xFF   // LoopProfile::running：不在任何任務內
+#define SCHED_SETUP     0xFE   // LoopProfile::running：仍在 setup()
+
+// 主迴圈剖析：每輪週期與目前執行中的任務（放在 .noinit 時可於看門狗重置後讀出卡住的任務）
+struct LoopProfile {
+  unsigned long lastStart; // 上一輪開始時間（micros）
+  unsigned long maxUs;     // 最長一輪週期
+  unsigned long totalUs;
+  uint16_t periods;        // 已量測的週期數（達上限時與 totalUs 一起減半）
+  uint8_t running;         // 執行中的任務索引，或 SCHED_IDLE / SCHED_SETUP
+};
+
+// 判斷期限是否已到（halMillis() 溢位安全）
+static inline bool deadlineReached(unsigned long now, unsigned long deadline) {
+  return (long)(now - deadline) >= 0;
+}
+
+// 累加一筆計時；次數達上限時連同總和減半，避免溢位
+static inline void schedulerAccount(uint16_t& n, unsigned long& total, unsigned long us) {
+  if (n == 0xFFFF) {
+    n >>= 1;
+    total >>= 1;
+  }
+  n++;
+  total += us;
+}
+
+// 執行一輪排程：依序呼叫所有到期任務，並記錄本輪週期與各任務執行時間
+static inline void schedulerRun(Task* tasks, TaskStats* stats, uint8_t count, LoopProfile& prof) {
+  unsigned long start = halMicros();
+  if (prof.running == SCHED_IDLE) {
+    unsigned long period = start - prof.lastStart;
+    if (period > prof.maxUs) prof.maxUs = period;
+    schedulerAccount(prof.periods, prof.totalUs, period);
+  }
+  prof.lastStart = start;
+
+  for (uint8_t i = 0; i < count; i++) {
+    Task& t = tasks[i];
+    unsigned long now = halMillis();
+    if (t.periodMs == 0 || deadlineReached(now, t.nextRun)) {
+      t.nextRun = now + t.periodMs;
+      prof.running = i;
+      unsigned long t0 = halMicros();
+      t.fn();
+      unsigned long us = halMicros() - t0;
+      TaskStats& st = stats[i];
+      if (us > st.maxUs) st.maxUs = us > 0xFFFF ? 0xFFFF : (uint16_t)us;
+      schedulerAccount(st.runs, st.totalUs, us);
+    }
+  }
+  prof.running = SCHED_IDLE;
+}
+
+// 清除剖析統計（不影響任務期限）
+static inline void schedulerResetProfile(TaskStats* stats, uint8_t count, LoopProfile& prof) {
+  memset(stats, 0, sizeof(TaskStats) * count);
+  prof.maxUs = 0;
+  prof.totalUs = 0;
+  prof.periods = 0;
+}
+
+#endif // SCHEDULER_H
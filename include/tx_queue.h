@@ -0,0 +1,101 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file tx_queue.h
+ * @brief 非同步傳送佇列（Print 介面）
+ * @details 主迴圈透過 print()/write() 寫入佇列後立即返回，
+ *          由 ISR 呼叫 drain() 在背景寫往實際串口。
+ *          佇列滿時寫入端等待 ISR 騰出空間（不丟棄資料），並累計 stalls。
+ *          整段寫入（write(buf, len)，print 字串亦經此路徑）在長度不超過容量時
+ *          等到整段都放得下才寫入，ISR 不會只看到半段。
+ */
+
+#ifndef TX_QUEUE_H
+#define TX_QUEUE_H
+
+#include "hal.h"
+#include "ring_buffer.h"
+
+template <uint16_t N>
+class TxQueue : public Print {
+ public:
+  explicit TxQueue(Print& port) : port_(port), highWater_(0), stalls_(0) {}
+
+  // 生產者端（主迴圈）：寫入佇列
+  size_t write(uint8_t b) override {
+    if (ring_.space() == 0) {
+      stalls_++;
+      while (ring_.space() == 0) {
+        halIdle();  // 等待 ISR 排空
+      }
+    }
+    ring_.push(b);
+    uint8_t used = ring_.size();
+    if (used > highWater_) highWater_ = used;
+    return 1;
+  }
+
+  size_t write(const uint8_t* buf, size_t len) override {
+    if (len >= N) {
+      for (size_t i = 0; i < len; i++) write(buf[i]);
+      return len;
+    }
+    if (ring_.space() < len) {
+      stalls_++;
+      while (ring_.space() < len) {
+        halIdle();
+      }
+    }
+    for (size_t i = 0; i < len; i++) ring_.push(buf[i]);
+    uint8_t used = ring_.size();
+    if (used > highWater_) highWater_ = used;
+    return len;
+  }
+
+  using Print::write;
+
+  // 消費者端（ISR）：最多寫出 budget 個位元組到實際串口
+  void drain(uint8_t budget) {
+    while (budget > 0) {
+      int b = ring_.pop();
+      if (b < 0) break;
+      port_.write((uint8_t)b);
+      budget--;
+    }
+  }
+
+  bool idle() const { return ring_.empty(); }
+
+  // 捨棄待送資料（僅限背景搬運未執行時呼叫，例如基準測試的計時區間之間）
+  void clear() {
+    while (ring_.pop() >= 0) {}
+  }
+
+  // 佇列曾達到的最大占用（位元組）
+  uint8_t highWater() const { return highWater_; }
+
+  // 寫入端因佇列滿而等待的次數
+  uint16_t stalls() const { return stalls_; }
+
+ private:
+  Print& port_;
+  RingBuffer<N> ring_;
+  uint8_t highWater_;
+  uint16_t stalls_;
+};
+
+#endif // TX_QUEUE_H
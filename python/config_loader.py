@@ -111,6 +111,18 @@ class ConfigLoader:
     def iou_threshold(self):
         return self.config.getfloat('AI_DETECTION', 'iou_threshold', fallback=0.45)
 
+    @property
+    def nms_method(self):
+        return self.config.get('AI_DETECTION', 'nms_method', fallback='hard').strip().lower()
+
+    @property
+    def nms_class_aware(self):
+        return self.config.getboolean('AI_DETECTION', 'nms_class_aware', fallback=False)
+
+    @property
+    def soft_nms_sigma(self):
+        return self.config.getfloat('AI_DETECTION', 'soft_nms_sigma', fallback=0.5)
+
     @property
     def detection_mode(self):
         return self.config.get('AI_DETECTION', 'detection_mode', fallback='tiling')
@@ -119,6 +131,14 @@ class ConfigLoader:
     def tile_overlap(self):
         return self.config.getfloat('AI_DETECTION', 'tile_overlap', fallback=0.25)
 
+    @property
+    def tile_batch_size(self):
+        return self.config.getint('AI_DETECTION', 'tile_batch_size', fallback=1)
+
+    @property
+    def npu_cores(self):
+        return self.config.getint('AI_DETECTION', 'npu_cores', fallback=1)
+
     @property
     def detection_margin(self):
         return self.config.getfloat('AI_DETECTION', 'detection_margin', fallback=0.0)
@@ -209,6 +229,50 @@ class ConfigLoader:
     def target_lock_distance(self):
         return self.config.getint('TRACKING', 'target_lock_distance', fallback=100)
 
+    @property
+    def device_tracking(self):
+        return self.config.getboolean('TRACKING', 'device_tracking', fallback=False)
+
+    @property
+    def track_kp(self):
+        return self.config.getfloat('TRACKING', 'track_kp', fallback=15.0)
+
+    @property
+    def track_ki(self):
+        return self.config.getfloat('TRACKING', 'track_ki', fallback=3.0)
+
+    @property
+    def track_kd(self):
+        return self.config.getfloat('TRACKING', 'track_kd', fallback=0.15)
+
+    @property
+    def track_deg_per_px(self):
+        return self.config.getfloat('TRACKING', 'track_deg_per_px', fallback=0.094)
+
+    @property
+    def enable_prediction(self):
+        return self.config.getboolean('TRACKING', 'enable_prediction', fallback=True)
+
+    @property
+    def prediction_model(self):
+        return self.config.get('TRACKING', 'prediction_model', fallback='cv').strip().lower()
+
+    @property
+    def prediction_process_noise(self):
+        return self.config.getfloat('TRACKING', 'prediction_process_noise', fallback=1.0e6)
+
+    @property
+    def prediction_measurement_noise(self):
+        return self.config.getfloat('TRACKING', 'prediction_measurement_noise', fallback=4.0)
+
+    @property
+    def actuation_delay(self):
+        return self.config.getfloat('TRACKING', 'actuation_delay', fallback=0.03)
+
+    @property
+    def max_prediction_horizon(self):
+        return self.config.getfloat('TRACKING', 'max_prediction_horizon', fallback=0.3)
+
     # 硬體相關配置
     @property
     def arduino_port(self):
@@ -219,9 +219,14 @@ def generate_rknn_model(
     onnx_model_path: Path,
     dataset_list_path: Path,
     rknn_output_dir: Path,
-    verbose: bool = True
+    verbose: bool = True,
+    batch_size: int = 1
 ) -> Optional[Path]:
-    """生成 RKNN 模型（Orange Pi 5），使用 dataset.txt 清單"""
+    """
+    生成 RKNN 模型（Orange Pi 5），使用 dataset.txt 清單
+
+    batch_size > 1 時模型一次推理多張影像（平鋪模式的 tile_batch_size 需設為相同值）
+    """
     if verbose:
         print(f"\n🔧 生成 Orange Pi 5 RKNN 模型...")
 
@@ -290,8 +295,8 @@ def generate_rknn_model(
 
         # 執行量化
         if verbose:
-            print("  執行量化（預計需要 2-5 分鐘）...")
-        ret = rknn.build(do_quantization=True, dataset=str(dataset_list_path))
+            print(f"  執行量化（預計需要 2-5 分鐘，batch={batch_size}）...")
+        ret = rknn.build(do_quantization=True, dataset=str(dataset_list_path), rknn_batch_size=batch_size)
         if ret != 0:
             print("❌ 量化失敗")
             rknn.release()
@@ -439,6 +444,9 @@ def main():
 
   # 跳過特定轉換
   python model_converter.py --skip-onnx --skip-rknn
+
+  # 平鋪模式批次推理（mosquito.ini: tile_batch_size = 4）
+  python model_converter.py --pt-model model.pt --rknn-batch-size 4
         """
     )
 
@@ -468,6 +476,13 @@ def main():
         help="校準數據集目錄"
     )
 
+    parser.add_argument(
+        '--rknn-batch-size',
+        type=int,
+        default=1,
+        help="RKNN 模型批次大小（平鋪模式一次推理多個視窗，需與 mosquito.ini 的 tile_batch_size 相同）"
+    )
+
     parser.add_argument(
         '--skip-onnx',
         action='store_true',
@@ -526,7 +541,8 @@ def main():
     # 4. 生成 RKNN
     rknn_path = None
     if not args.skip_rknn and onnx_path:
-        rknn_path = generate_rknn_model(onnx_path, dataset_list_path, output_dir)
+        rknn_path = generate_rknn_model(onnx_path, dataset_list_path, output_dir,
+                                        batch_size=max(1, args.rknn_batch_size))
 
     # 5. 顯示摘要
     print_summary(output_dir, None, onnx_path, rknn_path)
@@ -27,9 +27,12 @@ import os
 import time
 import datetime
 import hashlib
+import queue
 import traceback
+from concurrent.futures import ThreadPoolExecutor
 from pathlib import Path
 from config_loader import config
+from yolo_postprocess import NMS_METHODS, decode_yolo, nms
 
 # 从新配置中获取默认值
 DEFAULT_IMGSZ = config.imgsz
@@ -67,6 +70,9 @@ except ImportError:
     HOBOT_DNN_AVAILABLE = False
     logger.debug("hobot_dnn 未安裝（僅 RDK X5 需要）")
 
+# RK3588 NPU 核心數（平鋪模式可在每個核心各載入一份模型同時推理）
+RKNN_MAX_CORES = 3
+
 # ONNX 和 PyTorch 僅用於訓練和模型轉換，不用於實際偵測
 # 實際部署時請使用硬體加速格式：.bin (RDK X5) 或 .rknn (Orange Pi 5)
 
@@ -121,6 +127,14 @@ class MosquitoDetector:
         self.model = None
         self.backend = None  # 'rknn', 'onnx', 'pytorch'
 
+        # NMS 設定（方法、類別感知、高斯 soft-NMS 參數）
+        self.nms_method = config.nms_method
+        if self.nms_method not in NMS_METHODS:
+            logger.warning(f"未知的 NMS 方法: {self.nms_method}，改用 'hard'")
+            self.nms_method = 'hard'
+        self.nms_class_aware = config.nms_class_aware
+        self.soft_nms_sigma = max(1e-3, config.soft_nms_sigma)
+
         # 偵測模式
         self.detection_mode = detection_mode.lower() if isinstance(detection_mode, str) else 'tiling'
         if self.detection_mode not in ('tiling', 'whole'):
@@ -132,6 +146,9 @@ class MosquitoDetector:
         except Exception:
             self.tile_overlap = DEFAULT_TILE_OVERLAP
         self.tile_overlap = max(0.0, min(0.5, self.tile_overlap))
+        # 平鋪批次推理：每次 NPU 呼叫的視窗數（需與模型批次大小相同）與同時使用的 NPU 核心數
+        self.tile_batch_size = max(1, config.tile_batch_size)
+        self.npu_cores = max(1, min(RKNN_MAX_CORES, config.npu_cores))
 
         # 檢測邊界邊距
         try:
@@ -300,20 +317,34 @@ class MosquitoDetector:
         logger.info("✓ RDK X5 BPU 加速已啟用")
 
     def _load_rknn_model(self, model_path: str):
-        """載入 RKNN 模型（NPU 加速）"""
-        logger.info(f"載入 RKNN 模型: {model_path}")
-        self.rknn = RKNNLite()
-
-        ret = self.rknn.load_rknn(model_path)
-        if ret != 0:
-            raise RuntimeError(f'載入 RKNN 模型失敗: {ret}')
+        """
+        載入 RKNN 模型（NPU 加速）
 
-        ret = self.rknn.init_runtime(core_mask=RKNNLite.NPU_CORE_0)
-        if ret != 0:
-            raise RuntimeError(f'初始化 RKNN 執行環境失敗: {ret}')
+        npu_cores > 1 時每個核心各建立一個執行環境，平鋪視窗的推理工作分散到各核心同時執行；
+        self.rknn 為第一個核心的執行環境（整張影像模式使用）
+        """
+        logger.info(f"載入 RKNN 模型: {model_path}")
+        core_masks = [RKNNLite.NPU_CORE_0, RKNNLite.NPU_CORE_1, RKNNLite.NPU_CORE_2][:self.npu_cores]
+        self.rknn_runtimes = []
+        for core, core_mask in enumerate(core_masks):
+            runtime = RKNNLite()
+            ret = runtime.load_rknn(model_path)
+            if ret != 0:
+                raise RuntimeError(f'載入 RKNN 模型失敗: {ret}')
+            ret = runtime.init_runtime(core_mask=core_mask)
+            if ret != 0:
+                raise RuntimeError(f'初始化 RKNN 執行環境失敗（NPU 核心 {core}）: {ret}')
+            self.rknn_runtimes.append(runtime)
+        self.rknn = self.rknn_runtimes[0]
+
+        # 閒置的執行環境；平鋪推理工作取用後歸還，同時進行的工作數等於核心數
+        self._rknn_idle = queue.Queue()
+        for runtime in self.rknn_runtimes:
+            self._rknn_idle.put(runtime)
+        self._tile_pool = ThreadPoolExecutor(max_workers=len(self.rknn_runtimes), thread_name_prefix='rknn')
 
         self.backend = 'rknn'
-        logger.info("✓ RKNN NPU 加速已啟用")
+        logger.info(f"✓ RKNN NPU 加速已啟用（{len(self.rknn_runtimes)} 核心，平鋪批次 {self.tile_batch_size}）")
 
     def _check_sample_count(self) -> bool:
         """
@@ -661,34 +692,12 @@ class MosquitoDetector:
 
         return filtered
 
-    def _run_backend_once(self, img: np.ndarray) -> List[Dict]:
-        """
-        使用目前後端在單張影像上推理（回傳偵測結果，座標相對於 img）。
-        """
-        if self.backend == 'hobot_dnn':
-            dets, _ = self._detect_hobot(img)
-            return dets
-        elif self.backend == 'rknn':
-            dets, _ = self._detect_rknn(img)
-            return dets
-        else:
-            raise RuntimeError(f"未知的推理後端: {self.backend}")
-
-    def _detect_tiled(self, frame: np.ndarray) -> Tuple[List[Dict], np.ndarray]:
-        """
-        平鋪(tiling)推理：
-        - 以 imgsz 為方形視窗對原圖滑動，視窗間有一定重疊
-        - 各視窗內獨立推理，轉換回全域座標
-        - 以全域 NMS 合併重疊框，避免重複計數
-        """
-        h, w = frame.shape[:2]
+    def _tile_origins(self, w: int, h: int) -> List[Tuple[int, int]]:
+        """平鋪視窗的左上角座標（以 imgsz 為邊長、依 tile_overlap 重疊，確保覆蓋到邊界）"""
         tile = int(self.imgsz)
         # 重疊比例轉為步長（像素）
         stride = max(1, int(tile * (1.0 - self.tile_overlap)))
 
-        merged: List[Dict] = []
-
-        # 產生滑動視窗的起點（確保覆蓋到邊界）
         xs = list(range(0, max(1, w - tile + 1), stride))
         ys = list(range(0, max(1, h - tile + 1), stride))
         if len(xs) == 0:
@@ -699,77 +708,157 @@ class MosquitoDetector:
             xs.append(max(0, w - tile))
         if ys[-1] != max(0, h - tile):
             ys.append(max(0, h - tile))
+        return [(x0, y0) for y0 in ys for x0 in xs]
+
+    def _detect_tiled(self, frame: np.ndarray) -> Tuple[List[Dict], np.ndarray]:
+        """
+        平鋪(tiling)推理：
+        - 以 imgsz 為方形視窗對原圖滑動，視窗間有一定重疊
+        - 視窗為原圖（RKNN 為整張轉換一次色彩後）的切片，不複製；
+          依 tile_batch_size 打包成批次張量，分散到 npu_cores 個 NPU 核心同時推理
+        - 所有視窗的輸出一次解碼並轉換回全域座標
+        - 以全域 NMS 合併重疊框，避免重複計數
+        """
+        h, w = frame.shape[:2]
+        tile = int(self.imgsz)
+        origins = self._tile_origins(w, h)
+
+        # RKNN 輸入為 RGB：整張轉換一次，重疊區域不重複轉換
+        src = cv2.cvtColor(frame, cv2.COLOR_BGR2RGB) if self.backend == 'rknn' else frame
+        patches = [src[y0:min(h, y0 + tile), x0:min(w, x0 + tile)] for x0, y0 in origins]
 
-        for y0 in ys:
-            for x0 in xs:
-                x1 = min(w, x0 + tile)
-                y1 = min(h, y0 + tile)
-                patch = frame[y0:y1, x0:x1]
+        outputs = self._infer_tiles(patches)
+        return self._merge_tile_outputs(outputs, origins, patches), frame
 
-                # 在子影像上推理（座標相對於 patch）
-                dets = self._run_backend_once(patch)
+    def _tile_input(self, patch: np.ndarray) -> np.ndarray:
+        """視窗縮放到模型輸入大小（邊長已是 imgsz 時直接使用切片）"""
+        if patch.shape[0] == self.imgsz and patch.shape[1] == self.imgsz:
+            return patch
+        return cv2.resize(patch, (self.imgsz, self.imgsz))
+
+    def _infer_tiles(self, patches: List[np.ndarray]) -> List[Optional[np.ndarray]]:
+        """
+        推理所有視窗，返回各視窗的 YOLO 輸出（與 patches 同順序；推理失敗的視窗為 None）
+        """
+        if self.backend == 'hobot_dnn':
+            return [self.hobot_models[0].forward(dnn.pyimg_to_nv12(self._tile_input(p)))[0].buffer
+                    for p in patches]
+        if self.backend != 'rknn':
+            raise RuntimeError(f"未知的推理後端: {self.backend}")
 
-                # 轉為全域座標並暫存
-                for d in dets:
-                    bx, by, bw, bh = d['bbox']
-                    cx, cy = d['center']
-                    nd = d.copy()
-                    nd['bbox'] = (bx + x0, by + y0, bw, bh)
-                    nd['center'] = (cx + x0, cy + y0)
-                    merged.append(nd)
+        # 每 tile_batch_size 個視窗打包成一個批次張量（最後一批不足時補 0），各批次交給閒置的 NPU 核心
+        batch = self.tile_batch_size
+        jobs = []
+        for start in range(0, len(patches), batch):
+            chunk = patches[start:start + batch]
+            tensor = np.zeros((batch, self.imgsz, self.imgsz, 3), dtype=np.uint8)
+            for k, patch in enumerate(chunk):
+                tensor[k] = self._tile_input(patch)
+            jobs.append((len(chunk), self._tile_pool.submit(self._rknn_infer, tensor)))
+
+        outputs: List[Optional[np.ndarray]] = []
+        for count, job in jobs:
+            output = job.result()
+            if output is None:
+                outputs.extend([None] * count)
+            else:
+                outputs.extend(output[k:k + 1] for k in range(count))
+        return outputs
 
-        # 全域 NMS 合併
-        merged = self._nms(merged, self.iou_threshold)
-        return merged, frame
+    def _rknn_infer(self, tensor: np.ndarray) -> Optional[np.ndarray]:
+        """在一個閒置的 NPU 核心上推理一個批次，返回第一個輸出張量（[batch, ...]），失敗返回 None"""
+        runtime = self._rknn_idle.get()
+        try:
+            outputs = runtime.inference(inputs=[tensor])
+        except Exception as e:
+            logger.error(f"❌ RKNN 平鋪推理異常: {type(e).__name__} - {e}")
+            return None
+        finally:
+            self._rknn_idle.put(runtime)
+        if not outputs or outputs[0] is None or getattr(outputs[0], 'size', 0) == 0:
+            logger.warning("⚠️  RKNN 平鋪推理輸出為空")
+            return None
+        if outputs[0].shape[0] != tensor.shape[0]:
+            logger.error(f"❌ RKNN 輸出批次 {outputs[0].shape[0]} 與 tile_batch_size {tensor.shape[0]} 不符，"
+                         f"請確認模型轉換時的 --rknn-batch-size")
+            return None
+        return outputs[0]
+
+    def _merge_tile_outputs(self, outputs: List[Optional[np.ndarray]], origins: List[Tuple[int, int]],
+                            patches: List[np.ndarray]) -> List[Dict]:
+        """
+        解碼各視窗輸出並一次轉換為全域座標，全域 NMS 後才建立偵測結果
+        （被抑制的重複框不建立 dict）
+        """
+        decoded, tile_index = [], []
+        for k, output in enumerate(outputs):
+            if output is None:
+                continue
+            try:
+                dets = decode_yolo(output, self.confidence_threshold)
+            except Exception as e:
+                logger.error(f"❌ 平鋪視窗後處理失敗: {e}")
+                continue
+            decoded.append(dets)
+            tile_index.append(np.full(len(dets), k, dtype=np.int32))
+        if not decoded:
+            return []
+        dets = np.concatenate(decoded)
+        if len(dets) == 0:
+            return []
+        tile_index = np.concatenate(tile_index)
+
+        sizes = np.array([(p.shape[1], p.shape[0]) for p in patches], dtype=np.float32)
+        offsets = np.array(origins, dtype=np.int64)
+        x1, y1, bw, bh, cx, cy = self._pixel_boxes(dets, sizes[tile_index, 0], sizes[tile_index, 1])
+        ox, oy = offsets[tile_index, 0], offsets[tile_index, 1]
+        x1, y1, cx, cy = x1 + ox, y1 + oy, cx + ox, cy + oy
+
+        boxes = np.stack([x1, y1, x1 + bw, y1 + bh], axis=1).astype(np.float32)
+        classes = dets['class_id'] if self.nms_class_aware else None
+        keep, kept_scores = self._nms_boxes(boxes, dets['confidence'], self.iou_threshold, classes)
+        return [self._make_detection(x1[i], y1[i], bw[i], bh[i], cx[i], cy[i], float(s), dets['class_id'][i])
+                for i, s in zip(keep, kept_scores)]
 
     def _nms(self, detections: List[Dict], iou_thresh: float) -> List[Dict]:
-        """簡單的全域 NMS（按信心度排序，移除 IoU 過高的重疊框）"""
+        """
+        全域 NMS（按信心度排序，移除 IoU 過高的重疊框）
+
+        方法與類別感知由 [AI_DETECTION] nms_method / nms_class_aware 設定；
+        soft-NMS 會降低重疊框的信心度，衰減後低於 confidence_threshold 的框移除。
+        """
         if not detections:
             return []
 
-        # 轉為 (x1,y1,x2,y2,conf,idx)
-        boxes = []
+        boxes = np.empty((len(detections), 4), dtype=np.float32)
+        scores = np.empty(len(detections), dtype=np.float32)
         for i, d in enumerate(detections):
             x, y, w, h = d['bbox']
-            boxes.append((x, y, x + w, y + h, d['confidence'], i))
-
-        # 依信心度由高到低排序
-        boxes.sort(key=lambda b: b[4], reverse=True)
-
-        keep = []
-        suppressed = set()
-        for i in range(len(boxes)):
-            if i in suppressed:
-                continue
-            keep.append(detections[boxes[i][5]])
-            xi1, yi1, xi2, yi2, ci, _ = boxes[i]
-            for j in range(i + 1, len(boxes)):
-                if j in suppressed:
-                    continue
-                xj1, yj1, xj2, yj2, cj, _ = boxes[j]
-                if self._iou((xi1, yi1, xi2, yi2), (xj1, yj1, xj2, yj2)) > iou_thresh:
-                    suppressed.add(j)
-
-        return keep
+            boxes[i] = (x, y, x + w, y + h)
+            scores[i] = d['confidence']
+        classes = None
+        if self.nms_class_aware:
+            classes = np.fromiter((d.get('class_id', 0) for d in detections), dtype=np.int32, count=len(detections))
+
+        keep, kept_scores = self._nms_boxes(boxes, scores, iou_thresh, classes)
+        if self.nms_method == 'hard':
+            return [detections[i] for i in keep]
+        # 只有被衰減的框才改寫信心度（未衰減者保留原本的精確值）
+        result = []
+        for i, s in zip(keep, kept_scores):
+            d = detections[i]
+            result.append(d if s == np.float32(d['confidence']) else dict(d, confidence=float(s)))
+        return result
 
-    @staticmethod
-    def _iou(a: Tuple[int, int, int, int], b: Tuple[int, int, int, int]) -> float:
-        """計算兩個框的 IoU，框格式為 (x1,y1,x2,y2)"""
-        ax1, ay1, ax2, ay2 = a
-        bx1, by1, bx2, by2 = b
-        inter_x1 = max(ax1, bx1)
-        inter_y1 = max(ay1, by1)
-        inter_x2 = min(ax2, bx2)
-        inter_y2 = min(ay2, by2)
-        inter_w = max(0, inter_x2 - inter_x1)
-        inter_h = max(0, inter_y2 - inter_y1)
-        inter = inter_w * inter_h
-        area_a = max(0, ax2 - ax1) * max(0, ay2 - ay1)
-        area_b = max(0, bx2 - bx1) * max(0, by2 - by1)
-        union = area_a + area_b - inter
-        if union <= 0:
-            return 0.0
-        return inter / union
+    def _nms_boxes(self, boxes: np.ndarray, scores: np.ndarray, iou_thresh: float,
+                   classes: Optional[np.ndarray] = None) -> Tuple[np.ndarray, np.ndarray]:
+        """
+        以陣列執行 NMS：boxes 為 (n, 4) 的 (x1, y1, x2, y2)，返回 (保留索引, 分數)
+        計算由 yolo_postprocess.nms 完成（有編譯 pt2d_native 時為 C++ 網格 + SIMD 版本）
+        """
+        soft = self.nms_method != 'hard'
+        return nms(boxes, scores, iou_thresh, classes, method=self.nms_method, sigma=self.soft_nms_sigma,
+                   score_threshold=self.confidence_threshold if soft else 0.0)
 
     def _detect_hobot(self, frame: np.ndarray) -> Tuple[List[Dict], np.ndarray]:
         """使用 RDK X5 BPU (hobot_dnn) 推理"""
@@ -860,6 +949,7 @@ class MosquitoDetector:
         解析 YOLO 輸出（ONNX/RKNN 通用）
 
         ⚠️ 注意：自動處理未歸一化的輸出（應用 sigmoid）
+        解碼由 yolo_postprocess.decode_yolo 完成（有編譯 pt2d_native 時為 C++ 版本）
 
         Args:
             output: 模型輸出張量
@@ -868,69 +958,18 @@ class MosquitoDetector:
         Returns:
             偵測結果列表
         """
-        detections = []
         h_orig, w_orig = original_shape
 
         # YOLO 輸出格式: [batch, num_boxes, 85] 或 [batch, 85, num_boxes]
         # 85 = x_center, y_center, width, height, objectness, 80 classes
+        # objectness / 類別分數一律視為 logit 套用 sigmoid；兩種布局直接解碼，不轉置
+        dets = decode_yolo(output, self.confidence_threshold)
 
-        # 調整輸出形狀
-        if len(output.shape) == 3:
-            if output.shape[2] == 85:
-                pass  # [1, num_boxes, 85]
-            elif output.shape[1] == 85:
-                output = output.transpose(0, 2, 1)  # [1, 85, num_boxes] → [1, num_boxes, 85]
-
-        output = output[0]  # 移除 batch 維度
-
-        # 檢查是否需要 sigmoid（調試用）
-        if len(output) > 0:
-            max_objectness = np.max(output[:, 4])
-            if max_objectness > 10.0:  # 明顯未歸一化
-                logger.debug(f"檢測到未歸一化輸出 (max objectness: {max_objectness:.2f})，將應用 sigmoid")
-
-        for detection in output:
-            objectness = detection[4]
-
-            # ⚠️ 重要：統一使用 sigmoid 將 objectness 壓到 [0, 1]
-            objectness = 1.0 / (1.0 + np.exp(-objectness))  # sigmoid
-
-            if objectness < self.confidence_threshold:
-                continue
-
-            # 解析座標
-            x_center, y_center, width, height = detection[:4]
-
-            # 轉換為原始影像座標
-            x_center = x_center / self.imgsz * w_orig
-            y_center = y_center / self.imgsz * h_orig
-            width = width / self.imgsz * w_orig
-            height = height / self.imgsz * h_orig
-
-            x1 = int(x_center - width / 2)
-            y1 = int(y_center - height / 2)
-            w = int(width)
-            h = int(height)
-
-            # 類別概率（同樣需要確保在 [0, 1] 範圍）
-            class_scores = detection[5:]
-            # 對類別分數統一應用 sigmoid，避免部分裝置輸出 logits 導致過高
-            class_scores = 1.0 / (1.0 + np.exp(-class_scores))
-
-            class_id = int(np.argmax(class_scores))
-            confidence = float(objectness * class_scores[class_id])
-
-            # 最終確保 confidence 在合理範圍內
-            confidence = min(1.0, max(0.0, confidence))
-
-            if confidence >= self.confidence_threshold:
-                detections.append({
-                    'bbox': (x1, y1, w, h),
-                    'confidence': confidence,
-                    'class_id': class_id,
-                    'class_name': f'class_{class_id}',
-                    'center': (int(x_center), int(y_center))
-                })
+        # 轉換為原始影像座標（只對通過閾值的少數候選做）
+        x1, y1, w, h, cx, cy = self._pixel_boxes(dets, w_orig, h_orig)
+        detections = [self._make_detection(x1[i], y1[i], w[i], h[i], cx[i], cy[i],
+                                           float(dets['confidence'][i]), dets['class_id'][i])
+                      for i in range(len(dets))]
 
         # 追加偵測信心度統計（debug 用）
         if logger.isEnabledFor(logging.DEBUG) and detections:
@@ -944,6 +983,35 @@ class MosquitoDetector:
         return detections
 
 
+    def _pixel_boxes(self, dets: np.ndarray, w_orig, h_orig) -> Tuple[np.ndarray, ...]:
+        """
+        解碼結果（模型輸入座標）轉為影像像素整數框
+
+        w_orig / h_orig 可為純量或逐筆陣列（平鋪時各視窗大小不同）
+
+        Returns:
+            (x1, y1, w, h, cx, cy)，與原本逐筆 int() 相同採無條件捨去至 0
+        """
+        x_center = dets['cx'] / self.imgsz * w_orig
+        y_center = dets['cy'] / self.imgsz * h_orig
+        width = dets['w'] / self.imgsz * w_orig
+        height = dets['h'] / self.imgsz * h_orig
+        return (np.trunc(x_center - width / 2).astype(np.int64), np.trunc(y_center - height / 2).astype(np.int64),
+                np.trunc(width).astype(np.int64), np.trunc(height).astype(np.int64),
+                np.trunc(x_center).astype(np.int64), np.trunc(y_center).astype(np.int64))
+
+    @staticmethod
+    def _make_detection(x1, y1, w, h, cx, cy, confidence: float, class_id) -> Dict:
+        """建立偵測結果 dict（座標為影像像素）"""
+        class_id = int(class_id)
+        return {
+            'bbox': (int(x1), int(y1), int(w), int(h)),
+            'confidence': confidence,
+            'class_id': class_id,
+            'class_name': f'class_{class_id}',
+            'center': (int(cx), int(cy))
+        }
+
     def get_largest_detection(self, detections: List[Dict]) -> Optional[Dict]:
         """
         獲取信心度最高的偵測結果
@@ -1009,6 +1077,12 @@ class MosquitoDetector:
             # 繪製中心點
             cv2.circle(result, (cx, cy), 3, (0, 0, 255), -1)
 
+            # 預測瞄準點（啟用運動預測時）：中心指向命令生效時的預測位置
+            if 'predicted_center' in detection:
+                px, py = detection['predicted_center']
+                cv2.line(result, (cx, cy), (px, py), (255, 0, 255), 1)
+                cv2.drawMarker(result, (px, py), (255, 0, 255), cv2.MARKER_CROSS, 10, 1)
+
             # 標註類別和信心度
             label = f"{class_name}: {confidence:.2f}"
             (label_w, label_h), _ = cv2.getTextSize(label, cv2.FONT_HERSHEY_SIMPLEX, 0.5, 1)
@@ -1028,8 +1102,11 @@ class MosquitoDetector:
         try:
             if self.backend == 'rknn' and hasattr(self, 'rknn'):
                 logger.info("正在釋放 RKNN 模型...")
-                if hasattr(self.rknn, 'release'):
-                    self.rknn.release()
+                if hasattr(self, '_tile_pool'):
+                    self._tile_pool.shutdown(wait=True)
+                for runtime in getattr(self, 'rknn_runtimes', [self.rknn]):
+                    if hasattr(runtime, 'release'):
+                        runtime.release()
                 logger.info("✓ RKNN 資源已釋放")
         except Exception as e:
             logger.error(f"RKNN 清理失敗: {e}")
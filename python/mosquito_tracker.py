@@ -29,6 +29,7 @@ from config_loader import config
 from mosquito_detector import MosquitoDetector
 from pt2d_controller import PT2DController
 from temperature_monitor import TemperatureMonitor
+from target_predictor import GimbalHistory, LatencyEstimator, NATIVE_AVAILABLE, predictor_from_config
 
 logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger(__name__)
@@ -105,6 +106,19 @@ class MosquitoTracker:
         self.pan_gain = config.pan_gain   # Pan 增益（控制靈敏度）
         self.tilt_gain = config.tilt_gain  # Tilt 增益（控制靈敏度）
 
+        # 固件端視覺伺服：只送像素誤差，PID 閉環在 Arduino 上以 50 Hz 執行
+        self.device_tracking = config.device_tracking
+
+        # 目標運動預測：瞄準命令生效時的位置（影像時間 + 實測端到端延遲），而非最後看到的位置
+        self.enable_prediction = config.enable_prediction
+        self.deg_per_px = config.track_deg_per_px
+        self.latency = LatencyEstimator(actuation_delay=config.actuation_delay)
+        self.gimbal_history = GimbalHistory()
+        self.predictor = None
+        if self.enable_prediction:
+            logger.info(f"啟用目標運動預測（{config.prediction_model.upper()} 卡爾曼濾波，"
+                        f"{'C++' if NATIVE_AVAILABLE else '純 Python'} 實作）")
+
         # 串流伺服器（可選）
         self.streaming_server = streaming_server
 
@@ -161,6 +175,13 @@ class MosquitoTracker:
         time.sleep(1.0)  # 等待雲台移動完成
         logger.info("雲台已置中，等待偵測目標...")
 
+        if self.device_tracking:
+            response = self.controller.set_track_pid(config.track_kp, config.track_ki,
+                                                     config.track_kd, config.track_deg_per_px)
+            if 'kp' not in response:
+                logger.warning(f"固件不支援視覺伺服（{response}），改用上位機比例控制")
+                self.device_tracking = False
+
         return True
 
     def calculate_target_angles(self, target_x: int, target_y: int) -> Tuple[int, int]:
@@ -187,6 +208,87 @@ class MosquitoTracker:
 
         return pan_delta, tilt_delta
 
+    def _predict_aim(self, target_x: int, target_y: int, frame_time: float,
+                     relock: bool) -> Optional[Tuple[float, float, float, float]]:
+        """
+        以卡爾曼濾波預測命令生效時的目標角度
+
+        量測換算為世界座標（拍攝時雲台角度 / 每像素角度 + 影像偏移，單位為像素），
+        雲台自身的轉動不會被當成目標運動。
+
+        Returns:
+            (預測 pan, 預測 tilt, 拍攝時 pan, 拍攝時 tilt) 角度，無法取得雲台角度時返回 None
+        """
+        pan, tilt = self.controller.get_position()
+        if pan is None or tilt is None:
+            return None
+        self.gimbal_history.record(time.time(), pan, tilt)
+        cap_pan, cap_tilt = self.gimbal_history.at(frame_time)
+
+        # 影像 Y 向下為正、Tilt 向上為正
+        dpp = self.deg_per_px
+        wx = cap_pan / dpp + (target_x - self.camera_width // 2)
+        wy = (target_y - self.camera_height // 2) - cap_tilt / dpp
+        if relock or self.predictor is None:
+            self.predictor = predictor_from_config(config, self.latency)
+        self.predictor.update(wx, wy, frame_time)
+        aim_x, aim_y = self.predictor.aim_point(frame_time)
+        return aim_x * dpp, -aim_y * dpp, cap_pan, cap_tilt
+
+    def _aim_with_prediction(self, target_x: int, target_y: int, frame_time: float,
+                             relock: bool, camera_side: str):
+        """以預測位置瞄準；無法取得雲台角度時返回 False（改用最後觀測位置）"""
+        try:
+            aim = self._predict_aim(target_x, target_y, frame_time, relock)
+        except Exception as e:
+            logger.error(f"讀取雲台角度失敗: {e}")
+            return False
+        if aim is None:
+            return False
+        pan, tilt, cap_pan, cap_tilt = aim
+        try:
+            if self.device_tracking:
+                # 固件以 age_ms 扣除拍攝後雲台已轉過的角度，這裡送出相對拍攝時雲台的預測誤差
+                ex = (pan - cap_pan) / self.deg_per_px
+                ey = (cap_tilt - tilt) / self.deg_per_px
+                self.controller.track(round(ex), round(ey), (time.time() - frame_time) * 1000)
+            else:
+                current_pan, current_tilt = self.gimbal_history.at(time.time())
+                if abs(pan - current_pan) > 2 or abs(tilt - current_tilt) > 2:
+                    self.controller.move_to(round(pan), round(tilt))
+                    logger.debug(f"[{camera_side}] 預測瞄準: Pan={pan:.1f}° Tilt={tilt:.1f}° "
+                                 f"(延遲 {self.latency.total * 1000:.0f}ms)")
+            self.predictor.command_done(frame_time)
+        except Exception as e:
+            logger.error(f"雲台移動失敗: {e}")
+            # 串口錯誤不中斷追蹤，繼續處理下一幀
+        return True
+
+    def _aim_at_observation(self, target_x: int, target_y: int, frame_time: float,
+                            camera_side: str, confidence: float):
+        """瞄準最後觀測到的位置（不預測）"""
+        if self.device_tracking:
+            # 固件端閉環：送出像素誤差與影像延遲，死區與增益由固件處理
+            age_ms = (time.time() - frame_time) * 1000
+            try:
+                self.controller.track(target_x - self.camera_width // 2,
+                                      target_y - self.camera_height // 2, age_ms)
+            except Exception as e:
+                logger.error(f"視覺伺服誤差送出失敗: {e}")
+            return
+
+        # 計算角度增量
+        pan_delta, tilt_delta = self.calculate_target_angles(target_x, target_y)
+
+        # 只有在偏離中心較大時才移動
+        if abs(pan_delta) > 2 or abs(tilt_delta) > 2:
+            try:
+                self.controller.move_by(pan_delta, tilt_delta)
+                logger.debug(f"[{camera_side}] AI 追蹤移動: Pan={pan_delta}, Tilt={tilt_delta}, 信心度={confidence:.2f}")
+            except Exception as e:
+                logger.error(f"雲台移動失敗: {e}")
+                # 串口錯誤不中斷追蹤，繼續處理下一幀
+
     def _find_closest_detection(self, detections, target_position):
         """
         從檢測列表中找到與目標位置最接近的檢測
@@ -219,7 +321,8 @@ class MosquitoTracker:
             return closest_detection
         return None
 
-    def track_mosquito(self, left_detections, right_detections, left_frame, right_frame):
+    def track_mosquito(self, left_detections, right_detections, left_frame, right_frame,
+                       frame_time: float = None):
         """
         追蹤蚊子邏輯（支援多目標，鎖定追蹤單一目標直到失去）
 
@@ -228,8 +331,11 @@ class MosquitoTracker:
             right_detections: 右攝像頭 AI 偵測結果列表
             left_frame: 左攝像頭影像幀
             right_frame: 右攝像頭影像幀
+            frame_time: 影像讀取時間（time.time()），固件端視覺伺服據此扣除偵測延遲
         """
         current_time = time.time()
+        if frame_time is None:
+            frame_time = current_time
 
         # 選擇目標策略：
         # 1. 如果正在追蹤，優先追蹤最接近上次位置的目標（目標鎖定）
@@ -287,6 +393,8 @@ class MosquitoTracker:
         if best_detection:
             # 有偵測到目標
             self.last_detection_time = current_time
+            # 新鎖定的目標：預測器從頭開始
+            relock = not self.tracking_active or self.locked_target_position is None
 
             # 解析檢測結果
             x, y, w, h = best_detection['bbox']
@@ -306,17 +414,10 @@ class MosquitoTracker:
             # 更新鎖定目標位置（用於下一幀的目標鎖定）
             self.locked_target_position = (target_x, target_y)
 
-            # 計算角度增量
-            pan_delta, tilt_delta = self.calculate_target_angles(target_x, target_y)
-
-            # 只有在偏離中心較大時才移動
-            if abs(pan_delta) > 2 or abs(tilt_delta) > 2:
-                try:
-                    self.controller.move_by(pan_delta, tilt_delta)
-                    logger.debug(f"[{camera_side}] AI 追蹤移動: Pan={pan_delta}, Tilt={tilt_delta}, 信心度={confidence:.2f}")
-                except Exception as e:
-                    logger.error(f"雲台移動失敗: {e}")
-                    # 串口錯誤不中斷追蹤，繼續處理下一幀
+            # 瞄準：優先瞄準預測位置，無法預測（未啟用或讀不到雲台角度）時瞄準最後觀測位置
+            if not (self.enable_prediction and
+                    self._aim_with_prediction(target_x, target_y, frame_time, relock, camera_side)):
+                self._aim_at_observation(target_x, target_y, frame_time, camera_side, confidence)
 
             # 在影像上標註目標（標註在使用的攝像頭畫面上）
             cv2.rectangle(frame, (x, y), (x + w, y + h), (0, 0, 255), 2)
@@ -346,6 +447,7 @@ class MosquitoTracker:
                     threading.Thread(target=self._home_async, daemon=True).start()
                     self.tracking_active = False
                     self.locked_target_position = None  # 清除目標鎖定
+                    self.predictor = None
                 else:
                     # 未超時，保持追蹤狀態，等待目標重新出現
                     logger.debug(f"暫時失去目標 ({time_since_last_detection:.1f}s)，保持追蹤狀態...")
@@ -373,6 +475,7 @@ class MosquitoTracker:
                 try:
                     # 讀取雙目攝像頭影像
                     ret, left_frame, right_frame = self.camera.read()
+                    frame_time = time.time()
                     if not ret:
                         logger.warning("無法讀取雙目影像")
                         continue
@@ -417,7 +520,7 @@ class MosquitoTracker:
                             # AI 追蹤蚊子（自動選擇信心度最高的攝像頭）
                             try:
                                 display_frame = self.track_mosquito(left_detections, right_detections,
-                                                                    left_frame, right_frame)
+                                                                    left_frame, right_frame, frame_time)
                             except Exception as e:
                                 logger.error(f"追蹤邏輯失敗: {e}")
                                 display_frame = left_frame
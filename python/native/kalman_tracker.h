@@ -0,0 +1,182 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file kalman_tracker.h
+ * @brief 影像目標運動預測：每軸獨立的等速（CV）/ 等加速度（CA）卡爾曼濾波器
+ * @details 狀態 x = [位置, 速度, 加速度]（CV 只用前兩項），量測為像素位置。
+ *          影像量測的 x / y 互不相關，兩軸各自一個 2×2 或 3×3 濾波器，
+ *          比 6×6 聯合濾波少一個數量級的運算，結果相同。
+ *
+ *          過程雜訊為連續白雜訊離散化：CV 對加速度、CA 對加加速度（jerk），
+ *          強度 q 的單位分別為 px²/s³ 與 px²/s⁵。時間以秒為單位，量測間隔可不固定
+ *          （偵測幀率會隨負載變動），predict() 依實際 dt 推進。
+ *
+ *          與 python/target_predictor.py 的純 Python 版本逐式對應，兩者結果應一致。
+ */
+
+#ifndef KALMAN_TRACKER_H
+#define KALMAN_TRACKER_H
+
+// 初始化時速度 / 加速度的標準差：目標剛出現時運動未知，給足夠大的不確定度
+static const double KF_INIT_VEL_STD = 1000.0;   // px/s
+static const double KF_INIT_ACC_STD = 5000.0;   // px/s²
+
+// 單軸濾波器：n = 2（CV）或 3（CA）
+class KalmanAxis {
+ public:
+  void reset(int n, double pos, double r2) {
+    n_ = n;
+    for (int i = 0; i < 3; i++) {
+      x_[i] = 0.0;
+      for (int j = 0; j < 3; j++) P_[i][j] = 0.0;
+    }
+    x_[0] = pos;
+    P_[0][0] = r2;
+    P_[1][1] = KF_INIT_VEL_STD * KF_INIT_VEL_STD;
+    if (n_ == 3) P_[2][2] = KF_INIT_ACC_STD * KF_INIT_ACC_STD;
+  }
+
+  // 時間更新：x = F x，P = F P Fᵀ + Q
+  void predict(double dt, double q) {
+    if (dt <= 0.0) return;
+    double F[3][3] = { { 1.0, dt, 0.5 * dt * dt }, { 0.0, 1.0, dt }, { 0.0, 0.0, 1.0 } };
+    double Q[3][3];
+    processNoise(dt, q, Q);
+
+    double x[3] = { 0.0, 0.0, 0.0 };
+    for (int i = 0; i < n_; i++) {
+      for (int k = 0; k < n_; k++) x[i] += F[i][k] * x_[k];
+    }
+    double FP[3][3];
+    for (int i = 0; i < n_; i++) {
+      for (int j = 0; j < n_; j++) {
+        FP[i][j] = 0.0;
+        for (int k = 0; k < n_; k++) FP[i][j] += F[i][k] * P_[k][j];
+      }
+    }
+    for (int i = 0; i < n_; i++) {
+      x_[i] = x[i];
+      for (int j = 0; j < n_; j++) {
+        double s = Q[i][j];
+        for (int k = 0; k < n_; k++) s += FP[i][k] * F[j][k];
+        P_[i][j] = s;
+      }
+    }
+  }
+
+  // 量測更新（H = [1 0 0]），返回標準化新息平方 y² / S（供關聯閘門使用）
+  double update(double z, double r2) {
+    double y = z - x_[0];
+    double S = P_[0][0] + r2;
+    double K[3];
+    for (int i = 0; i < n_; i++) K[i] = P_[i][0] / S;
+    for (int i = 0; i < n_; i++) x_[i] += K[i] * y;
+    // P = (I - K H) P；P0j 先取出，避免就地更新時被覆寫
+    double P0[3] = { P_[0][0], P_[0][1], P_[0][2] };
+    for (int i = 0; i < n_; i++) {
+      for (int j = 0; j < n_; j++) P_[i][j] -= K[i] * P0[j];
+    }
+    for (int i = 0; i < n_; i++) {
+      for (int j = 0; j < i; j++) P_[i][j] = P_[j][i] = 0.5 * (P_[i][j] + P_[j][i]);
+    }
+    return y * y / S;
+  }
+
+  // 不改變狀態的外推：p + v·dt（+ a·dt²/2）
+  double extrapolate(double dt) const {
+    return x_[0] + x_[1] * dt + (n_ == 3 ? 0.5 * x_[2] * dt * dt : 0.0);
+  }
+
+  double pos() const { return x_[0]; }
+  double vel() const { return x_[1]; }
+  double acc() const { return n_ == 3 ? x_[2] : 0.0; }
+  double var() const { return P_[0][0]; }
+
+ private:
+  // 連續白雜訊離散化：CV 驅動加速度，CA 驅動加加速度
+  void processNoise(double dt, double q, double Q[3][3]) const {
+    double dt2 = dt * dt, dt3 = dt2 * dt, dt4 = dt3 * dt, dt5 = dt4 * dt;
+    if (n_ == 2) {
+      Q[0][0] = q * dt3 / 3.0;  Q[0][1] = q * dt2 / 2.0;
+      Q[1][0] = Q[0][1];        Q[1][1] = q * dt;
+      return;
+    }
+    Q[0][0] = q * dt5 / 20.0;  Q[0][1] = q * dt4 / 8.0;  Q[0][2] = q * dt3 / 6.0;
+    Q[1][0] = Q[0][1];         Q[1][1] = q * dt3 / 3.0;  Q[1][2] = q * dt2 / 2.0;
+    Q[2][0] = Q[0][2];         Q[2][1] = Q[1][2];        Q[2][2] = q * dt;
+  }
+
+  int n_;
+  double x_[3];
+  double P_[3][3];
+};
+
+// 影像平面目標追蹤器：兩軸濾波器 + 最近量測時間
+class KalmanTracker2D {
+ public:
+  // order = 2（CV）或 3（CA）；q 為過程雜訊強度，r 為量測標準差（px）
+  KalmanTracker2D(int order, double q, double r)
+      : order_(order == 2 ? 2 : 3), q_(q), r2_(r * r), t_(0.0), initialized_(false) {}
+
+  void reset(double x, double y, double t) {
+    ax_[0].reset(order_, x, r2_);
+    ax_[1].reset(order_, y, r2_);
+    t_ = t;
+    initialized_ = true;
+  }
+
+  // 推進到時間 t 並融合量測 (x, y)；首筆量測即初始化。返回兩軸標準化新息平方和
+  double update(double x, double y, double t) {
+    if (!initialized_) {
+      reset(x, y, t);
+      return 0.0;
+    }
+    advance(t);
+    return ax_[0].update(x, r2_) + ax_[1].update(y, r2_);
+  }
+
+  // 推進到時間 t（無量測，例如偵測漏幀）
+  void advance(double t) {
+    double dt = t - t_;
+    if (dt <= 0.0) return;
+    ax_[0].predict(dt, q_);
+    ax_[1].predict(dt, q_);
+    t_ = t;
+  }
+
+  // 時間 t 的預測位置（不改變狀態）；t 早於最近量測時返回目前估計
+  void predictAt(double t, double& x, double& y) const {
+    double dt = t > t_ ? t - t_ : 0.0;
+    x = ax_[0].extrapolate(dt);
+    y = ax_[1].extrapolate(dt);
+  }
+
+  const KalmanAxis& axis(int i) const { return ax_[i]; }
+  int order() const { return order_; }
+  double time() const { return t_; }
+  bool initialized() const { return initialized_; }
+
+ private:
+  int order_;
+  double q_;
+  double r2_;
+  double t_;
+  bool initialized_;
+  KalmanAxis ax_[2];
+};
+
+#endif // KALMAN_TRACKER_H
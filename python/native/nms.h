@@ -0,0 +1,268 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file nms.h
+ * @brief 非極大值抑制：均勻網格剪枝 + SoA 框以 simd4.h 一次計算 4 個 IoU
+ * @details 平鋪偵測把所有視窗的框合在一起做 NMS，重疊區域越大、蚊子越多，框數越多；
+ *          兩兩比較是 O(n²)。這裡把框依信心度排序後放進均勻網格（格寬約為框尺寸的兩倍），
+ *          每個框只和同格的框比較，格內以 structure-of-arrays 存放，4 個一組計算 IoU。
+ *
+ *          跨越多格的框會出現在每一格；一對框只在「交集左上角所在的格」處理一次，
+ *          soft-NMS 的分數衰減因此不會重複套用。
+ *
+ *          方法：
+ *            NMS_HARD          IoU > 閾值即移除（原本 _nms 的行為）
+ *            NMS_SOFT_LINEAR   IoU > 閾值時分數 × (1 - IoU)
+ *            NMS_SOFT_GAUSSIAN 分數 × exp(-IoU² / sigma)
+ *          soft-NMS 每輪選目前分數最高者；分數低於 scoreThreshold 的框移除。
+ *          classAware 時只抑制相同類別的框。
+ *
+ *          結果與 python/yolo_postprocess.py 的 numpy 版本一致。
+ */
+
+#ifndef NMS_H
+#define NMS_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "simd4.h"
+
+enum NmsMethod {
+  NMS_HARD = 0,
+  NMS_SOFT_LINEAR = 1,
+  NMS_SOFT_GAUSSIAN = 2,
+};
+
+struct NmsParams {
+  float iouThreshold;
+  int method;
+  float sigma;            // 僅 NMS_SOFT_GAUSSIAN
+  float scoreThreshold;   // 分數低於此值的框移除（含初始分數）
+  bool classAware;
+};
+
+// 框數少於此值時不分格（單一格子即為 SIMD 暴力比較）
+static const size_t NMS_GRID_MIN_BOXES = 32;
+// 每軸最多格數，避免極小的框把網格切得過細
+static const int NMS_GRID_MAX_CELLS = 64;
+
+class NmsEngine {
+ public:
+  /**
+   * boxes：n × 4（x1, y1, x2, y2）；scores：n；classes：n 或 NULL（classAware 時必須提供）
+   * keep 依選取順序寫入原始索引，keptScores 為對應的（soft-NMS 衰減後）分數
+   */
+  void run(const float* boxes, const float* scores, const int32_t* classes, size_t n,
+           const NmsParams& p, std::vector<int32_t>& keep, std::vector<float>& keptScores) {
+    keep.clear();
+    keptScores.clear();
+    if (n == 0) return;
+    sortByScore(boxes, scores, classes, n);
+    buildGrid(n);
+
+    state_.assign(n, ACTIVE);
+    for (size_t r = 0; r < n; r++) {
+      if (!(score_[r] >= p.scoreThreshold)) state_[r] = DROPPED;
+    }
+
+    size_t next = 0;
+    for (;;) {
+      size_t i = p.method == NMS_HARD ? nextActive(next) : bestActive();
+      if (i == n) break;
+      state_[i] = KEPT;
+      keep.push_back(order_[i]);
+      keptScores.push_back(score_[i]);
+      suppressAround(i, p, classes != NULL && p.classAware);
+    }
+  }
+
+ private:
+  enum { ACTIVE = 0, KEPT = 1, DROPPED = 2 };
+
+  // 依分數由高到低穩定排序（同分保持原順序，與 Python sort 相同），轉為 SoA
+  void sortByScore(const float* boxes, const float* scores, const int32_t* classes, size_t n) {
+    order_.resize(n);
+    for (size_t i = 0; i < n; i++) order_[i] = (int32_t)i;
+    std::stable_sort(order_.begin(), order_.end(),
+                     [scores](int32_t a, int32_t b) { return scores[a] > scores[b]; });
+    x1_.resize(n); y1_.resize(n); x2_.resize(n); y2_.resize(n);
+    area_.resize(n); score_.resize(n); cls_.resize(n);
+    for (size_t r = 0; r < n; r++) {
+      const float* b = boxes + 4 * (size_t)order_[r];
+      x1_[r] = b[0];
+      y1_[r] = b[1];
+      x2_[r] = b[2];
+      y2_[r] = b[3];
+      area_[r] = std::max(0.0f, b[2] - b[0]) * std::max(0.0f, b[3] - b[1]);
+      score_[r] = scores[order_[r]];
+      cls_[r] = classes != NULL ? classes[order_[r]] : 0;
+    }
+  }
+
+  int cellX(float x) const { return clampCell((int)floorf((x - gx0_) * invCell_), gw_); }
+  int cellY(float y) const { return clampCell((int)floorf((y - gy0_) * invCell_), gh_); }
+  static int clampCell(int c, int cells) { return c < 0 ? 0 : (c >= cells ? cells - 1 : c); }
+
+  // 網格：CSR 格式，每格的框依排名順序連續存放並補齊到 4 的倍數
+  void buildGrid(size_t n) {
+    float minX = x1_[0], minY = y1_[0], maxX = x2_[0], maxY = y2_[0];
+    double sizeSum = 0.0;
+    for (size_t r = 0; r < n; r++) {
+      minX = std::min(minX, x1_[r]);
+      minY = std::min(minY, y1_[r]);
+      maxX = std::max(maxX, x2_[r]);
+      maxY = std::max(maxY, y2_[r]);
+      sizeSum += std::max(x2_[r] - x1_[r], y2_[r] - y1_[r]);
+    }
+    float extent = std::max(std::max(maxX - minX, maxY - minY), 1.0f);
+    float cell = extent + 1.0f;
+    if (n >= NMS_GRID_MIN_BOXES) {
+      cell = std::max((float)(2.0 * sizeSum / (double)n), extent / (float)NMS_GRID_MAX_CELLS);
+      cell = std::max(cell, 1.0f);
+    }
+    gx0_ = minX;
+    gy0_ = minY;
+    invCell_ = 1.0f / cell;
+    gw_ = std::min(NMS_GRID_MAX_CELLS, (int)((maxX - minX) * invCell_) + 1);
+    gh_ = std::min(NMS_GRID_MAX_CELLS, (int)((maxY - minY) * invCell_) + 1);
+    if (gw_ < 1) gw_ = 1;
+    if (gh_ < 1) gh_ = 1;
+
+    size_t cells = (size_t)gw_ * (size_t)gh_;
+    cellStart_.assign(cells + 1, 0);
+    for (size_t r = 0; r < n; r++) {
+      forEachCell(r, [this](size_t c) { cellStart_[c + 1]++; });
+    }
+    for (size_t c = 0; c < cells; c++) cellStart_[c + 1] = cellStart_[c] + padded(cellStart_[c + 1]);
+
+    size_t total = cellStart_[cells];
+    // 補位用的空框：交集恆為 0，不會被選中
+    cx1_.assign(total, 1.0e30f); cy1_.assign(total, 1.0e30f);
+    cx2_.assign(total, -1.0e30f); cy2_.assign(total, -1.0e30f);
+    carea_.assign(total, 0.0f);
+    crank_.assign(total, -1);
+    fill_.assign(cellStart_.begin(), cellStart_.end() - 1);
+    for (size_t r = 0; r < n; r++) {
+      forEachCell(r, [this, r](size_t c) {
+        size_t k = fill_[c]++;
+        cx1_[k] = x1_[r];
+        cy1_[k] = y1_[r];
+        cx2_[k] = x2_[r];
+        cy2_[k] = y2_[r];
+        carea_[k] = area_[r];
+        crank_[k] = (int32_t)r;
+      });
+    }
+  }
+
+  static size_t padded(size_t count) { return (count + 3) & ~(size_t)3; }
+
+  template <typename F>
+  void forEachCell(size_t r, F f) const {
+    int cx0 = cellX(x1_[r]), cx1 = cellX(std::max(x1_[r], x2_[r]));
+    int cy0 = cellY(y1_[r]), cy1 = cellY(std::max(y1_[r], y2_[r]));
+    for (int cy = cy0; cy <= cy1; cy++) {
+      for (int cx = cx0; cx <= cx1; cx++) f((size_t)cy * (size_t)gw_ + (size_t)cx);
+    }
+  }
+
+  size_t nextActive(size_t& next) const {
+    while (next < state_.size() && state_[next] != ACTIVE) next++;
+    return next;
+  }
+
+  // soft-NMS：分數會衰減，每輪重新找最高分（同分取排名靠前者）
+  size_t bestActive() const {
+    size_t best = state_.size();
+    for (size_t r = 0; r < state_.size(); r++) {
+      if (state_[r] == ACTIVE && (best == state_.size() || score_[r] > score_[best])) best = r;
+    }
+    return best;
+  }
+
+  // 以剛選中的框 i 抑制（或衰減）同格中重疊的其他框
+  void suppressAround(size_t i, const NmsParams& p, bool classAware) {
+    f32x4 ix1 = f32x4_set1(x1_[i]), iy1 = f32x4_set1(y1_[i]);
+    f32x4 ix2 = f32x4_set1(x2_[i]), iy2 = f32x4_set1(y2_[i]);
+    f32x4 iarea = f32x4_set1(area_[i]);
+    f32x4 zero = f32x4_set1(0.0f);
+    // 硬 NMS 與線性 soft-NMS 只處理 IoU > 閾值（inter > thr × union，省去除法）；高斯處理所有交集
+    f32x4 thr = f32x4_set1(p.method == NMS_SOFT_GAUSSIAN ? 0.0f : p.iouThreshold);
+    float inter[4], uni[4];
+
+    forEachCell(i, [&](size_t c) {
+      for (size_t k = cellStart_[c]; k < cellStart_[c + 1]; k += 4) {
+        f32x4 w = f32x4_max(zero, f32x4_sub(f32x4_min(ix2, f32x4_load(&cx2_[k])), f32x4_max(ix1, f32x4_load(&cx1_[k]))));
+        f32x4 h = f32x4_max(zero, f32x4_sub(f32x4_min(iy2, f32x4_load(&cy2_[k])), f32x4_max(iy1, f32x4_load(&cy1_[k]))));
+        f32x4 in = f32x4_mul(w, h);
+        f32x4 un = f32x4_sub(f32x4_add(iarea, f32x4_load(&carea_[k])), in);
+        int mask = f32x4_gt_mask(in, f32x4_mul(thr, un)) & f32x4_gt_mask(in, zero);
+        if (mask == 0) continue;
+        f32x4_store(inter, in);
+        f32x4_store(uni, un);
+        for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+          if (!(mask & 1)) continue;
+          int32_t j = crank_[k + lane];
+          if (state_[j] != ACTIVE) continue;
+          if (classAware && cls_[j] != cls_[i]) continue;
+          if (!ownsPair(c, i, j)) continue;
+          apply(j, inter[lane] / uni[lane], p);
+        }
+      }
+    });
+  }
+
+  // 一對框只在交集左上角所在的格處理
+  bool ownsPair(size_t c, size_t i, size_t j) const {
+    int cx = cellX(std::max(x1_[i], x1_[j]));
+    int cy = cellY(std::max(y1_[i], y1_[j]));
+    return (size_t)cy * (size_t)gw_ + (size_t)cx == c;
+  }
+
+  void apply(int32_t j, float iou, const NmsParams& p) {
+    if (p.method == NMS_HARD) {
+      state_[j] = DROPPED;
+      return;
+    }
+    if (p.method == NMS_SOFT_LINEAR) {
+      score_[j] *= 1.0f - iou;
+    } else {
+      score_[j] *= expf(-(iou * iou) / p.sigma);
+    }
+    if (!(score_[j] >= p.scoreThreshold)) state_[j] = DROPPED;
+  }
+
+  // 依排名的 SoA
+  std::vector<int32_t> order_;
+  std::vector<float> x1_, y1_, x2_, y2_, area_, score_;
+  std::vector<int32_t> cls_;
+  std::vector<uint8_t> state_;
+
+  // 網格
+  float gx0_, gy0_, invCell_;
+  int gw_, gh_;
+  std::vector<size_t> cellStart_, fill_;
+  std::vector<float> cx1_, cy1_, cx2_, cy2_, carea_;
+  std::vector<int32_t> crank_;
+};
+
+#endif // NMS_H
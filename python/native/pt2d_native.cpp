@@ -0,0 +1,329 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file pt2d_native.cpp
+ * @brief 上位機熱點路徑的 C++ 實作，以 CPython C API 匯出為 pt2d_native 模組
+ * @details 不依賴 pybind11，只需 Python 標頭即可編譯（python setup_native.py build_ext --inplace）。
+ *          各功能的核心放在同目錄的標頭檔中，本檔只負責參數轉換與物件生命週期：
+ *
+ *            KalmanTracker  → kalman_tracker.h
+ *            decode_yolo    → yolo_decoder.h（SIMD：simd4.h）
+ *            nms            → nms.h（SIMD：simd4.h）
+ */
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <new>
+#include <vector>
+
+#include "kalman_tracker.h"
+#include "nms.h"
+#include "yolo_decoder.h"
+
+// ============================================
+// KalmanTracker
+// ============================================
+
+struct KalmanTrackerObject {
+  PyObject_HEAD
+  KalmanTracker2D* kf;
+};
+
+static void KalmanTracker_dealloc(KalmanTrackerObject* self) {
+  delete self->kf;
+  Py_TYPE(self)->tp_free((PyObject*)self);
+}
+
+static PyObject* KalmanTracker_new(PyTypeObject* type, PyObject* args, PyObject* kwds) {
+  static const char* kwlist[] = { "order", "process_noise", "measurement_noise", NULL };
+  int order = 2;
+  double q = 1.0e6;
+  double r = 4.0;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "|idd", (char**)kwlist, &order, &q, &r)) return NULL;
+  if (order != 2 && order != 3) {
+    PyErr_SetString(PyExc_ValueError, "order must be 2 (constant velocity) or 3 (constant acceleration)");
+    return NULL;
+  }
+  if (q < 0.0 || r <= 0.0) {
+    PyErr_SetString(PyExc_ValueError, "process_noise must be >= 0 and measurement_noise > 0");
+    return NULL;
+  }
+
+  KalmanTrackerObject* self = (KalmanTrackerObject*)type->tp_alloc(type, 0);
+  if (self == NULL) return NULL;
+  self->kf = new (std::nothrow) KalmanTracker2D(order, q, r);
+  if (self->kf == NULL) {
+    Py_DECREF(self);
+    return PyErr_NoMemory();
+  }
+  return (PyObject*)self;
+}
+
+static PyObject* KalmanTracker_reset(KalmanTrackerObject* self, PyObject* args) {
+  double x, y, t;
+  if (!PyArg_ParseTuple(args, "ddd", &x, &y, &t)) return NULL;
+  self->kf->reset(x, y, t);
+  Py_RETURN_NONE;
+}
+
+static PyObject* KalmanTracker_update(KalmanTrackerObject* self, PyObject* args) {
+  double x, y, t;
+  if (!PyArg_ParseTuple(args, "ddd", &x, &y, &t)) return NULL;
+  return PyFloat_FromDouble(self->kf->update(x, y, t));
+}
+
+static PyObject* KalmanTracker_advance(KalmanTrackerObject* self, PyObject* args) {
+  double t;
+  if (!PyArg_ParseTuple(args, "d", &t)) return NULL;
+  self->kf->advance(t);
+  Py_RETURN_NONE;
+}
+
+static PyObject* KalmanTracker_predict(KalmanTrackerObject* self, PyObject* args) {
+  double t, x, y;
+  if (!PyArg_ParseTuple(args, "d", &t)) return NULL;
+  if (!self->kf->initialized()) {
+    PyErr_SetString(PyExc_RuntimeError, "KalmanTracker has no measurement yet");
+    return NULL;
+  }
+  self->kf->predictAt(t, x, y);
+  return Py_BuildValue("(dd)", x, y);
+}
+
+static PyObject* KalmanTracker_get_position(KalmanTrackerObject* self, void*) {
+  return Py_BuildValue("(dd)", self->kf->axis(0).pos(), self->kf->axis(1).pos());
+}
+
+static PyObject* KalmanTracker_get_velocity(KalmanTrackerObject* self, void*) {
+  return Py_BuildValue("(dd)", self->kf->axis(0).vel(), self->kf->axis(1).vel());
+}
+
+static PyObject* KalmanTracker_get_acceleration(KalmanTrackerObject* self, void*) {
+  return Py_BuildValue("(dd)", self->kf->axis(0).acc(), self->kf->axis(1).acc());
+}
+
+static PyObject* KalmanTracker_get_variance(KalmanTrackerObject* self, void*) {
+  return Py_BuildValue("(dd)", self->kf->axis(0).var(), self->kf->axis(1).var());
+}
+
+static PyObject* KalmanTracker_get_time(KalmanTrackerObject* self, void*) {
+  return PyFloat_FromDouble(self->kf->time());
+}
+
+static PyObject* KalmanTracker_get_order(KalmanTrackerObject* self, void*) {
+  return PyLong_FromLong(self->kf->order());
+}
+
+static PyObject* KalmanTracker_get_initialized(KalmanTrackerObject* self, void*) {
+  return PyBool_FromLong(self->kf->initialized());
+}
+
+static PyMethodDef KalmanTracker_methods[] = {
+  { "reset", (PyCFunction)KalmanTracker_reset, METH_VARARGS,
+    "reset(x, y, t): restart the filter at position (x, y), time t (seconds)" },
+  { "update", (PyCFunction)KalmanTracker_update, METH_VARARGS,
+    "update(x, y, t) -> nis: advance to t and fuse the measurement; returns normalized innovation squared" },
+  { "advance", (PyCFunction)KalmanTracker_advance, METH_VARARGS,
+    "advance(t): propagate to time t without a measurement" },
+  { "predict", (PyCFunction)KalmanTracker_predict, METH_VARARGS,
+    "predict(t) -> (x, y): extrapolated position at time t, state unchanged" },
+  { NULL, NULL, 0, NULL },
+};
+
+static PyGetSetDef KalmanTracker_getset[] = {
+  { (char*)"position", (getter)KalmanTracker_get_position, NULL, (char*)"(x, y) px", NULL },
+  { (char*)"velocity", (getter)KalmanTracker_get_velocity, NULL, (char*)"(vx, vy) px/s", NULL },
+  { (char*)"acceleration", (getter)KalmanTracker_get_acceleration, NULL, (char*)"(ax, ay) px/s^2", NULL },
+  { (char*)"variance", (getter)KalmanTracker_get_variance, NULL, (char*)"position variance (px^2)", NULL },
+  { (char*)"time", (getter)KalmanTracker_get_time, NULL, (char*)"time of the last update", NULL },
+  { (char*)"order", (getter)KalmanTracker_get_order, NULL, (char*)"2 = CV, 3 = CA", NULL },
+  { (char*)"initialized", (getter)KalmanTracker_get_initialized, NULL, (char*)"has a measurement", NULL },
+  { NULL, NULL, NULL, NULL, NULL },
+};
+
+static PyTypeObject KalmanTrackerType = {
+  PyVarObject_HEAD_INIT(NULL, 0)
+  "pt2d_native.KalmanTracker",              // tp_name
+  sizeof(KalmanTrackerObject),              // tp_basicsize
+};
+
+// ============================================
+// 緩衝區
+// ============================================
+
+/**
+ * 取得 C 連續、指定型別（'f' = float32，'i' = int32）與維度的緩衝區；失敗時設定 ValueError
+ * 成功後呼叫端負責 PyBuffer_Release
+ */
+static bool getTypedBuffer(PyObject* obj, Py_buffer* view, char type, int ndim, const char* what) {
+  if (PyObject_GetBuffer(obj, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) < 0) return false;
+  const char* fmt = view->format != NULL ? view->format : "B";
+  if (fmt[0] == '<' || fmt[0] == '=' || fmt[0] == '@') fmt++;
+  bool typeOk = view->itemsize == 4 && fmt[1] == '\0' &&
+                (fmt[0] == type || (type == 'i' && fmt[0] == 'l'));
+  if (view->ndim != ndim || !typeOk) {
+    PyBuffer_Release(view);
+    PyErr_Format(PyExc_ValueError, "%s must be a C-contiguous %d-D %s array", what, ndim,
+                 type == 'f' ? "float32" : "int32");
+    return false;
+  }
+  return true;
+}
+
+template <typename T>
+static PyObject* bytesFromVector(const std::vector<T>& v) {
+  return PyBytes_FromStringAndSize(v.empty() ? "" : (const char*)&v[0], (Py_ssize_t)(v.size() * sizeof(T)));
+}
+
+// ============================================
+// decode_yolo
+// ============================================
+
+static PyObject* pt2d_decode_yolo(PyObject*, PyObject* args, PyObject* kwds) {
+  static const char* kwlist[] = { "output", "conf_threshold", "feature_major", NULL };
+  PyObject* obj;
+  float conf;
+  int featureMajor;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "Ofp", (char**)kwlist, &obj, &conf, &featureMajor)) return NULL;
+
+  Py_buffer view;
+  if (!getTypedBuffer(obj, &view, 'f', 2, "output")) return NULL;
+  size_t anchors = (size_t)(featureMajor ? view.shape[1] : view.shape[0]);
+  size_t features = (size_t)(featureMajor ? view.shape[0] : view.shape[1]);
+  if (features <= YOLO_CLASS_OFFSET) {
+    PyBuffer_Release(&view);
+    PyErr_SetString(PyExc_ValueError, "output needs at least 6 features (box, objectness, classes)");
+    return NULL;
+  }
+
+  std::vector<YoloDet> dets;
+  Py_BEGIN_ALLOW_THREADS
+  YoloDecoder((const float*)view.buf, anchors, features, featureMajor != 0).decode(conf, dets);
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release(&view);
+  return bytesFromVector(dets);
+}
+
+// ============================================
+// nms
+// ============================================
+
+static PyObject* pt2d_nms(PyObject*, PyObject* args, PyObject* kwds) {
+  static const char* kwlist[] = { "boxes", "scores", "iou_threshold", "classes", "method", "sigma",
+                                  "score_threshold", NULL };
+  PyObject* boxesObj;
+  PyObject* scoresObj;
+  PyObject* classesObj = Py_None;
+  NmsParams p;
+  p.method = NMS_HARD;
+  p.sigma = 0.5f;
+  p.scoreThreshold = 0.0f;
+  if (!PyArg_ParseTupleAndKeywords(args, kwds, "OOf|Oiff", (char**)kwlist, &boxesObj, &scoresObj,
+                                   &p.iouThreshold, &classesObj, &p.method, &p.sigma, &p.scoreThreshold)) {
+    return NULL;
+  }
+  if (p.method < NMS_HARD || p.method > NMS_SOFT_GAUSSIAN) {
+    PyErr_SetString(PyExc_ValueError, "method must be 0 (hard), 1 (soft linear) or 2 (soft gaussian)");
+    return NULL;
+  }
+  if (p.method == NMS_SOFT_GAUSSIAN && !(p.sigma > 0.0f)) {
+    PyErr_SetString(PyExc_ValueError, "sigma must be > 0");
+    return NULL;
+  }
+  p.classAware = classesObj != Py_None;
+
+  Py_buffer boxes, scores, classes;
+  if (!getTypedBuffer(boxesObj, &boxes, 'f', 2, "boxes")) return NULL;
+  if (!getTypedBuffer(scoresObj, &scores, 'f', 1, "scores")) {
+    PyBuffer_Release(&boxes);
+    return NULL;
+  }
+  if (p.classAware && !getTypedBuffer(classesObj, &classes, 'i', 1, "classes")) {
+    PyBuffer_Release(&boxes);
+    PyBuffer_Release(&scores);
+    return NULL;
+  }
+  Py_ssize_t n = scores.shape[0];
+  bool shapeOk = boxes.shape[0] == n && boxes.shape[1] == 4 && (!p.classAware || classes.shape[0] == n);
+
+  std::vector<int32_t> keep;
+  std::vector<float> keptScores;
+  if (shapeOk) {
+    Py_BEGIN_ALLOW_THREADS
+    NmsEngine().run((const float*)boxes.buf, (const float*)scores.buf,
+                    p.classAware ? (const int32_t*)classes.buf : NULL, (size_t)n, p, keep, keptScores);
+    Py_END_ALLOW_THREADS
+  }
+  PyBuffer_Release(&boxes);
+  PyBuffer_Release(&scores);
+  if (p.classAware) PyBuffer_Release(&classes);
+  if (!shapeOk) {
+    PyErr_SetString(PyExc_ValueError, "boxes must be (n, 4) and scores / classes (n,)");
+    return NULL;
+  }
+  return Py_BuildValue("(NN)", bytesFromVector(keep), bytesFromVector(keptScores));
+}
+
+// ============================================
+// 模組
+// ============================================
+
+static PyMethodDef pt2d_native_methods[] = {
+  { "decode_yolo", (PyCFunction)(void (*)(void))pt2d_decode_yolo, METH_VARARGS | METH_KEYWORDS,
+    "decode_yolo(output, conf_threshold, feature_major) -> bytes: packed YoloDet records "
+    "(cx, cy, w, h, confidence: float32; class_id, anchor: int32) for a 2-D float32 YOLO head, "
+    "[features, anchors] if feature_major else [anchors, features]" },
+  { "nms", (PyCFunction)(void (*)(void))pt2d_nms, METH_VARARGS | METH_KEYWORDS,
+    "nms(boxes, scores, iou_threshold, classes=None, method=0, sigma=0.5, score_threshold=0.0) "
+    "-> (keep, scores): float32 (n, 4) x1/y1/x2/y2 boxes, float32 scores, optional int32 classes "
+    "(class-aware when given); method 0 = hard, 1 = soft linear, 2 = soft gaussian. Returns packed "
+    "int32 indices in selection order and their float32 (decayed) scores" },
+  { NULL, NULL, 0, NULL },
+};
+
+static PyModuleDef pt2d_native_module = {
+  PyModuleDef_HEAD_INIT,
+  "pt2d_native",
+  "Native hot paths for the PT2D host (motion prediction, YOLO decoding, NMS)",
+  -1,
+  pt2d_native_methods,
+};
+
+PyMODINIT_FUNC PyInit_pt2d_native(void) {
+  KalmanTrackerType.tp_dealloc = (destructor)KalmanTracker_dealloc;
+  KalmanTrackerType.tp_flags = Py_TPFLAGS_DEFAULT;
+  KalmanTrackerType.tp_doc = "KalmanTracker(order=2, process_noise=1e6, measurement_noise=4.0)";
+  KalmanTrackerType.tp_methods = KalmanTracker_methods;
+  KalmanTrackerType.tp_getset = KalmanTracker_getset;
+  KalmanTrackerType.tp_new = KalmanTracker_new;
+  if (PyType_Ready(&KalmanTrackerType) < 0) return NULL;
+
+  PyObject* m = PyModule_Create(&pt2d_native_module);
+  if (m == NULL) return NULL;
+  Py_INCREF(&KalmanTrackerType);
+  if (PyModule_AddObject(m, "KalmanTracker", (PyObject*)&KalmanTrackerType) < 0) {
+    Py_DECREF(&KalmanTrackerType);
+    Py_DECREF(m);
+    return NULL;
+  }
+  if (PyModule_AddStringConstant(m, "SIMD", simd4_backend()) < 0) {
+    Py_DECREF(m);
+    return NULL;
+  }
+  return m;
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file simd4.h
+ * @brief 4 路 float 的最小可攜 SIMD 層：x86 用 SSE2、ARM64（RK3588 / RDK X5）用 NEON，其餘純 C
+ * @details 只包含後處理實際用到的運算（載入、廣播、加減乘、min/max、比較遮罩）。
+ *          只用 IEEE 基本運算、沒有近似指令，非 NaN 輸入時三種實作結果逐位元相同，
+ *          呼叫端不需要為各平台分別驗證。
+ */
+
+#ifndef SIMD4_H
+#define SIMD4_H
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SIMD4_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define SIMD4_NEON 1
+#endif
+
+#if defined(SIMD4_SSE2)
+
+typedef __m128 f32x4;
+
+static inline f32x4 f32x4_load(const float* p) { return _mm_loadu_ps(p); }
+static inline void f32x4_store(float* p, f32x4 v) { _mm_storeu_ps(p, v); }
+static inline f32x4 f32x4_set1(float v) { return _mm_set1_ps(v); }
+static inline f32x4 f32x4_add(f32x4 a, f32x4 b) { return _mm_add_ps(a, b); }
+static inline f32x4 f32x4_sub(f32x4 a, f32x4 b) { return _mm_sub_ps(a, b); }
+static inline f32x4 f32x4_mul(f32x4 a, f32x4 b) { return _mm_mul_ps(a, b); }
+static inline f32x4 f32x4_min(f32x4 a, f32x4 b) { return _mm_min_ps(a, b); }
+static inline f32x4 f32x4_max(f32x4 a, f32x4 b) { return _mm_max_ps(a, b); }
+// a >= b 的 lane 遮罩，bit i 對應 lane i（NaN 視為不成立）
+static inline int f32x4_ge_mask(f32x4 a, f32x4 b) { return _mm_movemask_ps(_mm_cmpge_ps(a, b)); }
+static inline int f32x4_gt_mask(f32x4 a, f32x4 b) { return _mm_movemask_ps(_mm_cmpgt_ps(a, b)); }
+
+#elif defined(SIMD4_NEON)
+
+typedef float32x4_t f32x4;
+
+static inline f32x4 f32x4_load(const float* p) { return vld1q_f32(p); }
+static inline void f32x4_store(float* p, f32x4 v) { vst1q_f32(p, v); }
+static inline f32x4 f32x4_set1(float v) { return vdupq_n_f32(v); }
+static inline f32x4 f32x4_add(f32x4 a, f32x4 b) { return vaddq_f32(a, b); }
+static inline f32x4 f32x4_sub(f32x4 a, f32x4 b) { return vsubq_f32(a, b); }
+static inline f32x4 f32x4_mul(f32x4 a, f32x4 b) { return vmulq_f32(a, b); }
+static inline f32x4 f32x4_min(f32x4 a, f32x4 b) { return vminq_f32(a, b); }
+static inline f32x4 f32x4_max(f32x4 a, f32x4 b) { return vmaxq_f32(a, b); }
+static inline int simd4_lane_bits(uint32x4_t m) {
+  static const uint32_t kBits[4] = { 1, 2, 4, 8 };
+  return (int)vaddvq_u32(vandq_u32(m, vld1q_u32(kBits)));
+}
+static inline int f32x4_ge_mask(f32x4 a, f32x4 b) { return simd4_lane_bits(vcgeq_f32(a, b)); }
+static inline int f32x4_gt_mask(f32x4 a, f32x4 b) { return simd4_lane_bits(vcgtq_f32(a, b)); }
+
+#else
+
+struct f32x4 {
+  float v[4];
+};
+
+static inline f32x4 f32x4_load(const float* p) {
+  f32x4 r;
+  for (int i = 0; i < 4; i++) r.v[i] = p[i];
+  return r;
+}
+static inline void f32x4_store(float* p, f32x4 a) {
+  for (int i = 0; i < 4; i++) p[i] = a.v[i];
+}
+static inline f32x4 f32x4_set1(float s) {
+  f32x4 r;
+  for (int i = 0; i < 4; i++) r.v[i] = s;
+  return r;
+}
+#define SIMD4_SCALAR_OP(name, expr)                  \
+  static inline f32x4 name(f32x4 a, f32x4 b) {       \
+    f32x4 r;                                         \
+    for (int i = 0; i < 4; i++) r.v[i] = (expr);     \
+    return r;                                        \
+  }
+SIMD4_SCALAR_OP(f32x4_add, a.v[i] + b.v[i])
+SIMD4_SCALAR_OP(f32x4_sub, a.v[i] - b.v[i])
+SIMD4_SCALAR_OP(f32x4_mul, a.v[i] * b.v[i])
+SIMD4_SCALAR_OP(f32x4_min, a.v[i] < b.v[i] ? a.v[i] : b.v[i])
+SIMD4_SCALAR_OP(f32x4_max, a.v[i] > b.v[i] ? a.v[i] : b.v[i])
+#undef SIMD4_SCALAR_OP
+static inline int f32x4_ge_mask(f32x4 a, f32x4 b) {
+  int m = 0;
+  for (int i = 0; i < 4; i++) m |= (a.v[i] >= b.v[i]) << i;
+  return m;
+}
+static inline int f32x4_gt_mask(f32x4 a, f32x4 b) {
+  int m = 0;
+  for (int i = 0; i < 4; i++) m |= (a.v[i] > b.v[i]) << i;
+  return m;
+}
+
+#endif
+
+// 編譯時選用的實作名稱（供 Python 端記錄）
+static inline const char* simd4_backend() {
+#if defined(SIMD4_SSE2)
+  return "sse2";
+#elif defined(SIMD4_NEON)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+#endif // SIMD4_H
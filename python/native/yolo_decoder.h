@@ -0,0 +1,144 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file yolo_decoder.h
+ * @brief YOLO 輸出解碼：先以 logit 閾值篩選，再對少數候選計算 sigmoid 與類別
+ * @details 每個 anchor 的特徵為 [cx, cy, w, h, objectness, class_0 .. class_{F-6}]（框座標為像素，objectness 與類別分數為 logit）。
+ *          sigmoid 單調遞增，objectness ≥ conf 等價於 logit ≥ ln(conf / (1 - conf))，
+ *          所以 8400 個 anchor 只需比較一次原始值；通過的候選（通常個位數）才計算 sigmoid 與類別 argmax。
+ *
+ *          兩種記憶體布局都直接讀取，不轉置：
+ *            特徵優先 [F][N]：objectness 一列連續，以 simd4.h 一次比較 4 個
+ *            anchor 優先 [N][F]：objectness 間隔 F，逐一比較（每筆一次載入，已非瓶頸）
+ *
+ *          結果與 python/yolo_postprocess.py 的 numpy 版本一致。
+ */
+
+#ifndef YOLO_DECODER_H
+#define YOLO_DECODER_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "simd4.h"
+
+// 解碼結果（28 bytes，欄位與 Python 端 YOLO_DET_DTYPE 相同）；座標為模型輸入影像的像素
+struct YoloDet {
+  float cx;
+  float cy;
+  float w;
+  float h;
+  float confidence;
+  int32_t classId;
+  int32_t anchor;
+};
+
+// 第一個類別分數所在的特徵索引（前面為 4 個框座標與 objectness）
+static const size_t YOLO_CLASS_OFFSET = 5;
+
+// logit 篩選的放寬量：sigmoid 斜率 ≤ 0.25，放寬 1e-3 足以涵蓋 float 捨入，
+// 確保預篩選不會漏掉以 sigmoid 比較時會通過的 anchor
+static const float YOLO_LOGIT_MARGIN = 1.0e-3f;
+
+static inline float yoloSigmoid(float x) { return 1.0f / (1.0f + expf(-x)); }
+
+// 信心度閾值對應的 objectness logit 閾值；閾值不在 (0, 1) 內時不預篩選
+static inline float yoloLogitThreshold(float conf) {
+  if (!(conf > 0.0f && conf < 1.0f)) return -INFINITY;
+  return logf(conf / (1.0f - conf)) - YOLO_LOGIT_MARGIN;
+}
+
+class YoloDecoder {
+ public:
+  // data：連續 float32；featureMajor 為 true 時布局為 [F][N]，否則 [N][F]；F ≥ 6
+  YoloDecoder(const float* data, size_t anchors, size_t features, bool featureMajor)
+      : data_(data), n_(anchors), f_(features), featureMajor_(featureMajor) {}
+
+  // 解碼所有 confidence ≥ confThreshold 的 anchor，依 anchor 順序附加到 out，返回新增筆數
+  size_t decode(float confThreshold, std::vector<YoloDet>& out) const {
+    size_t before = out.size();
+    float logitThr = yoloLogitThreshold(confThreshold);
+    if (featureMajor_) {
+      scanContiguous(data_ + 4 * n_, logitThr, confThreshold, out);
+    } else {
+      const float* obj = data_ + 4;
+      for (size_t i = 0; i < n_; i++) {
+        if (obj[i * f_] >= logitThr) candidate(i, confThreshold, out);
+      }
+    }
+    return out.size() - before;
+  }
+
+ private:
+  // objectness 連續存放：4 個一組比較，只有遮罩非 0 的組才逐一檢查
+  void scanContiguous(const float* obj, float logitThr, float confThreshold, std::vector<YoloDet>& out) const {
+    f32x4 thr = f32x4_set1(logitThr);
+    size_t i = 0;
+    for (; i + 4 <= n_; i += 4) {
+      int mask = f32x4_ge_mask(f32x4_load(obj + i), thr);
+      for (int lane = 0; mask != 0; lane++, mask >>= 1) {
+        if (mask & 1) candidate(i + lane, confThreshold, out);
+      }
+    }
+    for (; i < n_; i++) {
+      if (obj[i] >= logitThr) candidate(i, confThreshold, out);
+    }
+  }
+
+  float at(size_t anchor, size_t feature) const {
+    return featureMajor_ ? data_[feature * n_ + anchor] : data_[anchor * f_ + feature];
+  }
+
+  // 通過 logit 預篩選的 anchor：sigmoid 後精確比較，類別取 logit 最大者（sigmoid 單調，argmax 相同）
+  void candidate(size_t i, float confThreshold, std::vector<YoloDet>& out) const {
+    float objectness = yoloSigmoid(at(i, 4));
+    if (!(objectness >= confThreshold)) return;
+
+    size_t best = 0;
+    float bestLogit = at(i, YOLO_CLASS_OFFSET);
+    for (size_t c = 1; c + YOLO_CLASS_OFFSET < f_; c++) {
+      float v = at(i, YOLO_CLASS_OFFSET + c);
+      if (v > bestLogit) {
+        bestLogit = v;
+        best = c;
+      }
+    }
+    float confidence = objectness * yoloSigmoid(bestLogit);
+    confidence = confidence < 0.0f ? 0.0f : (confidence > 1.0f ? 1.0f : confidence);
+    if (!(confidence >= confThreshold)) return;
+
+    YoloDet d;
+    d.cx = at(i, 0);
+    d.cy = at(i, 1);
+    d.w = at(i, 2);
+    d.h = at(i, 3);
+    d.confidence = confidence;
+    d.classId = (int32_t)best;
+    d.anchor = (int32_t)i;
+    out.push_back(d);
+  }
+
+  const float* data_;
+  size_t n_;
+  size_t f_;
+  bool featureMajor_;
+};
+
+#endif // YOLO_DECODER_H
@@ -20,6 +20,7 @@ Arduino PT2D 控制器 Python 介面
 from config_loader import config
 import serial
 import json
+import struct
 import time
 from typing import Dict, Optional, Tuple, Union
 import logging
@@ -28,6 +29,111 @@ logging.basicConfig(level=logging.INFO)
 logger = logging.getLogger(__name__)
 
 
+# ============================================
+# 二進位幀協議（對應固件 include/bin_proto.h）
+# 幀格式：SYNC(0xA5) | LEN | OPCODE | PAYLOAD | CRC8
+# LEN = OPCODE + PAYLOAD 長度；CRC-8/SMBUS 涵蓋 LEN..PAYLOAD；數值為小端序 int16
+# ============================================
+BIN_SYNC = 0xA5
+BIN_MAX_LEN = 16
+
+BIN_OP_PING = 0x01
+BIN_OP_MOVE = 0x02
+BIN_OP_MOVEBY = 0x03
+BIN_OP_STOP = 0x04
+BIN_OP_HOME = 0x05
+BIN_OP_POS = 0x06
+BIN_OP_STATUS = 0x07
+BIN_OP_LASER = 0x08
+BIN_OP_SPEED = 0x09
+BIN_OP_SUBSCRIBE = 0x0A
+BIN_OP_TRACK = 0x0B
+BIN_OP_TEXT = 0x0F
+
+BIN_RSP_ACK = 0x80
+BIN_RSP_POS = 0x80 | BIN_OP_POS
+BIN_RSP_STATUS = 0x80 | BIN_OP_STATUS
+BIN_RSP_TELEMETRY = 0x80 | BIN_OP_SUBSCRIBE
+
+# 遙測欄位位元（BIN_OP_SUBSCRIBE）及各位元對應的鍵（與 STATUS 順序一致）
+BIN_SUB_POS = 0x01
+BIN_SUB_TEMP = 0x02
+BIN_SUB_VOLT = 0x04
+BIN_SUB_KEYS = (
+    (BIN_SUB_POS, ('pan', 'tilt')),
+    (BIN_SUB_TEMP, ('pan_temp', 'tilt_temp')),
+    (BIN_SUB_VOLT, ('pan_voltage', 'tilt_voltage')),
+)
+
+BIN_STATUS_TEXT = {
+    0: 'OK',
+    1: 'Command failed',
+    2: 'Bad CRC',
+    3: 'Bad length',
+    4: 'Unknown opcode',
+}
+
+
+def crc8(data: bytes) -> int:
+    """CRC-8/SMBUS（多項式 0x07，初值 0x00）"""
+    crc = 0
+    for b in data:
+        crc ^= b
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def encode_frame(opcode: int, payload: bytes = b'') -> bytes:
+    """編碼一個二進位幀"""
+    body = bytes([len(payload) + 1, opcode]) + payload
+    return bytes([BIN_SYNC]) + body + bytes([crc8(body)])
+
+
+def decode_telemetry(data: bytes) -> Optional[Dict]:
+    """解碼 TELEMETRY 幀 payload（uint8 fields, uint16 t, 依欄位位元排列的 int16），格式錯誤返回 None"""
+    if len(data) < 3:
+        return None
+    fields = data[0]
+    keys = [k for bit, pair in BIN_SUB_KEYS if fields & bit for k in pair]
+    if len(data) != 3 + 2 * len(keys):
+        return None
+    values = struct.unpack(f'<H{len(keys)}h', data[1:])
+    result = {'tm': values[0]}
+    result.update(zip(keys, values[1:]))
+    return result
+
+
+def decode_frame(buf: bytes) -> Tuple[Optional[Tuple[int, bytes]], int]:
+    """
+    從緩衝區解碼一個二進位幀
+
+    Args:
+        buf: 已接收的位元組
+
+    Returns:
+        ((opcode, payload) 或 None, 已消耗位元組數)
+        - 幀不完整時返回 (None, 0)，呼叫端應等待更多資料
+        - SYNC 前的雜訊與 CRC 錯誤的幀會被消耗並返回 None
+    """
+    start = buf.find(bytes([BIN_SYNC]))
+    if start < 0:
+        return None, len(buf)
+    if len(buf) - start < 2:
+        return None, start
+    length = buf[start + 1]
+    if length == 0 or length > BIN_MAX_LEN:
+        return None, start + 1
+    end = start + 2 + length + 1
+    if len(buf) < end:
+        return None, start
+    body = buf[start + 1:end - 1]
+    if crc8(body) != buf[end - 1]:
+        logger.warning("二進位幀 CRC 錯誤")
+        return None, end
+    return (body[1], bytes(body[2:])), end
+
+
 class PT2DController:
     """Arduino 2D 雲台控制器類"""
 
@@ -51,6 +157,9 @@ class PT2DController:
         self.tilt_servo_id = getattr(config, 'tilt_servo_id', 2)  # 默認為2
         
         self.servo_enabled = False  # 初始為禁用，只有在成功初始化後才啟用
+        self.binary_mode = False    # 是否使用二進位幀協議（enable_binary_protocol() 啟用）
+        self._rx_buf = b''
+        self.telemetry = None       # 最近一筆遙測推送（subscribe() 啟用後由讀取函數更新）
 
         # 角度限制（初始值，會由 Arduino 動態設置）
         self.pan_min = 0
@@ -176,12 +285,16 @@ class PT2DController:
                 if line:
                     # 嘗試解析 JSON
                     try:
-                        json.loads(line)  # 驗證是否為有效 JSON
-                        return line
+                        data = json.loads(line)  # 驗證是否為有效 JSON
                     except json.JSONDecodeError:
                         # 非 JSON 格式，記錄並繼續讀取下一行
                         logger.debug(f"跳過非 JSON 訊息: {line}")
                         continue
+                    if isinstance(data, dict) and 'tm' in data:
+                        # 遙測推送不是命令響應：記錄後繼續讀取
+                        self.telemetry = data
+                        continue
+                    return line
             time.sleep(0.01)
 
         return ""
@@ -271,6 +384,95 @@ class PT2DController:
             logger.error(f"發送總線指令失敗: {e}")
             return {'error': str(e)}
 
+    def enable_binary_protocol(self) -> bool:
+        """
+        以文字命令 <BINARY:ON> 協商切換到二進位幀協議
+
+        啟用後 move_to / move_by / get_position / read_status / stop / home /
+        set_laser / set_speed / track / track_stop 改用二進位幀，其餘命令仍走文字協議。
+
+        Returns:
+            是否啟用成功
+        """
+        response = self.send_command('BINARY:ON')
+        self.binary_mode = response.get('status') == 'ok'
+        self._rx_buf = b''
+        if self.binary_mode:
+            logger.info("已啟用二進位幀協議")
+        else:
+            logger.warning(f"啟用二進位幀協議失敗: {response}")
+        return self.binary_mode
+
+    def disable_binary_protocol(self) -> Dict:
+        """退出二進位幀協議，恢復純文字協議"""
+        if not self.binary_mode:
+            return {'status': 'ok', 'message': 'OK'}
+        response = self.send_frame(BIN_OP_TEXT)
+        self.binary_mode = False
+        return response
+
+    def _read_frame(self, timeout: float = 1.0,
+                    telemetry: bool = False) -> Optional[Tuple[int, bytes]]:
+        """
+        讀取一個二進位回覆幀，逾時返回 None（幀前的文字訊息會被略過）
+
+        TELEMETRY 推送幀會更新 self.telemetry；telemetry=False 時略過並繼續等待回覆幀。
+        """
+        deadline = time.time() + timeout
+        while time.time() < deadline:
+            if self._rx_buf:
+                frame, consumed = decode_frame(self._rx_buf)
+                self._rx_buf = self._rx_buf[consumed:]
+                if frame is not None and frame[0] == BIN_RSP_TELEMETRY:
+                    self.telemetry = decode_telemetry(frame[1])
+                    if not telemetry:
+                        continue
+                if frame is not None:
+                    return frame
+            waiting = self.ser.in_waiting
+            self._rx_buf += self.ser.read(waiting if waiting > 0 else 1)
+        return None
+
+    def send_frame(self, opcode: int, payload: bytes = b'', timeout: float = 1.0) -> Dict:
+        """
+        發送二進位請求幀並將回覆轉為與文字協議相同格式的字典
+
+        Args:
+            opcode: 請求操作碼（BIN_OP_*）
+            payload: 小端序參數
+            timeout: 等待回覆時間（秒）
+
+        Returns:
+            ACK → {'status': 'ok'|'error', 'message': ...}
+            POS → {'pan': ..., 'tilt': ...}
+            STATUS → {'pan', 'tilt', 'pan_temp', 'tilt_temp', 'pan_voltage', 'tilt_voltage'}
+        """
+        if not self.is_connected:
+            return {'error': 'Not connected'}
+
+        try:
+            self.ser.write(encode_frame(opcode, payload))
+            frame = self._read_frame(timeout)
+        except Exception as e:
+            logger.error(f"發送二進位幀失敗: {e}")
+            return {'error': str(e)}
+
+        if frame is None:
+            return {'error': 'No response received'}
+
+        reply_op, data = frame
+        if reply_op == BIN_RSP_ACK and len(data) == 2:
+            status = data[1]
+            return {'status': 'ok' if status == 0 else 'error',
+                    'message': BIN_STATUS_TEXT.get(status, f'Status {status}')}
+        if reply_op == BIN_RSP_POS and len(data) == 4:
+            pan, tilt = struct.unpack('<hh', data)
+            return {'pan': pan, 'tilt': tilt}
+        if reply_op == BIN_RSP_STATUS and len(data) == 12:
+            keys = ('pan', 'tilt', 'pan_temp', 'tilt_temp', 'pan_voltage', 'tilt_voltage')
+            return dict(zip(keys, struct.unpack('<6h', data)))
+        return {'error': f'Unexpected reply opcode 0x{reply_op:02X}'}
+
     def move_to(self, pan: int, tilt: int) -> Dict:
         """
         移動到絕對位置（上位機自動限制角度在 Arduino 指定的安全範圍內）
@@ -291,6 +493,8 @@ class PT2DController:
 
         logger.debug(f"Move to: Pan={pan}° (限制範圍 {self.pan_min}-{self.pan_max}), "
                     f"Tilt={tilt}° (限制範圍 {self.tilt_min}-{self.tilt_max})")
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_MOVE, struct.pack('<hh', pan, tilt))
         return self.send_command(f'MOVE:{pan},{tilt}')
 
     def move_by(self, pan_delta: int, tilt_delta: int) -> Dict:
@@ -322,16 +526,28 @@ class PT2DController:
                     f"→ to Pan={target_pan}° Tilt={target_tilt}° "
                     f"(Pan限制 {self.pan_min}-{self.pan_max}, Tilt限制 {self.tilt_min}-{self.tilt_max})")
 
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_MOVEBY, struct.pack('<hh', pan_delta, tilt_delta))
         return self.send_command(f'MOVER:{pan_delta},{tilt_delta}')
 
-    def get_position(self) -> Tuple[Optional[int], Optional[int]]:
+    def get_position(self, verify: bool = False) -> Tuple[Optional[int], Optional[int]]:
         """
         獲取當前位置
 
+        預設由固件的位置模型立即回覆（依最後指令與移動時間插值，不經總線）；
+        verify=True 時固件改為從舵機讀取實際角度並校正模型。
+
+        Args:
+            verify: 是否從總線讀取實際角度
+
         Returns:
             (pan, tilt) 元組，失敗返回 (None, None)
         """
-        response = self.send_command('POS')
+        if self.binary_mode:
+            payload = b'\x01' if verify else b''
+            response = self.send_frame(BIN_OP_POS, payload, timeout=2.0)
+        else:
+            response = self.send_command('POS:VERIFY' if verify else 'POS')
         if 'pan' in response and 'tilt' in response:
             return response['pan'], response['tilt']
         return None, None
@@ -348,6 +564,66 @@ class PT2DController:
             return response['pan'], response['tilt']
         return None, None
 
+    def subscribe(self, fields: str = 'POS', period_ms: int = 20) -> Dict:
+        """
+        訂閱固件週期推送的遙測（固件 <SUBSCRIBE:fields,period_ms>）
+
+        固件自行以 period_ms 週期排程 PRAD/PRTV 查詢並推送結果，
+        之後以 read_telemetry() 取得，不需逐次輪詢 POS/STATUS。
+
+        Args:
+            fields: 'POS'、'TEMP'、'VOLT' 以 '+' 組合，或 'ALL'
+            period_ms: 推送週期（20-10000 毫秒；20 = 50 Hz）
+        """
+        if self.binary_mode:
+            names = {'POS': BIN_SUB_POS, 'TEMP': BIN_SUB_TEMP, 'VOLT': BIN_SUB_VOLT,
+                     'ALL': BIN_SUB_POS | BIN_SUB_TEMP | BIN_SUB_VOLT}
+            mask = 0
+            for name in fields.upper().split('+'):
+                if name not in names:
+                    return {'error': f'Unknown field {name}'}
+                mask |= names[name]
+            return self.send_frame(BIN_OP_SUBSCRIBE, struct.pack('<BH', mask, period_ms))
+        return self.send_command(f'SUBSCRIBE:{fields.upper()},{period_ms}')
+
+    def unsubscribe(self) -> Dict:
+        """取消遙測訂閱"""
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_SUBSCRIBE, struct.pack('<BH', 0, 0))
+        return self.send_command('SUBSCRIBE:OFF')
+
+    def read_telemetry(self, timeout: float = 0.1) -> Optional[Dict]:
+        """
+        讀取下一筆遙測推送
+
+        Returns:
+            {'tm': 採樣時間(ms), 'pan': ..., 'tilt': ..., ...}（僅含訂閱欄位，讀取逾時的欄位為 -1；
+            二進位模式下 tm 為 millis 低 16 位），逾時返回 None
+        """
+        if not self.is_connected:
+            return None
+        try:
+            if self.binary_mode:
+                frame = self._read_frame(timeout, telemetry=True)
+                if frame is None or frame[0] != BIN_RSP_TELEMETRY:
+                    return None
+                return self.telemetry
+            deadline = time.time() + timeout
+            while time.time() < deadline:
+                line = self.ser.readline().decode('utf-8', errors='ignore').strip()
+                if not line:
+                    continue
+                try:
+                    data = json.loads(line)
+                except json.JSONDecodeError:
+                    continue
+                if isinstance(data, dict) and 'tm' in data:
+                    self.telemetry = data
+                    return data
+        except Exception as e:
+            logger.error(f"讀取遙測失敗: {e}")
+        return None
+
     def read_temperature(self) -> Dict:
         """讀取雙軸溫度"""
         return self.send_command('TEMP')
@@ -367,6 +643,8 @@ class PT2DController:
             響應字典
         """
         speed = max(1, min(100, speed))  # 限制範圍
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_SPEED, bytes([speed]))
         return self.send_command(f'SPEED:{speed}')
 
     def config_servo_id(self, servo_id: int) -> Dict:
@@ -441,10 +719,14 @@ class PT2DController:
 
     def home(self) -> Dict:
         """回到初始位置"""
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_HOME)
         return self.send_command('HOME')
 
     def stop(self) -> Dict:
         """停止移動"""
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_STOP)
         return self.send_command('STOP')
 
     def set_led(self, state: Union[bool, str]) -> Dict:
@@ -465,8 +747,72 @@ class PT2DController:
             state: True/'ON' 開啟，False/'OFF' 關閉
         """
         val = 'ON' if (isinstance(state, bool) and state or (isinstance(state, str) and state.upper() == 'ON')) else 'OFF'
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_LASER, bytes([1 if val == 'ON' else 0]))
         return self.send_command(f'LASER:{val}')
 
+    def start_scan(self, mode: str = 'LINEAR') -> Dict:
+        """
+        啟動固件端自動掃描（固件 <SCAN:LINEAR|SINE|RANDOM>）
+
+        掃描完全在 Arduino 上執行，任何 move_to/move_by/home/stop 都會立即中止掃描。
+
+        Args:
+            mode: 'LINEAR'（光柵）、'SINE'（正弦）或 'RANDOM'（隨機覆蓋）
+        """
+        return self.send_command(f'SCAN:{mode.upper()}')
+
+    def stop_scan(self) -> Dict:
+        """停止固件端自動掃描（停在目前位置）"""
+        return self.send_command('SCAN:OFF')
+
+    def track(self, ex: int, ey: int, age_ms: int = 0) -> Dict:
+        """
+        送入視覺伺服誤差（固件 <TRACK:ex,ey,age_ms>），由固件端 50 Hz PID 閉環追蹤
+
+        首次呼叫即開始追蹤；超過固件 TRACK_TIMEOUT_MS 未送入新誤差會自動停止。
+        任何 move_to/move_by/home/stop/start_scan 都會中止追蹤。
+
+        Args:
+            ex: 目標相對影像中心的水平像素誤差（向右為正）
+            ey: 目標相對影像中心的垂直像素誤差（向下為正）
+            age_ms: 影像拍攝至今的時間（毫秒），固件據此扣除這段時間內雲台已轉過的角度
+        """
+        if not self.servo_enabled:
+            return {'error': 'Servo control is disabled due to initialization failure'}
+        ex = max(-32768, min(32767, int(ex)))
+        ey = max(-32768, min(32767, int(ey)))
+        age_ms = max(0, min(1000, int(age_ms)))
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_TRACK, struct.pack('<hhH', ex, ey, age_ms))
+        return self.send_command(f'TRACK:{ex},{ey},{age_ms}')
+
+    def track_stop(self) -> Dict:
+        """停止固件端視覺伺服（停在目前指令角度）"""
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_TRACK)
+        return self.send_command('TRACK:OFF')
+
+    def set_track_pid(self, kp: float, ki: float, kd: float,
+                      deg_per_px: Optional[float] = None) -> Dict:
+        """
+        設定固件端視覺伺服 PID（固件 <TRACKPID:kp,ki,kd[,mdeg_per_px]>）
+
+        Args:
+            kp: 比例增益（/秒）：誤差 1° 時的角速度（°/s）
+            ki: 積分增益（/秒²）
+            kd: 微分增益
+            deg_per_px: 每像素對應角度（度），None 表示沿用固件設定
+        """
+        values = [int(round(g * 1000)) for g in (kp, ki, kd)]
+        if deg_per_px is not None:
+            values.append(int(round(deg_per_px * 1000)))
+        return self.send_command('TRACKPID:' + ','.join(str(v) for v in values))
+
+    def get_track_pid(self) -> Dict:
+        """查詢固件端視覺伺服參數：{'kp','ki','kd','mdeg_per_px','active'}（增益 ×0.001）"""
+        return self.send_command('TRACKPID')
+
     # 總線指令快捷方法（橋接模式）
     def bus_move(self, servo_id: int, position: int, time_ms: int) -> Dict:
         """以總線指令移動單一舵機：#ID Pxxxx Tyyyy!"""
@@ -498,8 +844,43 @@ class PT2DController:
 
     def read_status(self) -> Dict:
         """讀取雙軸完整狀態（位置+電壓+溫度），對應固件 <STATUS>"""
+        if self.binary_mode:
+            return self.send_frame(BIN_OP_STATUS, timeout=2.0)
         return self.send_command("STATUS")
 
+    def get_latency_stats(self) -> Dict:
+        """
+        讀取固件延遲直方圖（固件 <STATS>，僅文字模式）
+
+        Returns:
+            {'unit': 'us', 'bucket0_lt': 16,
+             'rx_dispatch' / 'dispatch_bus' / 'bus_rtt' / 'cmd_local' / 'cmd_motion' / 'cmd_read':
+                 {'n': 筆數, 'mean': 平均, 'max': 最大, 'hist': [桶計數...]}}
+            hist[0] 為小於 bucket0_lt 微秒，其後每桶上限加倍，最後一桶收納其餘
+        """
+        return self.send_command('STATS')
+
+    def reset_latency_stats(self) -> Dict:
+        """清除固件延遲直方圖（固件 <STATS:RESET>）"""
+        return self.send_command('STATS:RESET')
+
+    def get_profile(self) -> Dict:
+        """
+        讀取固件主迴圈剖析與重置紀錄（固件 <PROFILE>）
+
+        Returns:
+            {'unit': 'us', 'loop': {'n', 'mean', 'max'},
+             'wdt_timeout_ms', 'wdt_gap_max_ms', 'wdt_margin_ms',
+             'tasks': {任務名: {'n', 'mean', 'max'}},
+             'cause': 'poweron' / 'external' / 'brownout' / 'watchdog', 'mcusr', 'boots',
+             以及重置前紀錄（若有）'last_task', 'last_loop_max_us', 'last_wdt_gap_ms'}
+        """
+        return self.send_command('PROFILE')
+
+    def reset_profile(self) -> Dict:
+        """清除固件迴圈 / 任務計時與最長餵狗間隔（固件 <PROFILE:RESET>）"""
+        return self.send_command('PROFILE:RESET')
+
     def swing_test(self) -> bool:
         """
         執行擺動測試：
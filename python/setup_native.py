@@ -0,0 +1,42 @@
+# Copyright 2025 Arduino PT2D Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+編譯上位機原生模組 pt2d_native（C++ 熱點路徑）
+
+在 python/ 目錄下執行：
+    python setup_native.py build_ext --inplace
+
+產生的 pt2d_native*.so 與其他 .py 放在同一目錄即可被匯入；
+未編譯時各呼叫端自動改用純 Python 實作（結果相同、較慢）。
+需要 C++ 編譯器與 Python 標頭（Debian/Ubuntu：sudo apt install g++ python3-dev）。
+"""
+
+from setuptools import setup, Extension
+
+pt2d_native = Extension(
+    'pt2d_native',
+    sources=['native/pt2d_native.cpp'],
+    depends=['native/kalman_tracker.h', 'native/nms.h', 'native/simd4.h', 'native/yolo_decoder.h'],
+    include_dirs=['native'],
+    language='c++',
+    extra_compile_args=['-O3', '-std=c++11'],
+)
+
+setup(
+    name='pt2d_native',
+    version='1.0.0',
+    description='PT2D host native hot paths',
+    ext_modules=[pt2d_native],
+)
@@ -17,6 +17,7 @@ from mosquito_detector import MosquitoDetector
 from mosquito_tracker import MosquitoTracker
 from pt2d_controller import PT2DController
 from depth_estimator import DepthEstimator
+from target_predictor import LatencyEstimator, predictor_from_config
 from config_loader import config  # 使用新的配置加載模組
 from collections import deque
 import sys
@@ -80,8 +81,10 @@ class StreamingTrackingSystem:
         logger.info(f"  imgsz: {config.imgsz}")
         logger.info(f"  confidence_threshold: {config.confidence_threshold}")
         logger.info(f"  iou_threshold: {config.iou_threshold}")
+        logger.info(f"  nms_method: {config.nms_method} (class_aware={config.nms_class_aware})")
         logger.info(f"  detection_mode: {config.detection_mode}")
         logger.info(f"  tile_overlap: {config.tile_overlap}")
+        logger.info(f"  tile_batch_size: {config.tile_batch_size}, npu_cores: {config.npu_cores}")
         logger.info(f"  detection_margin: {config.detection_margin}")
         logger.info(f"  min_mosquito_size_mm: {config.min_mosquito_size_mm}")
         logger.info(f"  max_mosquito_size_mm: {config.max_mosquito_size_mm}")
@@ -217,11 +220,16 @@ class StreamingTrackingSystem:
         }
 
         # 唯一目標追蹤（簡單去重機制）
-        self.active_tracks = {}           # {track_id: {'last_seen': time, 'center': (x,y), 'lost_frames': int}}
+        self.active_tracks = {}           # {track_id: {'last_seen': time, 'center': (x,y), 'lost_frames': int, 'predictor': TargetPredictor}}
         self.next_track_id = 1
         self.track_distance_threshold = 100  # 像素距離閾值（<100認為是同一目標）
         self.track_lost_frames_max = 30     # 超過30幀未見視為消失
 
+        # 目標運動預測：每個追蹤一個卡爾曼濾波器，以預測位置做關聯，
+        # 並標出影像時間 + 端到端延遲（影像讀取 → 處理完成，各追蹤共用）時的預測位置
+        self.enable_prediction = config.enable_prediction
+        self.prediction_latency = LatencyEstimator(actuation_delay=config.actuation_delay)
+
         # 單目過濾器追蹤數據（用於時間連續性和運動合理性檢查）
         self.detection_history = {}       # {track_id: {'frames': int, 'positions': deque, 'static_frames': int}}
 
@@ -409,6 +417,7 @@ class StreamingTrackingSystem:
             while self._running:
                 try:
                     ret, frame = cap.read()
+                    frame_time = time.time()
                     if not ret:
                         logger.warning("⚠️  無法讀取幀")
                         break
@@ -444,7 +453,8 @@ class StreamingTrackingSystem:
 
                     # 處理幀
                     try:
-                        result = self.process_frame(frame)
+                        result = self.process_frame(frame, frame_time)
+                        self.prediction_latency.observe(time.time() - frame_time)
 
                         # 成功恢復
                         if error_count > 0:
@@ -570,11 +580,15 @@ class StreamingTrackingSystem:
             'system_time': time.strftime("%Y-%m-%d %H:%M:%S")
         }
 
-    def process_frame(self, frame: np.ndarray) -> np.ndarray:
+    def process_frame(self, frame: np.ndarray, frame_time: float = None) -> np.ndarray:
         """
         處理單幀影像（AI 檢測 + 追蹤 + 標註）
 
         ⚠️ 重要：此函數每幀只調用一次 AI 檢測，不會重複！
+
+        Args:
+            frame: 影像幀
+            frame_time: 影像讀取時間（time.time()），None 表示現在
         """
         self.stats['total_frames'] += 1
 
@@ -664,7 +678,7 @@ class StreamingTrackingSystem:
 
         # 追蹤唯一目標
         if detections:
-            self._update_unique_targets(detections)
+            self._update_unique_targets(detections, frame_time)
 
             # 🎯 深度估計與尺寸過濾（如果啟用且有右眼影像）
             if self.depth_estimator and right_frame is not None:
@@ -789,9 +803,16 @@ class StreamingTrackingSystem:
 
         return frame
 
-    def _update_unique_targets(self, detections: list):
-        """更新唯一目標追蹤（簡單去重機制）"""
+    def _update_unique_targets(self, detections: list, frame_time: float = None):
+        """
+        更新唯一目標追蹤（簡單去重機制）
+
+        啟用預測時以各追蹤在本幀時間的預測位置做最近鄰關聯（快速飛行的目標不會因位移超過閾值而斷開），
+        並在檢測結果加入 'predicted_center'：影像時間 + 端到端延遲時的預測位置
+        """
         current_time = time.time()
+        if frame_time is None:
+            frame_time = current_time
 
         # 標記所有追蹤為「可能消失」
         for track_id in self.active_tracks:
@@ -809,6 +830,9 @@ class StreamingTrackingSystem:
                     continue  # 已消失的追蹤不匹配
 
                 track_center = track_info['center']
+                predictor = track_info.get('predictor')
+                if predictor is not None and predictor.updates >= 2:
+                    track_center = predictor.predict(frame_time)
                 distance = np.sqrt((center[0] - track_center[0])**2 +
                                  (center[1] - track_center[1])**2)
 
@@ -830,11 +854,18 @@ class StreamingTrackingSystem:
                 self.active_tracks[new_track_id] = {
                     'center': center,
                     'last_seen': current_time,
-                    'lost_frames': 0
+                    'lost_frames': 0,
+                    'predictor': (predictor_from_config(config, self.prediction_latency)
+                                  if self.enable_prediction else None)
                 }
                 self.stats['unique_targets'] += 1
                 detection['track_id'] = new_track_id
 
+            predictor = self.active_tracks[detection['track_id']]['predictor']
+            if predictor is not None:
+                predictor.update(center[0], center[1], frame_time)
+                detection['predicted_center'] = predictor.aim_point(frame_time)
+
         # 清理長時間未見的追蹤
         tracks_to_remove = [
             track_id for track_id, track_info in self.active_tracks.items()
@@ -0,0 +1,300 @@
+# Copyright 2025 Arduino PT2D Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+目標運動預測：卡爾曼濾波 + 端到端延遲估計
+
+攝影機曝光 → 推論 → 串口 → 舵機到位約有 100ms 延遲，瞄準「最後看到的位置」
+會讓雷射永遠落後飛行中的蚊子。本模組對每個追蹤目標維護一個卡爾曼濾波器，
+並以實測的端到端延遲預測「命令生效時」目標所在的位置：
+
+    predictor = TargetPredictor()
+    predictor.update(x, y, frame_time)             # 每幀量測（frame_time = 影像讀取時間）
+    aim_x, aim_y = predictor.aim_point(frame_time)  # 影像時間 + 延遲 時的預測位置
+    ...送出命令...
+    predictor.command_done(frame_time)             # 命令完成：更新延遲估計
+
+濾波器核心以 C++ 實作（native/kalman_tracker.h，python setup_native.py build_ext --inplace 編譯）；
+未編譯時使用下方逐式對應的純 Python 版本。
+"""
+
+import bisect
+import logging
+import time
+from collections import deque
+from typing import Optional, Tuple
+
+logger = logging.getLogger(__name__)
+
+# 初始化時速度 / 加速度的標準差（與 kalman_tracker.h 相同）
+KF_INIT_VEL_STD = 1000.0   # px/s
+KF_INIT_ACC_STD = 5000.0   # px/s²
+
+
+class _KalmanAxis:
+    """單軸濾波器（n = 2 為 CV，3 為 CA），對應 kalman_tracker.h 的 KalmanAxis"""
+
+    def __init__(self, n: int, pos: float, r2: float):
+        self.n = n
+        self.x = [pos, 0.0, 0.0]
+        self.P = [[0.0] * 3 for _ in range(3)]
+        self.P[0][0] = r2
+        self.P[1][1] = KF_INIT_VEL_STD ** 2
+        if n == 3:
+            self.P[2][2] = KF_INIT_ACC_STD ** 2
+
+    def _process_noise(self, dt: float, q: float):
+        dt2, dt3 = dt * dt, dt ** 3
+        if self.n == 2:
+            return [[q * dt3 / 3.0, q * dt2 / 2.0],
+                    [q * dt2 / 2.0, q * dt]]
+        dt4, dt5 = dt ** 4, dt ** 5
+        return [[q * dt5 / 20.0, q * dt4 / 8.0, q * dt3 / 6.0],
+                [q * dt4 / 8.0, q * dt3 / 3.0, q * dt2 / 2.0],
+                [q * dt3 / 6.0, q * dt2 / 2.0, q * dt]]
+
+    def predict(self, dt: float, q: float):
+        if dt <= 0.0:
+            return
+        n = self.n
+        F = [[1.0, dt, 0.5 * dt * dt], [0.0, 1.0, dt], [0.0, 0.0, 1.0]]
+        Q = self._process_noise(dt, q)
+        x = [sum(F[i][k] * self.x[k] for k in range(n)) for i in range(n)]
+        FP = [[sum(F[i][k] * self.P[k][j] for k in range(n)) for j in range(n)] for i in range(n)]
+        for i in range(n):
+            self.x[i] = x[i]
+            for j in range(n):
+                self.P[i][j] = Q[i][j] + sum(FP[i][k] * F[j][k] for k in range(n))
+
+    def update(self, z: float, r2: float) -> float:
+        n = self.n
+        y = z - self.x[0]
+        S = self.P[0][0] + r2
+        K = [self.P[i][0] / S for i in range(n)]
+        for i in range(n):
+            self.x[i] += K[i] * y
+        P0 = list(self.P[0])
+        for i in range(n):
+            for j in range(n):
+                self.P[i][j] -= K[i] * P0[j]
+        for i in range(n):
+            for j in range(i):
+                self.P[i][j] = self.P[j][i] = 0.5 * (self.P[i][j] + self.P[j][i])
+        return y * y / S
+
+    def extrapolate(self, dt: float) -> float:
+        acc = 0.5 * self.x[2] * dt * dt if self.n == 3 else 0.0
+        return self.x[0] + self.x[1] * dt + acc
+
+
+class PyKalmanTracker:
+    """
+    純 Python 版 KalmanTracker（與 pt2d_native.KalmanTracker 介面、結果相同）
+
+    Args:
+        order: 2 = 等速（CV），3 = 等加速度（CA）
+        process_noise: 過程雜訊強度 q（CV：px²/s³，CA：px²/s⁵）
+        measurement_noise: 量測標準差（px）
+    """
+
+    def __init__(self, order: int = 2, process_noise: float = 1.0e6, measurement_noise: float = 4.0):
+        if order not in (2, 3):
+            raise ValueError('order must be 2 (constant velocity) or 3 (constant acceleration)')
+        if process_noise < 0.0 or measurement_noise <= 0.0:
+            raise ValueError('process_noise must be >= 0 and measurement_noise > 0')
+        self.order = order
+        self._q = float(process_noise)
+        self._r2 = float(measurement_noise) ** 2
+        self._axes = None
+        self.time = 0.0
+
+    @property
+    def initialized(self) -> bool:
+        return self._axes is not None
+
+    def reset(self, x: float, y: float, t: float):
+        self._axes = (_KalmanAxis(self.order, float(x), self._r2),
+                      _KalmanAxis(self.order, float(y), self._r2))
+        self.time = float(t)
+
+    def update(self, x: float, y: float, t: float) -> float:
+        if self._axes is None:
+            self.reset(x, y, t)
+            return 0.0
+        self.advance(t)
+        return self._axes[0].update(float(x), self._r2) + self._axes[1].update(float(y), self._r2)
+
+    def advance(self, t: float):
+        dt = t - self.time
+        if dt <= 0.0:
+            return
+        self._axes[0].predict(dt, self._q)
+        self._axes[1].predict(dt, self._q)
+        self.time = float(t)
+
+    def predict(self, t: float) -> Tuple[float, float]:
+        if self._axes is None:
+            raise RuntimeError('KalmanTracker has no measurement yet')
+        dt = max(0.0, t - self.time)
+        return self._axes[0].extrapolate(dt), self._axes[1].extrapolate(dt)
+
+    @property
+    def position(self) -> Tuple[float, float]:
+        return self._axes[0].x[0], self._axes[1].x[0]
+
+    @property
+    def velocity(self) -> Tuple[float, float]:
+        return self._axes[0].x[1], self._axes[1].x[1]
+
+    @property
+    def acceleration(self) -> Tuple[float, float]:
+        if self.order == 2:
+            return 0.0, 0.0
+        return self._axes[0].x[2], self._axes[1].x[2]
+
+    @property
+    def variance(self) -> Tuple[float, float]:
+        return self._axes[0].P[0][0], self._axes[1].P[0][0]
+
+
+try:
+    from pt2d_native import KalmanTracker
+    NATIVE_AVAILABLE = True
+except ImportError:
+    KalmanTracker = PyKalmanTracker
+    NATIVE_AVAILABLE = False
+
+
+class LatencyEstimator:
+    """
+    端到端延遲估計：影像讀取 → 雲台命令送出完成的指數移動平均，再加上舵機機械響應時間
+
+    Args:
+        actuation_delay: 命令送出後舵機到位的固定時間（秒）
+        initial: 尚無量測時使用的延遲（秒，不含 actuation_delay）
+        alpha: 平滑係數（0-1，越大越跟隨最新量測）
+    """
+
+    def __init__(self, actuation_delay: float = 0.03, initial: float = 0.07, alpha: float = 0.1):
+        self.actuation_delay = actuation_delay
+        self.alpha = alpha
+        self.pipeline = initial
+        self.samples = 0
+
+    def observe(self, seconds: float):
+        """記錄一次影像讀取到命令完成的時間；異常值（< 0 或 > 1 秒）忽略"""
+        if not 0.0 <= seconds <= 1.0:
+            return
+        if self.samples == 0:
+            self.pipeline = seconds
+        else:
+            self.pipeline += self.alpha * (seconds - self.pipeline)
+        self.samples += 1
+
+    @property
+    def total(self) -> float:
+        """影像讀取到舵機到位的預估總延遲（秒）"""
+        return self.pipeline + self.actuation_delay
+
+
+class TargetPredictor:
+    """
+    單一目標的運動預測：卡爾曼濾波器 + 延遲補償
+
+    Args:
+        order: 2 = 等速（CV），3 = 等加速度（CA）
+        process_noise: 過程雜訊強度 q
+        measurement_noise: 量測標準差（px）
+        latency: 共用的 LatencyEstimator（多目標共用同一條管線延遲），None 則自建
+        max_horizon: 最長預測時間（秒），避免延遲異常時外推過遠
+    """
+
+    def __init__(self, order: int = 2, process_noise: float = 1.0e6, measurement_noise: float = 4.0,
+                 latency: Optional[LatencyEstimator] = None, max_horizon: float = 0.3):
+        self.filter = KalmanTracker(order, process_noise, measurement_noise)
+        self.latency = latency if latency is not None else LatencyEstimator()
+        self.max_horizon = max_horizon
+        self.updates = 0
+
+    def update(self, x: float, y: float, t: float) -> float:
+        """融合時間 t 的量測，返回標準化新息平方（目標突然改變運動時變大）"""
+        self.updates += 1
+        return self.filter.update(x, y, t)
+
+    def predict(self, t: float) -> Tuple[float, float]:
+        """時間 t 的預測位置（限制在最近量測之後 max_horizon 秒內）"""
+        return self.filter.predict(min(t, self.filter.time + self.max_horizon))
+
+    def aim_point(self, frame_time: float) -> Tuple[int, int]:
+        """
+        瞄準點：影像時間 + 端到端延遲時的預測位置（像素）
+
+        只有一筆量測時速度未知，直接返回量測位置
+        """
+        if self.updates < 2:
+            x, y = self.filter.position
+        else:
+            x, y = self.predict(frame_time + self.latency.total)
+        return int(round(x)), int(round(y))
+
+    def command_done(self, frame_time: float, now: Optional[float] = None):
+        """命令已送出（收到回覆）：以影像讀取至今的時間更新延遲估計"""
+        self.latency.observe((now if now is not None else time.time()) - frame_time)
+
+
+class GimbalHistory:
+    """
+    雲台角度歷史：以查詢時間記錄 (pan, tilt)，插值出影像拍攝當時的角度
+
+    攝影機裝在雲台上，影像座標的變化包含雲台自身的轉動；
+    以拍攝時的雲台角度把量測換算到世界座標，濾波器才只看到目標本身的運動。
+
+    Args:
+        span: 保留的時間長度（秒）
+    """
+
+    def __init__(self, span: float = 1.0):
+        self.span = span
+        self._t = deque()
+        self._v = deque()
+
+    def record(self, t: float, pan: float, tilt: float):
+        self._t.append(t)
+        self._v.append((pan, tilt))
+        while len(self._t) > 2 and t - self._t[0] > self.span:
+            self._t.popleft()
+            self._v.popleft()
+
+    def at(self, t: float) -> Optional[Tuple[float, float]]:
+        """時間 t 的雲台角度（線性插值；超出範圍取最近一筆），無紀錄返回 None"""
+        if not self._t:
+            return None
+        i = bisect.bisect_left(self._t, t)
+        if i <= 0:
+            return self._v[0]
+        if i >= len(self._t):
+            return self._v[-1]
+        t0, t1 = self._t[i - 1], self._t[i]
+        (p0, q0), (p1, q1) = self._v[i - 1], self._v[i]
+        w = (t - t0) / (t1 - t0) if t1 > t0 else 1.0
+        return p0 + (p1 - p0) * w, q0 + (q1 - q0) * w
+
+
+def predictor_from_config(cfg, latency: Optional[LatencyEstimator] = None) -> TargetPredictor:
+    """依 [TRACKING] 的 prediction_* 設定建立 TargetPredictor"""
+    return TargetPredictor(order=3 if cfg.prediction_model == 'ca' else 2,
+                           process_noise=cfg.prediction_process_noise,
+                           measurement_noise=cfg.prediction_measurement_noise,
+                           latency=latency,
+                           max_horizon=cfg.max_prediction_horizon)
@@ -23,7 +23,7 @@ import sys
 import time
 import traceback
 import json
-from pt2d_controller import PT2DController
+from pt2d_controller import PT2DController, BIN_OP_POS, BIN_OP_STATUS
 
 # 測試配置
 TEST_PORT = 'COM3'  # Windows
@@ -139,20 +139,22 @@ def test_status_queries(controller: PT2DController):
     print("註：VOLT 目前返回完整 STATUS 格式，這是預期行為")
 
 def test_error_handling(controller: PT2DController):
-    """測試錯誤處理"""
+    """測試錯誤處理與解析錯誤碼（code：1 未知命令、2 語法、3 範圍、4 個數、5 型別）"""
     print_test_header("錯誤處理測試")
 
-    # 1. 無效命令
-    response = controller.send_command('INVALID_COMMAND')
-    print_result('<INVALID_COMMAND>', response, ['status', 'message'])
-
-    # 2. 無效參數
-    response = controller.send_command('CONFIGSERVO:invalid')
-    print_result('<CONFIGSERVO:invalid>', response, ['status', 'message'])
-
-    # 3. 缺少參數
-    response = controller.send_command('MOVE:135')
-    print_result('<MOVE:135>', response, ['status', 'message'])
+    cases = [
+        ('INVALID_COMMAND', 1),   # 無效命令
+        ('MOVE:1;2', 2),          # 非法分隔符
+        ('MOVE:99999,45', 3),     # 超出 int16
+        ('MOVE:135', 4),          # 缺少參數
+        ('BEEP:1', 4),            # 多餘參數
+        ('CONFIGSERVO:invalid', 5),  # 無效參數
+    ]
+    for cmd, code in cases:
+        response = controller.send_command(cmd)
+        print_result(f'<{cmd}>', response, ['status', 'message', 'code'])
+        if response.get('code') != code:
+            print(f"❌ 錯誤碼應為 {code}，實際為 {response.get('code')}\n")
 
 def test_bus_commands(controller: PT2DController):
     """測試總線指令透傳"""
@@ -192,6 +194,151 @@ def test_wrapper_methods(controller: PT2DController):
     response = controller.home()
     print(f"響應: {json.dumps(response, ensure_ascii=False)}\n")
 
+def test_binary_protocol(controller: PT2DController):
+    """測試二進位幀協議（<BINARY:ON> 協商後使用）"""
+    print_test_header("二進位幀協議測試")
+
+    if not controller.enable_binary_protocol():
+        print("❌ 無法啟用二進位幀協議")
+        return
+
+    try:
+        # 1. MOVE（8 位元組請求 / 6 位元組 ACK）
+        response = controller.move_to(135, 90)
+        print_result('BIN MOVE 135,90', response, ['status', 'message'])
+        time.sleep(1)
+
+        # 2. POS
+        response = controller.send_frame(BIN_OP_POS, timeout=2.0)
+        print_result('BIN POS', response, ['pan', 'tilt'])
+
+        # 3. STATUS
+        response = controller.send_frame(BIN_OP_STATUS, timeout=2.0)
+        print_result('BIN STATUS', response,
+                    ['pan', 'tilt', 'pan_temp', 'tilt_temp', 'pan_voltage', 'tilt_voltage'])
+
+        # 4. 二進位模式下文字命令仍可使用
+        response = controller.send_command('GETINFO')
+        print_result('<GETINFO>（二進位模式下）', response, ['status', 'pan_id'])
+    finally:
+        response = controller.disable_binary_protocol()
+        print_result('BIN TEXT（退出二進位模式）', response, ['status'])
+
+def test_telemetry_subscription(controller: PT2DController):
+    """測試遙測訂閱推送（<SUBSCRIBE:fields,period_ms>）"""
+    print_test_header("遙測訂閱測試")
+
+    response = controller.subscribe('POS', 20)
+    print_result('<SUBSCRIBE:POS,20>', response, ['status', 'message'])
+
+    try:
+        # 1 秒內應收到約 50 筆位置推送
+        samples = []
+        deadline = time.time() + 1.0
+        while time.time() < deadline:
+            sample = controller.read_telemetry(timeout=0.1)
+            if sample is not None:
+                samples.append(sample)
+        print(f"1 秒內收到 {len(samples)} 筆推送")
+        if samples:
+            print_result('TELEMETRY', samples[-1], ['tm', 'pan', 'tilt'])
+        if len(samples) >= 2:
+            intervals = [b['tm'] - a['tm'] for a, b in zip(samples, samples[1:])]
+            print(f"平均間隔: {sum(intervals) / len(intervals):.1f} ms")
+
+        # 訂閱期間命令仍正常回覆
+        response = controller.send_command('GETINFO')
+        print_result('<GETINFO>（訂閱中）', response, ['status', 'pan_id'])
+
+        response = controller.subscribe('ALL', 500)
+        print_result('<SUBSCRIBE:ALL,500>', response, ['status'])
+        sample = controller.read_telemetry(timeout=1.0)
+        print_result('TELEMETRY (ALL)', sample or {},
+                    ['tm', 'pan', 'tilt', 'pan_temp', 'tilt_temp', 'pan_voltage', 'tilt_voltage'])
+    finally:
+        response = controller.unsubscribe()
+        print_result('<SUBSCRIBE:OFF>', response, ['status'])
+
+def test_latency_stats(controller: PT2DController):
+    """測試延遲直方圖（<STATS> / <STATS:RESET>）"""
+    print_test_header("延遲統計測試")
+
+    response = controller.reset_latency_stats()
+    print_result('<STATS:RESET>', response, ['status', 'message'])
+
+    # 各類命令各送幾次：本地命令、運動命令、總線讀取
+    for _ in range(5):
+        controller.send_command('GETINFO')
+        controller.move_to(135, 90)
+        controller.read_status()
+
+    stats = controller.get_latency_stats()
+    for key in ('rx_dispatch', 'dispatch_bus', 'bus_rtt', 'cmd_local', 'cmd_motion', 'cmd_read'):
+        h = stats.get(key)
+        if not h:
+            print(f"❌ {key}: 缺少欄位")
+            continue
+        status = "✅" if h['n'] > 0 else "⚠️"
+        print(f"{status} {key}: n={h['n']} mean={h['mean']}us max={h['max']}us hist={h['hist']}")
+
+def test_loop_profile(controller: PT2DController):
+    """測試迴圈剖析與看門狗餘裕（<PROFILE> / <PROFILE:RESET>）"""
+    print_test_header("迴圈剖析測試")
+
+    response = controller.reset_profile()
+    print_result('<PROFILE:RESET>', response, ['status', 'message'])
+
+    for _ in range(5):
+        controller.read_status()
+
+    prof = controller.get_profile()
+    loop = prof.get('loop')
+    if not loop or 'tasks' not in prof:
+        print(f"❌ 缺少欄位: {prof}")
+        return
+    print(f"✅ loop: n={loop['n']} mean={loop['mean']}us max={loop['max']}us")
+    for name, t in prof['tasks'].items():
+        print(f"   {name}: n={t['n']} mean={t['mean']}us max={t['max']}us")
+
+    margin = prof.get('wdt_margin_ms', -1)
+    status = "✅" if margin > prof.get('wdt_timeout_ms', 2000) // 2 else "⚠️"
+    print(f"{status} 看門狗最長間隔 {prof.get('wdt_gap_max_ms')}ms，餘裕 {margin}ms")
+    print(f"   重置原因: {prof.get('cause')} (mcusr={prof.get('mcusr')}, boots={prof.get('boots')})")
+    if 'last_task' in prof:
+        print(f"   重置前執行中任務: {prof['last_task']}")
+
+def test_visual_servo(controller: PT2DController):
+    """測試固件端視覺伺服（<TRACKPID> / <TRACK:ex,ey,age_ms> / <TRACK:OFF>）"""
+    print_test_header("視覺伺服測試")
+
+    response = controller.get_track_pid()
+    print_result('<TRACKPID>', response, ['kp', 'ki', 'kd', 'mdeg_per_px', 'active'])
+
+    controller.move_to(135, 90)
+    time.sleep(1)
+    try:
+        # 目標固定在影像中心右方 100 像素：以 15 fps 送入隨雲台轉動而縮小的誤差
+        deg_per_px = response.get('mdeg_per_px', 94) / 1000.0
+        ex = 100
+        for _ in range(15):
+            response = controller.track(ex, 0, 30)
+            time.sleep(1 / 15)
+            pan, _ = controller.read_position()
+            if pan is not None:
+                ex = int(round(100 - (pan - 135) / deg_per_px))
+        print_result('<TRACK:ex,0,30>', response, ['status'])
+        pan, tilt = controller.get_position()
+        print(f"1 秒後位置: Pan={pan}° Tilt={tilt}°（目標約 {135 + 100 * deg_per_px:.0f}°）")
+
+        response = controller.get_track_pid()
+        print_result('<TRACKPID>（追蹤中）', response, ['active'])
+
+        response = controller.send_command('TRACK:1')
+        print_result('<TRACK:1>（參數不足）', response, ['status', 'message'])
+    finally:
+        response = controller.track_stop()
+        print_result('<TRACK:OFF>', response, ['status', 'message'])
+
 def run_all_tests():
     """執行所有測試"""
     print("=" * 60)
@@ -220,6 +367,11 @@ def run_all_tests():
             test_error_handling(controller)
             test_bus_commands(controller)
             test_wrapper_methods(controller)
+            test_binary_protocol(controller)
+            test_telemetry_subscription(controller)
+            test_latency_stats(controller)
+            test_loop_profile(controller)
+            test_visual_servo(controller)
 
             print("\n" + "=" * 60)
             print("所有測試完成！")
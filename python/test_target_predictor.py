@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+# Copyright 2025 Arduino PT2D Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+目標運動預測測試（不需硬體）
+驗證卡爾曼濾波的 C++ / 純 Python 版本結果一致，預測能縮小延遲造成的瞄準誤差，
+以及以雲台角度歷史扣除自身轉動
+"""
+
+import math
+import random
+import sys
+
+from target_predictor import (GimbalHistory, LatencyEstimator, NATIVE_AVAILABLE,
+                              PyKalmanTracker, TargetPredictor)
+
+
+def flight_path(t):
+    """模擬蚊子飛行軌跡（像素）：不同頻率的擺動疊加"""
+    return (640 + 250 * math.sin(1.7 * t) + 80 * math.sin(5.1 * t + 1),
+            360 + 120 * math.cos(2.3 * t) + 40 * math.sin(7.0 * t))
+
+
+def test_native_matches_python():
+    """C++ 與純 Python 版本逐步結果一致"""
+    print("=" * 60)
+    print("測試 1: C++ / 純 Python 卡爾曼濾波一致性")
+    print("=" * 60)
+    if not NATIVE_AVAILABLE:
+        print("⚠️  pt2d_native 未編譯（python setup_native.py build_ext --inplace），略過")
+        return True
+
+    import pt2d_native
+    ok = True
+    for order, q in ((2, 1.0e6), (3, 5.0e7)):
+        rng = random.Random(order)
+        native = pt2d_native.KalmanTracker(order, q, 4.0)
+        python = PyKalmanTracker(order, q, 4.0)
+        t, worst = 0.0, 0.0
+        for _ in range(300):
+            t += rng.uniform(0.05, 0.09)
+            x, y = flight_path(t)
+            x, y = x + rng.gauss(0, 3), y + rng.gauss(0, 3)
+            nis_n = native.update(x, y, t)
+            nis_p = python.update(x, y, t)
+            pn, pp = native.predict(t + 0.1), python.predict(t + 0.1)
+            worst = max(worst, abs(pn[0] - pp[0]), abs(pn[1] - pp[1]), abs(nis_n - nis_p))
+        status = "✅" if worst < 1e-6 else "❌"
+        ok &= worst < 1e-6
+        print(f"{status} order={order}: 最大差異 {worst:.2e}")
+    return ok
+
+
+def test_prediction_reduces_lag():
+    """120ms 延遲下，瞄準預測位置的誤差明顯小於瞄準最後觀測位置"""
+    print("\n" + "=" * 60)
+    print("測試 2: 延遲補償（15 fps，延遲 120ms）")
+    print("=" * 60)
+    rng = random.Random(1)
+    latency = LatencyEstimator(actuation_delay=0.0)
+    latency.observe(0.12)
+    predictor = TargetPredictor(latency=latency)
+    t, err_pred, err_last, n = 0.0, 0.0, 0.0, 0
+    for i in range(600):
+        t += 1 / 15 + rng.uniform(-0.01, 0.01)
+        x, y = flight_path(t)
+        predictor.update(x + rng.gauss(0, 3), y + rng.gauss(0, 3), t)
+        if i > 30:
+            tx, ty = flight_path(t + latency.total)
+            ax, ay = predictor.aim_point(t)
+            err_pred += (ax - tx) ** 2 + (ay - ty) ** 2
+            err_last += (x - tx) ** 2 + (y - ty) ** 2
+            n += 1
+    rms_pred, rms_last = math.sqrt(err_pred / n), math.sqrt(err_last / n)
+    ok = rms_pred < 0.6 * rms_last
+    print(f"{'✅' if ok else '❌'} 瞄準最後位置 rms {rms_last:.1f}px → 瞄準預測位置 rms {rms_pred:.1f}px")
+    return ok
+
+
+def test_gimbal_motion_compensation():
+    """目標靜止、雲台轉動：換算到世界座標後估計速度接近 0"""
+    print("\n" + "=" * 60)
+    print("測試 3: 扣除雲台自身轉動")
+    print("=" * 60)
+    dpp = 0.094
+    target_pan, target_tilt = 150.0, 80.0
+    history = GimbalHistory()
+    predictor = TargetPredictor()
+    t = 0.0
+    for _ in range(30):
+        t += 1 / 15
+        pan, tilt = 135.0 + 20.0 * t, 90.0 - 5.0 * t   # 雲台等速轉動
+        history.record(t, pan, tilt)
+        cap_pan, cap_tilt = history.at(t)
+        ex = (target_pan - cap_pan) / dpp              # 影像中看到的偏移
+        ey = (cap_tilt - target_tilt) / dpp
+        predictor.update(cap_pan / dpp + ex, ey - cap_tilt / dpp, t)
+    vx, vy = predictor.filter.velocity
+    ok = abs(vx) < 1.0 and abs(vy) < 1.0
+    print(f"{'✅' if ok else '❌'} 世界座標速度 ({vx:.2f}, {vy:.2f}) px/s（應接近 0）")
+
+    mid = history.at(t - 0.5 / 15)
+    expect = (135.0 + 20.0 * (t - 0.5 / 15), 90.0 - 5.0 * (t - 0.5 / 15))
+    ok_interp = abs(mid[0] - expect[0]) < 1e-6 and abs(mid[1] - expect[1]) < 1e-6
+    print(f"{'✅' if ok_interp else '❌'} 雲台角度插值 {mid[0]:.2f}, {mid[1]:.2f}")
+    return ok and ok_interp
+
+
+def test_latency_estimator():
+    """延遲估計：第一筆直接採用，之後指數平均，異常值忽略"""
+    print("\n" + "=" * 60)
+    print("測試 4: 端到端延遲估計")
+    print("=" * 60)
+    latency = LatencyEstimator(actuation_delay=0.03, alpha=0.5)
+    latency.observe(0.08)
+    latency.observe(0.12)
+    latency.observe(5.0)     # 異常值
+    ok = abs(latency.pipeline - 0.10) < 1e-9 and abs(latency.total - 0.13) < 1e-9
+    print(f"{'✅' if ok else '❌'} 管線延遲 {latency.pipeline * 1000:.0f}ms，總延遲 {latency.total * 1000:.0f}ms")
+    return ok
+
+
+def main():
+    print(f"卡爾曼濾波實作: {'C++ (pt2d_native)' if NATIVE_AVAILABLE else '純 Python'}\n")
+    results = [
+        test_native_matches_python(),
+        test_prediction_reduces_lag(),
+        test_gimbal_motion_compensation(),
+        test_latency_estimator(),
+    ]
+    print("\n" + "=" * 60)
+    print(f"{sum(results)}/{len(results)} 項測試通過")
+    print("=" * 60)
+    return 0 if all(results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,170 @@
+#!/usr/bin/env python3
+# Copyright 2025 Arduino PT2D Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+平鋪批次推理測試（不需硬體）
+以模擬的 RKNN 執行環境驗證：批次打包 / 多核心同時推理的結果與原本逐視窗推理相同，
+以及多核心時的總耗時
+"""
+
+import queue
+import sys
+import time
+from concurrent.futures import ThreadPoolExecutor
+
+import cv2
+import numpy as np
+
+from mosquito_detector import MosquitoDetector
+
+IMGSZ = 640
+GRID = 8                # 模擬模型：每個視窗 8×8 個 anchor
+NPU_LATENCY = 0.01      # 模擬每次 NPU 呼叫耗時（秒）
+
+
+class FakeRKNN:
+    """模擬 RKNNLite：依輸入影像內容產生 YOLO 輸出 [batch, 85, 64]，固定批次大小"""
+
+    def __init__(self, batch: int):
+        self.batch = batch
+        self.calls = 0
+
+    def inference(self, inputs):
+        tensor = inputs[0]
+        assert tensor.shape == (self.batch, IMGSZ, IMGSZ, 3) and tensor.dtype == np.uint8
+        self.calls += 1
+        time.sleep(NPU_LATENCY)
+        cell = IMGSZ // GRID
+        out = np.full((self.batch, 85, GRID * GRID), -8.0, dtype=np.float32)
+        for b in range(self.batch):
+            means = tensor[b, :, :, 0].reshape(GRID, cell, GRID, cell).mean(axis=(1, 3))
+            for gy in range(GRID):
+                for gx in range(GRID):
+                    a, m = gy * GRID + gx, float(means[gy, gx])
+                    out[b, 0, a] = gx * cell + cell / 2 + m % 7
+                    out[b, 1, a] = gy * cell + cell / 2 + m % 5
+                    out[b, 2, a] = out[b, 3, a] = 20 + m / 10
+                    out[b, 4, a] = (m - 60) / 10
+                    out[b, 5 + int(m) % 3, a] = 5.0
+        return [out]
+
+
+def make_frame(seed: int) -> np.ndarray:
+    """1920×1080 畫面，隨機放置亮色方塊（紅色通道決定模擬模型的 objectness）"""
+    rng = np.random.default_rng(seed)
+    frame = np.full((1080, 1920, 3), 20, dtype=np.uint8)
+    for _ in range(40):
+        x, y, s = rng.integers(0, 1880), rng.integers(0, 1040), rng.integers(20, 120)
+        frame[y:y + s, x:x + s, 2] = rng.integers(120, 255)
+    return frame
+
+
+def make_detector(batch: int, cores: int) -> MosquitoDetector:
+    """不載入模型，直接建立 RKNN 後端的偵測器並掛上模擬執行環境"""
+    det = MosquitoDetector.__new__(MosquitoDetector)
+    det.imgsz = IMGSZ
+    det.confidence_threshold = 0.4
+    det.iou_threshold = 0.45
+    det.tile_overlap = 0.25
+    det.tile_batch_size = batch
+    det.npu_cores = cores
+    det.nms_method = 'hard'
+    det.nms_class_aware = False
+    det.soft_nms_sigma = 0.5
+    det.backend = 'rknn'
+    det.rknn_runtimes = [FakeRKNN(batch) for _ in range(cores)]
+    det.rknn = det.rknn_runtimes[0]
+    det._rknn_idle = queue.Queue()
+    for runtime in det.rknn_runtimes:
+        det._rknn_idle.put(runtime)
+    det._tile_pool = ThreadPoolExecutor(max_workers=cores)
+    return det
+
+
+def reference_tiled(det: MosquitoDetector, frame: np.ndarray):
+    """原本的 _detect_tiled：逐視窗縮放、轉色、推理、解析，再轉全域座標後 NMS"""
+    h, w = frame.shape[:2]
+    merged = []
+    for x0, y0 in det._tile_origins(w, h):
+        patch = frame[y0:min(h, y0 + IMGSZ), x0:min(w, x0 + IMGSZ)]
+        img = cv2.cvtColor(cv2.resize(patch, (IMGSZ, IMGSZ)), cv2.COLOR_BGR2RGB)
+        output = det.rknn.inference(inputs=[np.expand_dims(img, axis=0)])[0]
+        for d in det._parse_yolo_output(output, patch.shape[:2]):
+            bx, by, bw, bh = d['bbox']
+            cx, cy = d['center']
+            nd = d.copy()
+            nd['bbox'] = (bx + x0, by + y0, bw, bh)
+            nd['center'] = (cx + x0, cy + y0)
+            merged.append(nd)
+    return det._nms(merged, det.iou_threshold)
+
+
+def test_matches_per_tile():
+    """各種批次大小 / 核心數的結果與逐視窗推理相同"""
+    print("=" * 60)
+    print("測試 1: 批次 / 多核心結果與逐視窗推理相同")
+    print("=" * 60)
+    ok = True
+    reference = make_detector(1, 1)
+    for seed in range(3):
+        frame = make_frame(seed)
+        ref = reference_tiled(reference, frame)
+        for batch, cores in ((1, 1), (1, 3), (4, 1), (3, 3)):
+            det = make_detector(batch, cores)
+            dets, _ = det._detect_tiled(frame)
+            calls = sum(r.calls for r in det.rknn_runtimes)
+            good = dets == ref
+            ok &= good
+            if not good or seed == 0:
+                print(f"{'✅' if good else '❌'} seed={seed} batch={batch} cores={cores}: "
+                      f"{len(dets)} 個偵測（參考 {len(ref)}），NPU 呼叫 {calls} 次")
+            det._tile_pool.shutdown()
+    return ok
+
+
+def test_pipelined_time():
+    """多核心同時推理縮短平鋪總耗時"""
+    print("\n" + "=" * 60)
+    print(f"測試 2: 平鋪耗時（1920×1080，每次 NPU 呼叫 {NPU_LATENCY * 1000:.0f} ms）")
+    print("=" * 60)
+    frame = make_frame(0)
+    times = {}
+    for batch, cores in ((1, 1), (1, 3), (4, 1), (3, 3)):
+        det = make_detector(batch, cores)
+        det._detect_tiled(frame)
+        start = time.perf_counter()
+        for _ in range(5):
+            det._detect_tiled(frame)
+        times[(batch, cores)] = (time.perf_counter() - start) / 5 * 1000
+        det._tile_pool.shutdown()
+        print(f"   batch={batch} cores={cores}: {times[(batch, cores)]:.1f} ms")
+    ok = times[(1, 3)] < times[(1, 1)] and times[(3, 3)] < times[(1, 1)]
+    print(f"{'✅' if ok else '❌'} 多核心 / 批次推理快於逐視窗推理")
+    return ok
+
+
+def main():
+    results = [
+        test_matches_per_tile(),
+        test_pipelined_time(),
+    ]
+    print("\n" + "=" * 60)
+    print(f"{sum(results)}/{len(results)} 項測試通過")
+    print("=" * 60)
+    return 0 if all(results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
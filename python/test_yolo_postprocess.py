@@ -0,0 +1,283 @@
+#!/usr/bin/env python3
+# Copyright 2025 Arduino PT2D Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+YOLO 輸出後處理測試（不需硬體）
+驗證解碼與 NMS 的 C++ / numpy 版本與原本 Python 迴圈的結果一致、兩種布局不需轉置、
+soft-NMS / 類別感知的行為，以及耗時
+"""
+
+import sys
+import time
+
+import numpy as np
+
+from yolo_postprocess import NATIVE_AVAILABLE, NATIVE_SIMD, decode_yolo, nms
+
+ANCHORS = 8400
+FEATURES = 85
+CONF = 0.4
+
+
+def make_output(seed: int, hits: int = 12) -> np.ndarray:
+    """模擬 YOLOv8 輸出 [1, N, 85]：多數 anchor 的 objectness logit 很低，少數命中"""
+    rng = np.random.default_rng(seed)
+    out = np.empty((1, ANCHORS, FEATURES), dtype=np.float32)
+    out[0, :, 0:2] = rng.uniform(0, 640, (ANCHORS, 2))
+    out[0, :, 2:4] = rng.uniform(4, 60, (ANCHORS, 2))
+    out[0, :, 4] = rng.normal(-8.0, 2.0, ANCHORS)
+    out[0, :, 5:] = rng.normal(-5.0, 2.0, (ANCHORS, FEATURES - 5))
+    idx = rng.choice(ANCHORS, hits, replace=False)
+    out[0, idx, 4] = rng.uniform(-1.0, 4.0, hits)
+    out[0, idx, 5 + rng.integers(0, 80, hits)] = rng.uniform(0.0, 6.0, hits)
+    return out
+
+
+def reference_decode(output: np.ndarray, conf: float):
+    """原本 _parse_yolo_output 的逐 anchor 迴圈（只保留解碼部分）"""
+    result = []
+    for i, det in enumerate(output[0]):
+        objectness = 1.0 / (1.0 + np.exp(-det[4]))
+        if objectness < conf:
+            continue
+        scores = 1.0 / (1.0 + np.exp(-det[5:]))
+        class_id = int(np.argmax(scores))
+        confidence = min(1.0, max(0.0, float(objectness * scores[class_id])))
+        if confidence >= conf:
+            result.append((i, class_id, confidence))
+    return result
+
+
+def same(dets, ref) -> bool:
+    if len(dets) != len(ref):
+        return False
+    for d, (i, class_id, confidence) in zip(dets, ref):
+        if d['anchor'] != i or d['class_id'] != class_id or abs(d['confidence'] - confidence) > 1e-6:
+            return False
+    return True
+
+
+def implementations():
+    """要測試的實作：numpy，有編譯時加上 C++"""
+    return (False, True) if NATIVE_AVAILABLE else (False,)
+
+
+def test_matches_reference():
+    """兩種布局、C++ 與 numpy 版本都與原本迴圈結果一致"""
+    print("=" * 60)
+    print("測試 1: 與原本逐 anchor 解碼一致")
+    print("=" * 60)
+    ok = True
+    for seed in range(5):
+        row_major = make_output(seed)
+        feature_major = np.ascontiguousarray(row_major.transpose(0, 2, 1))
+        ref = reference_decode(row_major, CONF)
+        for name, out in (('[1,N,85]', row_major), ('[1,85,N]', feature_major)):
+            for native in implementations():
+                dets = decode_yolo(out, CONF, use_native=native)
+                good = same(dets, ref) and np.allclose(dets['cx'], row_major[0, dets['anchor'], 0])
+                ok &= good
+                if not good or seed == 0:
+                    impl = 'C++' if native else 'numpy'
+                    print(f"{'✅' if good else '❌'} seed={seed} {name} {impl}: {len(dets)} 筆（參考 {len(ref)} 筆）")
+    return ok
+
+
+def test_threshold_edges():
+    """閾值剛好落在 logit 篩選邊界附近時不漏判"""
+    print("\n" + "=" * 60)
+    print("測試 2: 閾值邊界")
+    print("=" * 60)
+    out = make_output(7, hits=0)
+    logit = np.float32(np.log(CONF / (1 - CONF)))
+    probes = np.nextafter(logit, np.float32(-np.inf)), logit, np.nextafter(logit, np.float32(np.inf))
+    for k, v in enumerate(probes):
+        out[0, k, 4] = v
+        out[0, k, 5] = 30.0     # 類別分數 ≈ 1
+    ref = reference_decode(out, CONF)
+    ok = True
+    for native in implementations():
+        dets = decode_yolo(out, CONF, use_native=native)
+        good = same(dets, ref)
+        ok &= good
+        print(f"{'✅' if good else '❌'} {'C++' if native else 'numpy'}: 邊界 anchor 通過 {dets['anchor'].tolist()}（參考 {[r[0] for r in ref]}）")
+    return ok
+
+
+def test_decode_time():
+    """8400 anchor 輸出的解碼耗時"""
+    print("\n" + "=" * 60)
+    print("測試 3: 解碼耗時（8400 anchors × 85）")
+    print("=" * 60)
+    row_major = make_output(1)
+    feature_major = np.ascontiguousarray(row_major.transpose(0, 2, 1))
+
+    start = time.perf_counter()
+    reference_decode(row_major, CONF)
+    legacy_ms = (time.perf_counter() - start) * 1000
+    print(f"   原本逐 anchor 迴圈: {legacy_ms:.1f} ms")
+
+    ok = True
+    for native in implementations():
+        for name, out in (('[1,N,85]', row_major), ('[1,85,N]', feature_major)):
+            runs = []
+            for _ in range(50):
+                start = time.perf_counter()
+                decode_yolo(out, CONF, use_native=native)
+                runs.append(time.perf_counter() - start)
+            ms = float(np.median(runs)) * 1000
+            impl = f'C++ ({NATIVE_SIMD})' if native else 'numpy'
+            if native:
+                good = ms < 1.0
+                ok &= good
+                print(f"{'✅' if good else '❌'} {impl} {name}: {ms:.3f} ms（目標 < 1 ms）")
+            else:
+                print(f"   {impl} {name}: {ms:.3f} ms")
+    return ok
+
+
+def tiled_boxes(seed: int, mosquitoes: int):
+    """模擬 1920×1080 平鋪偵測合併後的框：每隻蚊子在 1-4 個重疊視窗中各被偵測一次，位置略有偏差"""
+    rng = np.random.default_rng(seed)
+    boxes, scores = [], []
+    for _ in range(mosquitoes):
+        x, y = rng.uniform(0, 1880), rng.uniform(0, 1040)
+        size = rng.uniform(10, 40)
+        for _ in range(rng.integers(1, 5)):
+            dx, dy, ds = rng.normal(0, 2, 3)
+            boxes.append((round(x + dx), round(y + dy), round(x + dx + size + ds), round(y + dy + size + ds)))
+            scores.append(rng.uniform(0.4, 0.95))
+    return np.array(boxes, dtype=np.float32), np.array(scores, dtype=np.float32)
+
+
+def reference_nms(boxes: np.ndarray, scores: np.ndarray, iou_thresh: float):
+    """原本 MosquitoDetector._nms 的兩兩比較（返回保留的原始索引）"""
+    def iou(a, b):
+        inter = max(0, min(a[2], b[2]) - max(a[0], b[0])) * max(0, min(a[3], b[3]) - max(a[1], b[1]))
+        union = (a[2] - a[0]) * (a[3] - a[1]) + (b[2] - b[0]) * (b[3] - b[1]) - inter
+        return inter / union if union > 0 else 0.0
+
+    items = sorted(((tuple(int(v) for v in boxes[i]), float(scores[i]), i) for i in range(len(scores))),
+                   key=lambda b: b[1], reverse=True)
+    keep, suppressed = [], set()
+    for i in range(len(items)):
+        if i in suppressed:
+            continue
+        keep.append(items[i][2])
+        for j in range(i + 1, len(items)):
+            if j not in suppressed and iou(items[i][0], items[j][0]) > iou_thresh:
+                suppressed.add(j)
+    return keep
+
+
+def test_nms_matches_reference():
+    """硬 NMS 與原本兩兩比較結果一致（框數跨過網格啟用門檻）"""
+    print("\n" + "=" * 60)
+    print("測試 4: 硬 NMS 與原本 _nms 一致")
+    print("=" * 60)
+    ok = True
+    for seed, mosquitoes in ((0, 3), (1, 20), (2, 150)):
+        boxes, scores = tiled_boxes(seed, mosquitoes)
+        ref = reference_nms(boxes, scores, 0.45)
+        for native in implementations():
+            keep, _ = nms(boxes, scores, 0.45, use_native=native)
+            good = keep.tolist() == ref
+            ok &= good
+            print(f"{'✅' if good else '❌'} {'C++' if native else 'numpy'} {len(scores)} 框 → {len(keep)}（參考 {len(ref)}）")
+    return ok
+
+
+def test_soft_and_class_aware():
+    """soft-NMS 保留相鄰目標並降低信心度；類別感知不抑制不同類別；C++ / numpy 一致"""
+    print("\n" + "=" * 60)
+    print("測試 5: soft-NMS / 類別感知")
+    print("=" * 60)
+    # 兩隻緊鄰的蚊子（IoU ≈ 0.54）+ 一個不同類別的重疊框
+    boxes = np.array([(100, 100, 130, 130), (108, 100, 138, 130), (100, 101, 130, 131)], dtype=np.float32)
+    scores = np.array([0.9, 0.8, 0.7], dtype=np.float32)
+    classes = np.array([0, 0, 1], dtype=np.int32)
+    ok = True
+    for native in implementations():
+        impl = 'C++' if native else 'numpy'
+        hard, _ = nms(boxes, scores, 0.45, use_native=native)
+        soft, soft_scores = nms(boxes, scores, 0.45, method='gaussian', sigma=0.5, score_threshold=0.3,
+                                use_native=native)
+        aware, _ = nms(boxes, scores, 0.45, classes, use_native=native)
+        good = (hard.tolist() == [0] and soft.tolist()[:2] == [0, 1] and 0.3 < soft_scores[1] < 0.8
+                and aware.tolist() == [0, 2])
+        ok &= good
+        print(f"{'✅' if good else '❌'} {impl}: 硬 {hard.tolist()}，高斯 {soft.tolist()} "
+              f"({', '.join(f'{v:.2f}' for v in soft_scores)})，類別感知 {aware.tolist()}")
+
+    if NATIVE_AVAILABLE:
+        boxes, scores = tiled_boxes(3, 150)
+        classes = np.random.default_rng(3).integers(0, 3, len(scores)).astype(np.int32)
+        worst_keep, worst_score = True, 0.0
+        for method in ('linear', 'gaussian'):
+            for cls in (None, classes):
+                a = nms(boxes, scores, 0.3, cls, method, 0.5, 0.4, use_native=True)
+                b = nms(boxes, scores, 0.3, cls, method, 0.5, 0.4, use_native=False)
+                worst_keep &= np.array_equal(a[0], b[0])
+                worst_score = max(worst_score, float(np.max(np.abs(a[1] - b[1]))))
+        good = worst_keep and worst_score < 1e-5
+        ok &= good
+        print(f"{'✅' if good else '❌'} C++ / numpy soft-NMS 一致（{len(scores)} 框，分數最大差異 {worst_score:.1e}）")
+    return ok
+
+
+def test_nms_time():
+    """平鋪合併後的 NMS 耗時（蚊子越多，原本的兩兩比較成長越快）"""
+    print("\n" + "=" * 60)
+    print("測試 6: NMS 耗時（1920×1080 平鋪合併）")
+    print("=" * 60)
+    ok = True
+    for mosquitoes in (20, 200):
+        boxes, scores = tiled_boxes(4, mosquitoes)
+        start = time.perf_counter()
+        reference_nms(boxes, scores, 0.45)
+        legacy_ms = (time.perf_counter() - start) * 1000
+        line = f"{len(scores):4d} 框: 原本 {legacy_ms:7.2f} ms"
+        for native in implementations():
+            runs = []
+            for _ in range(20):
+                start = time.perf_counter()
+                nms(boxes, scores, 0.45, use_native=native)
+                runs.append(time.perf_counter() - start)
+            ms = float(np.median(runs)) * 1000
+            line += f" | {'C++' if native else 'numpy'} {ms:6.3f} ms"
+            if native:
+                ok &= ms < legacy_ms
+        print(f"{'✅' if ok else '❌'} {line}")
+    return ok
+
+
+def main():
+    print(f"後處理實作: {'C++ (pt2d_native, ' + NATIVE_SIMD + ')' if NATIVE_AVAILABLE else 'numpy'}\n")
+    results = [
+        test_matches_reference(),
+        test_threshold_edges(),
+        test_decode_time(),
+        test_nms_matches_reference(),
+        test_soft_and_class_aware(),
+        test_nms_time(),
+    ]
+    print("\n" + "=" * 60)
+    print(f"{sum(results)}/{len(results)} 項測試通過")
+    print("=" * 60)
+    return 0 if all(results) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,218 @@
+# Copyright 2025 Arduino PT2D Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+YOLO 輸出後處理：解碼與非極大值抑制（NMS）
+
+逐 anchor 的 Python 迴圈在 8400 個 anchor 的輸出上要數十毫秒。這裡先以 logit 閾值
+（sigmoid 的反函數）篩選 objectness 原始值，只對少數候選計算 sigmoid 與類別，
+並直接讀取 [1, F, N] / [1, N, F] 兩種布局，不做轉置：
+
+    dets = decode_yolo(output, conf_threshold)   # YOLO_DET_DTYPE 結構陣列
+    dets['cx'], dets['confidence'], ...
+
+NMS 支援硬 NMS、線性 / 高斯 soft-NMS 與類別感知：
+
+    keep, scores = nms(boxes_xyxy, scores, iou_threshold, method='hard')
+
+核心以 C++ 實作（native/yolo_decoder.h、native/nms.h，python setup_native.py build_ext --inplace 編譯）；
+未編譯時使用下方向量化的 numpy 版本，結果相同（numpy 版 NMS 不分網格，框多時較慢）。
+"""
+
+import logging
+from typing import Optional, Tuple
+
+import numpy as np
+
+logger = logging.getLogger(__name__)
+
+# 解碼結果的記錄格式（與 native/yolo_decoder.h 的 YoloDet 相同，28 bytes）
+# cx, cy, w, h 為模型輸入影像的像素座標；anchor 為輸出張量中的 anchor 索引
+YOLO_DET_DTYPE = np.dtype([
+    ('cx', '<f4'), ('cy', '<f4'), ('w', '<f4'), ('h', '<f4'),
+    ('confidence', '<f4'), ('class_id', '<i4'), ('anchor', '<i4'),
+])
+
+# 每個 anchor 的特徵：cx, cy, w, h, objectness, 類別分數...
+YOLO_CLASS_OFFSET = 5
+# COCO 格式的特徵數（4 + 1 + 80），用於判斷輸出布局
+YOLO_COCO_FEATURES = 85
+# logit 預篩選的放寬量（與 yolo_decoder.h 相同）
+YOLO_LOGIT_MARGIN = 1.0e-3
+
+# NMS 方法（數值與 native/nms.h 的 NmsMethod 相同）
+NMS_METHODS = {'hard': 0, 'linear': 1, 'gaussian': 2}
+
+try:
+    import pt2d_native
+    _native_decode = pt2d_native.decode_yolo
+    _native_nms = pt2d_native.nms
+    NATIVE_AVAILABLE = True
+    NATIVE_SIMD = pt2d_native.SIMD
+except (ImportError, AttributeError):
+    _native_decode = None
+    _native_nms = None
+    NATIVE_AVAILABLE = False
+    NATIVE_SIMD = None
+
+
+def yolo_layout(output: np.ndarray) -> Tuple[np.ndarray, bool]:
+    """
+    取出第一個 batch 並判斷布局
+
+    Returns:
+        (2D 陣列，feature_major)；feature_major 為 True 時形狀為 [F, N]，否則 [N, F]
+    """
+    if output.ndim == 3:
+        output = output[0]
+    if output.ndim != 2:
+        raise ValueError(f'不支援的 YOLO 輸出形狀: {output.shape}')
+    if output.shape[1] == YOLO_COCO_FEATURES:
+        return output, False
+    if output.shape[0] == YOLO_COCO_FEATURES:
+        return output, True
+    # 非 COCO 類別數：特徵數遠小於 anchor 數
+    return output, output.shape[0] < output.shape[1]
+
+
+def logit_threshold(conf_threshold: float) -> float:
+    """信心度閾值對應的 objectness logit 閾值（閾值不在 (0, 1) 內時不預篩選）"""
+    if not 0.0 < conf_threshold < 1.0:
+        return -np.inf
+    return float(np.log(conf_threshold / (1.0 - conf_threshold))) - YOLO_LOGIT_MARGIN
+
+
+def _sigmoid(x: np.ndarray) -> np.ndarray:
+    return np.float32(1.0) / (np.float32(1.0) + np.exp(-x))
+
+
+def decode_yolo_numpy(data: np.ndarray, conf_threshold: float, feature_major: bool) -> np.ndarray:
+    """numpy 版解碼（data 為 2D float32，布局見 yolo_layout）"""
+    obj_logits = data[4] if feature_major else data[:, 4]
+    idx = np.flatnonzero(obj_logits >= np.float32(logit_threshold(conf_threshold)))
+    cand = data[:, idx].T if feature_major else data[idx]
+
+    thr = np.float32(conf_threshold)
+    objectness = _sigmoid(cand[:, 4])
+    keep = objectness >= thr
+    cand, idx, objectness = cand[keep], idx[keep], objectness[keep]
+
+    class_logits = cand[:, YOLO_CLASS_OFFSET:]
+    class_id = np.argmax(class_logits, axis=1)
+    best = class_logits[np.arange(len(cand)), class_id]
+    confidence = np.clip(objectness * _sigmoid(best), np.float32(0.0), np.float32(1.0))
+    keep = confidence >= thr
+
+    dets = np.empty(int(np.count_nonzero(keep)), dtype=YOLO_DET_DTYPE)
+    for i, name in enumerate(('cx', 'cy', 'w', 'h')):
+        dets[name] = cand[keep, i]
+    dets['confidence'] = confidence[keep]
+    dets['class_id'] = class_id[keep]
+    dets['anchor'] = idx[keep]
+    return dets
+
+
+def decode_yolo(output: np.ndarray, conf_threshold: float, use_native: bool = True) -> np.ndarray:
+    """
+    解碼 YOLO 輸出張量
+
+    Args:
+        output: [1, F, N]、[1, N, F] 或去掉 batch 的 2D 輸出（F = 4 + 1 + 類別數）
+        conf_threshold: objectness 與最終信心度（objectness × 類別分數）的閾值
+        use_native: 有編譯 pt2d_native 時使用 C++ 版本
+
+    Returns:
+        YOLO_DET_DTYPE 結構陣列，依 anchor 順序排列
+    """
+    data, feature_major = yolo_layout(np.asarray(output))
+    if data.shape[0 if feature_major else 1] <= YOLO_CLASS_OFFSET:
+        raise ValueError(f'YOLO 輸出至少需要 6 個特徵（框、objectness、類別），實際形狀: {data.shape}')
+    # 只有非 float32 或不連續時才複製（一般 NPU 輸出不需要）
+    data = np.ascontiguousarray(data, dtype=np.float32)
+    if use_native and _native_decode is not None:
+        return np.frombuffer(_native_decode(data, conf_threshold, feature_major), dtype=YOLO_DET_DTYPE)
+    return decode_yolo_numpy(data, conf_threshold, feature_major)
+
+
+def nms_numpy(boxes: np.ndarray, scores: np.ndarray, iou_threshold: float, classes: Optional[np.ndarray],
+              method: int, sigma: float, score_threshold: float) -> Tuple[np.ndarray, np.ndarray]:
+    """numpy 版 NMS（每選一個框與其餘所有框向量化計算 IoU，算式與 nms.h 相同）"""
+    order = np.argsort(-scores, kind='stable')
+    x1, y1, x2, y2 = (boxes[order, k] for k in range(4))
+    zero = np.float32(0.0)
+    area = np.maximum(zero, x2 - x1) * np.maximum(zero, y2 - y1)
+    score = scores[order].copy()
+    cls = classes[order] if classes is not None else None
+    active = score >= np.float32(score_threshold)
+    thr = np.float32(0.0 if method == NMS_METHODS['gaussian'] else iou_threshold)
+
+    keep, kept_scores = [], []
+    while active.any():
+        if method == NMS_METHODS['hard']:
+            i = int(np.argmax(active))
+        else:
+            i = int(np.argmax(np.where(active, score, -np.inf)))
+        active[i] = False
+        keep.append(int(order[i]))
+        kept_scores.append(score[i])
+
+        w = np.maximum(zero, np.minimum(x2[i], x2) - np.maximum(x1[i], x1))
+        h = np.maximum(zero, np.minimum(y2[i], y2) - np.maximum(y1[i], y1))
+        inter = w * h
+        union = area[i] + area - inter
+        hit = active & (inter > thr * union) & (inter > zero)
+        if cls is not None:
+            hit &= cls == cls[i]
+        if method == NMS_METHODS['hard']:
+            active[hit] = False
+            continue
+        iou = inter[hit] / union[hit]
+        if method == NMS_METHODS['linear']:
+            score[hit] *= np.float32(1.0) - iou
+        else:
+            score[hit] *= np.exp(-(iou * iou) / np.float32(sigma))
+        active &= score >= np.float32(score_threshold)
+
+    return np.array(keep, dtype=np.int32), np.array(kept_scores, dtype=np.float32)
+
+
+def nms(boxes: np.ndarray, scores: np.ndarray, iou_threshold: float, classes: Optional[np.ndarray] = None,
+        method: str = 'hard', sigma: float = 0.5, score_threshold: float = 0.0,
+        use_native: bool = True) -> Tuple[np.ndarray, np.ndarray]:
+    """
+    非極大值抑制
+
+    Args:
+        boxes: (n, 4) 框，格式 (x1, y1, x2, y2)
+        scores: (n,) 信心度
+        iou_threshold: IoU 超過此值視為重複（高斯 soft-NMS 不使用）
+        classes: (n,) 類別；提供時只抑制相同類別的框
+        method: 'hard'（移除）、'linear'（分數 × (1 - IoU)）、'gaussian'（分數 × exp(-IoU² / sigma)）
+        sigma: 高斯 soft-NMS 參數
+        score_threshold: 分數（含衰減後）低於此值的框移除
+        use_native: 有編譯 pt2d_native 時使用 C++ 版本
+
+    Returns:
+        (保留框的原始索引（依選取順序），對應分數（soft-NMS 為衰減後）)
+    """
+    if method not in NMS_METHODS:
+        raise ValueError(f'未知的 NMS 方法: {method}（可選 {", ".join(NMS_METHODS)}）')
+    boxes = np.ascontiguousarray(boxes, dtype=np.float32).reshape(-1, 4)
+    scores = np.ascontiguousarray(scores, dtype=np.float32).reshape(-1)
+    if classes is not None:
+        classes = np.ascontiguousarray(classes, dtype=np.int32).reshape(-1)
+    if use_native and _native_nms is not None:
+        keep, kept = _native_nms(boxes, scores, iou_threshold, classes, NMS_METHODS[method], sigma, score_threshold)
+        return np.frombuffer(keep, dtype=np.int32), np.frombuffer(kept, dtype=np.float32)
+    return nms_numpy(boxes, scores, iou_threshold, classes, NMS_METHODS[method], sigma, score_threshold)
@@ -0,0 +1,212 @@
+# Copyright 2025 Arduino PT2D Project
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+"""
+AVR 韌體 SRAM 預算報告（PlatformIO post 腳本，env:uno / env:nano）
+
+連結完成後分析 firmware.elf：
+- 靜態 SRAM：.data + .bss + .noinit，並列出最大的靜態物件
+- 最壞堆疊深度：反組譯取得每個函數的框架大小（push 數 + Y 框架配置 + rcall .+0）
+  與呼叫圖，自 main 起求最深路徑，再加上最深的中斷向量
+  （AVR 中斷預設不巢狀）。間接呼叫（icall：命令表、任務表、回呼）
+  保守地視為可能呼叫任何「未被直接呼叫過」的函數。遞迴只計一層並提示。
+
+也可獨立執行：python scripts/sram_report.py .pio/build/uno/firmware.elf [avr-objdump 路徑]
+"""
+
+import re
+import subprocess
+import sys
+
+RAM_SIZE_DEFAULT = 2048
+RET_ADDR = 2            # ATmega328P 返回位址 2 位元組
+TOP_SYMBOLS = 10
+
+FUNC_RE = re.compile(r'^([0-9a-f]+) <(.+)>:$')
+INSN_RE = re.compile(r'^\s*[0-9a-f]+:\s+(?:[0-9a-f]{2}\s)+\s*([a-z]+)\s*([^;]*?)\s*(?:;(.*))?$')
+TARGET_RE = re.compile(r'<([^>+]+)>\s*$')
+IMM_RE = re.compile(r'0x([0-9a-f]+)|(\d+)$')
+
+
+def run(cmd):
+    return subprocess.run(cmd, check=True, stdout=subprocess.PIPE,
+                          universal_newlines=True).stdout
+
+
+def section_sizes(objdump, elf):
+    """回傳 {'.data': n, '.bss': n, '.noinit': n}"""
+    sizes = {'.data': 0, '.bss': 0, '.noinit': 0}
+    for line in run([objdump, '-h', elf]).splitlines():
+        parts = line.split()
+        if len(parts) >= 3 and parts[1] in sizes:
+            sizes[parts[1]] = int(parts[2], 16)
+    return sizes
+
+
+def largest_objects(nm, elf):
+    """SRAM 中的靜態物件（大小, 名稱），由大到小"""
+    objs = []
+    for line in run([nm, '--size-sort', '-S', '-C', elf]).splitlines():
+        parts = line.split(None, 3)
+        if len(parts) == 4 and parts[2] in 'bBdD':
+            objs.append((int(parts[1], 16), parts[3]))
+    objs.sort(reverse=True)
+    return objs
+
+
+def _imm(args):
+    m = IMM_RE.search(args)
+    if not m:
+        return 0
+    return int(m.group(1), 16) if m.group(1) else int(m.group(2))
+
+
+def parse_functions(text):
+    """反組譯 → {函數: {'frame': 位元組, 'calls': [(callee, 返回位址)], 'icall': bool}}"""
+    funcs = {}
+    cur = name = None
+    frame_regs = False   # 已執行 in r28,0x3d（接著以 sbiw / subi+sbci 配置 Y 框架）
+    for line in text.splitlines():
+        m = FUNC_RE.match(line)
+        if m:
+            name = m.group(2)
+            cur = {'frame': 0, 'calls': [], 'icall': False}
+            funcs[name] = cur
+            frame_regs = False
+            continue
+        if cur is None:
+            continue
+        m = INSN_RE.match(line)
+        if not m:
+            continue
+        op, args, comment = m.group(1), m.group(2), m.group(3) or ''
+
+        if op == 'push':
+            cur['frame'] += 1
+        elif op == 'in' and args.replace(' ', '') == 'r28,0x3d':
+            frame_regs = True
+        elif frame_regs and op in ('sbiw', 'subi') and args.startswith('r28'):
+            cur['frame'] += _imm(args)
+            if op == 'sbiw':
+                frame_regs = False
+        elif frame_regs and op == 'sbci' and args.startswith('r29'):
+            cur['frame'] += _imm(args) << 8
+            frame_regs = False
+        elif op == 'rcall' and args.startswith('.+0'):
+            cur['frame'] += RET_ADDR      # rcall .+0：以返回位址一次配置 2 位元組
+        elif op in ('call', 'rcall', 'jmp', 'rjmp'):
+            t = TARGET_RE.search(comment)
+            if t and t.group(1) != name:
+                # call 會再壓入返回位址；jmp 為尾呼叫（沿用呼叫者的返回位址）
+                cur['calls'].append((t.group(1), RET_ADDR if op.endswith('call') else 0))
+        elif op in ('icall', 'eicall'):
+            cur['icall'] = True
+    return funcs
+
+
+class StackAnalysis:
+    def __init__(self, funcs):
+        self.funcs = funcs
+        called = {c for f in funcs.values() for c, _ in f['calls']}
+        # 間接呼叫的可能目標：從未被直接呼叫、也不是進入點或向量表的函數
+        self.indirect = [n for n in funcs
+                         if n not in called and n != 'main' and not n.startswith('__')]
+        self.memo = {}
+        self.recursive = set()
+
+    def depth(self, name, stack=()):
+        """回傳 (最深位元組數, 路徑)"""
+        if name in self.memo:
+            return self.memo[name]
+        f = self.funcs.get(name)
+        if f is None:
+            return 0, [name]
+        stack = stack + (name,)
+        best, path = 0, []
+        edges = [(c, ret, False) for c, ret in f['calls']]
+        if f['icall']:
+            edges += [(c, RET_ADDR, True) for c in self.indirect]
+        for callee, ret, indirect in edges:
+            if callee in stack:
+                # 直接呼叫成環為真正的遞迴；間接呼叫成環多半只是保守假設的產物，略過
+                if not indirect:
+                    self.recursive.add(callee)
+                continue
+            d, p = self.depth(callee, stack)
+            if d + ret > best:
+                best, path = d + ret, p
+        result = (f['frame'] + best, [name] + path)
+        self.memo[name] = result
+        return result
+
+
+def report(elf, objdump, nm, ram_size=RAM_SIZE_DEFAULT):
+    sizes = section_sizes(objdump, elf)
+    static = sum(sizes.values())
+    funcs = parse_functions(run([objdump, '-d', elf]))
+    sa = StackAnalysis(funcs)
+
+    main_depth, main_path = sa.depth('main')
+    isr_depth, isr_path = 0, []
+    for name in funcs:
+        if name.startswith('__vector_'):
+            d, p = sa.depth(name)
+            if d > isr_depth:
+                isr_depth, isr_path = d, p
+    stack = main_depth + (RET_ADDR + isr_depth if isr_path else 0)
+    free = ram_size - static - stack
+
+    print('')
+    print('SRAM budget (%d bytes)' % ram_size)
+    print('  .data   %5d' % sizes['.data'])
+    print('  .bss    %5d' % sizes['.bss'])
+    print('  .noinit %5d' % sizes['.noinit'])
+    print('  static  %5d  (%.1f%%)' % (static, 100.0 * static / ram_size))
+    print('  stack   %5d  worst case = main %d + ISR %d' % (stack, main_depth, stack - main_depth))
+    print('  free    %5d%s' % (free, '  WARNING: static + stack exceeds SRAM' if free < 0 else ''))
+    print('  main path: ' + ' > '.join(main_path))
+    if isr_path:
+        print('  ISR path:  ' + ' > '.join(isr_path))
+    if sa.recursive:
+        print('  recursion (counted once): ' + ', '.join(sorted(sa.recursive)))
+    print('Largest static objects:')
+    for size, name in largest_objects(nm, elf)[:TOP_SYMBOLS]:
+        print('  %5d  %s' % (size, name))
+    return free
+
+
+def _tool(env, name):
+    # $OBJCOPY = .../avr-objcopy → 同目錄的 avr-objdump / avr-nm
+    objcopy = env.subst('$OBJCOPY')
+    return objcopy[:-len('objcopy')] + name if objcopy.endswith('objcopy') else 'avr-' + name
+
+
+def _post_build(source, target, env):
+    elf = str(source[0])
+    ram = int(env.BoardConfig().get('upload.maximum_ram_size', RAM_SIZE_DEFAULT))
+    try:
+        report(elf, _tool(env, 'objdump'), _tool(env, 'nm'), ram)
+    except (OSError, subprocess.CalledProcessError) as e:
+        print('sram_report: skipped (%s)' % e)
+
+
+if __name__ == '__main__':
+    if len(sys.argv) < 2:
+        sys.exit('usage: sram_report.py firmware.elf [avr-objdump] [avr-nm]')
+    report(sys.argv[1],
+           sys.argv[2] if len(sys.argv) > 2 else 'avr-objdump',
+           sys.argv[3] if len(sys.argv) > 3 else 'avr-nm')
+else:
+    Import('env')  # noqa: F821  （PlatformIO SCons 環境）
+    env.AddPostAction('$BUILD_DIR/${PROGNAME}.elf', _post_build)  # noqa: F821
@@ -0,0 +1,307 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file zl_servo_sim.cpp
+ * @brief ZL 總線舵機模擬器實作
+ */
+
+#include "zl_servo_sim.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+SimConfig simDefaultConfig() {
+  SimConfig c;
+  c.baud = 115200;
+  c.replyLatencyUs = 300;
+  c.replyJitterUs = 0;
+  c.maxSpeed = 1500.0f;       // 約 400 度/秒
+  c.ambientTemp = 30.0f;
+  c.heatTemp = 25.0f;
+  c.thermalTau = 120.0f;
+  c.voltageMv = 7400;
+  c.voltageSagMv = 300;
+  c.dropRate = 0.0f;
+  c.garbleRate = 0.0f;
+  c.seed = 1;
+  return c;
+}
+
+ZlBusSim::ZlBusSim(const SimConfig& cfg)
+    : cfg_(cfg), servoCount_(0), hostFreeUs_(0), wireFreeUs_(0), rxDoneUs_(0), cmdLen_(0), inCmd_(false),
+      cmdBroken_(false), groupCount_(0), inGroup_(false), outHead_(0), outCount_(0) {
+  byteUs_ = (uint32_t)(10UL * 1000000UL / (cfg.baud ? cfg.baud : 115200));
+  // 打散種子：xorshift 以小種子起始時前幾個值偏小
+  rng_ = cfg.seed * 2654435761UL;
+  if (rng_ == 0) rng_ = 0x9E3779B9UL;
+  memset(&stats_, 0, sizeof(stats_));
+}
+
+SimServo* ZlBusSim::addServo(uint8_t id, uint16_t pos) {
+  if (servoCount_ >= SIM_MAX_SERVOS) return NULL;
+  SimServo& s = servos_[servoCount_++];
+  s.id = id;
+  s.mode = 1;
+  s.torque = true;
+  s.offline = false;
+  s.from = s.target = (float)(pos > SIM_POS_MAX ? SIM_POS_MAX : pos);
+  s.moveStartUs = 0;
+  s.moveUs = 0;
+  s.temp = cfg_.ambientTemp;
+  s.thermalAtUs = 0;
+  return &s;
+}
+
+SimServo* ZlBusSim::servo(uint8_t id) {
+  for (uint8_t i = 0; i < servoCount_; i++) {
+    if (servos_[i].id == id) return &servos_[i];
+  }
+  return NULL;
+}
+
+float ZlBusSim::position(const SimServo& s, uint64_t nowUs) const {
+  if (s.moveUs == 0 || nowUs >= s.moveStartUs + s.moveUs) return s.target;
+  if (nowUs <= s.moveStartUs) return s.from;
+  float k = (float)(nowUs - s.moveStartUs) / (float)s.moveUs;
+  return s.from + (s.target - s.from) * k;
+}
+
+// xorshift32：可重現的故障注入與延遲抖動
+float ZlBusSim::random01() {
+  rng_ ^= rng_ << 13;
+  rng_ ^= rng_ >> 17;
+  rng_ ^= rng_ << 5;
+  return (float)(rng_ >> 8) / (float)(1UL << 24);
+}
+
+// ============================================
+// 線路收發
+// ============================================
+
+// 主機位元組佔用 [startUs, endUs)：與其重疊的回覆位元組損毀，返回是否碰撞
+bool ZlBusSim::collide(uint64_t startUs, uint64_t endUs) {
+  bool hit = false;
+  for (size_t i = 0; i < outCount_; i++) {
+    size_t slot = (outHead_ + i) % SIM_OUT_QUEUE;
+    uint64_t due = outDue_[slot];  // 回覆位元組佔用 [due - byteUs_, due)
+    if (due - byteUs_ >= endUs) break;
+    if (due > startUs) {
+      out_[slot] = 0xFF;
+      hit = true;
+    }
+  }
+  return hit;
+}
+
+void ZlBusSim::receive(uint8_t b, uint64_t nowUs) {
+  // 主機 UART 逐位元組依波特率送出，不會等待舵機回覆結束（半雙工線路上重疊即碰撞）
+  uint64_t start = nowUs > hostFreeUs_ ? nowUs : hostFreeUs_;
+  hostFreeUs_ = start + byteUs_;
+  rxDoneUs_ = hostFreeUs_;
+  bool hit = collide(start, hostFreeUs_);
+  if (hit) stats_.collisions++;
+
+  char c = (char)b;
+  if (hit && c != '#') {
+    // 損毀的位元組：舵機看到的是雜訊，進行中的指令 / 群組整筆作廢
+    if (inCmd_) cmdBroken_ = true;
+    if (c == '}') inGroup_ = false;
+    if (c != '!' || !inCmd_) return;
+  }
+  if (c == '{' || c == '}') {
+    // 群組：'{' 開始暫存，'}' 時所有暫存指令以同一完成時刻執行
+    if (c == '}' && inGroup_) {
+      for (uint8_t i = 0; i < groupCount_; i++) execute(group_[i], rxDoneUs_);
+    }
+    inGroup_ = (c == '{');
+    groupCount_ = 0;
+    inCmd_ = false;
+    return;
+  }
+  if (c == '#') {
+    inCmd_ = true;
+    cmdBroken_ = hit;
+    cmdLen_ = 0;
+  }
+  if (!inCmd_) return;  // 指令之間的換行等
+
+  if (cmdLen_ >= SIM_CMD_MAX) {
+    stats_.unknown++;
+    inCmd_ = false;
+    return;
+  }
+  if (c == '!') {
+    cmd_[cmdLen_] = '\0';
+    inCmd_ = false;
+    if (cmdBroken_) {
+      cmdBroken_ = false;  // 碰撞損毀：不執行、不回覆（主機端只會看到逾時）
+    } else if (!inGroup_) {
+      execute(cmd_, rxDoneUs_);
+    } else if (groupCount_ < SIM_GROUP_MAX) {
+      memcpy(group_[groupCount_++], cmd_, cmdLen_ + 1);
+    } else {
+      stats_.unknown++;
+    }
+    return;
+  }
+  cmd_[cmdLen_++] = c;
+}
+
+size_t ZlBusSim::transmit(uint64_t nowUs, uint8_t* out, size_t max) {
+  size_t n = 0;
+  while (n < max && outCount_ > 0 && outDue_[outHead_] <= nowUs) {
+    out[n++] = out_[outHead_];
+    outHead_ = (outHead_ + 1) % SIM_OUT_QUEUE;
+    outCount_--;
+  }
+  return n;
+}
+
+uint64_t ZlBusSim::nextTxUs() const {
+  return outCount_ > 0 ? outDue_[outHead_] : UINT64_MAX;
+}
+
+// 排入一筆回覆：延遲後逐位元組依波特率送達（廣播時各舵機依序排隊，舵機之間不模擬碰撞）
+void ZlBusSim::reply(const char* text, uint64_t doneUs) {
+  if (cfg_.dropRate > 0.0f && random01() < cfg_.dropRate) {
+    stats_.dropped++;
+    return;
+  }
+
+  char buf[SIM_CMD_MAX + 1];
+  size_t len = strlen(text);
+  if (len > SIM_CMD_MAX) len = SIM_CMD_MAX;
+  memcpy(buf, text, len);
+  if (cfg_.garbleRate > 0.0f && random01() < cfg_.garbleRate) {
+    // 損毀 '#' 之後的一個位元組（保留起始符使接收端仍嘗試解析）
+    size_t i = 1 + (size_t)(random01() * (float)(len - 1));
+    buf[i] = (char)('A' + (int)(random01() * 26.0f));
+    stats_.garbled++;
+  }
+
+  uint64_t start = doneUs + cfg_.replyLatencyUs;
+  if (cfg_.replyJitterUs > 0) start += (uint64_t)(random01() * (float)cfg_.replyJitterUs);
+  if (start < wireFreeUs_) start = wireFreeUs_;
+
+  for (size_t i = 0; i < len; i++) {
+    if (outCount_ >= SIM_OUT_QUEUE) {
+      stats_.overflow += (uint32_t)(len - i);
+      break;
+    }
+    size_t slot = (outHead_ + outCount_) % SIM_OUT_QUEUE;
+    start += byteUs_;
+    out_[slot] = (uint8_t)buf[i];
+    outDue_[slot] = start;
+    outCount_++;
+  }
+  wireFreeUs_ = start;
+  stats_.replies++;
+}
+
+// ============================================
+// 指令處理
+// ============================================
+
+// cmd 為去掉 '!' 的 "#IDxxx..."：ID 固定三位數
+void ZlBusSim::execute(const char* cmd, uint64_t doneUs) {
+  if (strlen(cmd) < 5 || cmd[1] < '0' || cmd[1] > '9' || cmd[2] < '0' || cmd[2] > '9' ||
+      cmd[3] < '0' || cmd[3] > '9') {
+    stats_.unknown++;
+    return;
+  }
+  int id = (cmd[1] - '0') * 100 + (cmd[2] - '0') * 10 + (cmd[3] - '0');
+  const char* op = cmd + 4;
+
+  bool known = false;
+  for (uint8_t i = 0; i < servoCount_; i++) {
+    SimServo& s = servos_[i];
+    if (s.offline || (id != SIM_BROADCAST_ID && s.id != id)) continue;
+    handle(s, op, doneUs);
+    known = true;
+  }
+  if (known) stats_.commands++;
+}
+
+void ZlBusSim::handle(SimServo& s, const char* op, uint64_t doneUs) {
+  char buf[SIM_CMD_MAX + 1];
+  int a, b;
+
+  if (strcmp(op, "PRAD") == 0) {
+    snprintf(buf, sizeof(buf), "#%03dP%04d!", s.id, (int)(position(s, doneUs) + 0.5f));
+    reply(buf, doneUs);
+  } else if (strcmp(op, "PRTV") == 0) {
+    updateThermal(s, doneUs);
+    bool moving = position(s, doneUs) != s.target;
+    int mv = cfg_.voltageMv - (moving ? cfg_.voltageSagMv : 0);
+    snprintf(buf, sizeof(buf), "#%03dV%04dT%03d!", s.id, mv, (int)(s.temp + 0.5f));
+    reply(buf, doneUs);
+  } else if (strcmp(op, "PVER") == 0) {
+    snprintf(buf, sizeof(buf), "#%03dPV%s!", s.id, SIM_VERSION);
+    reply(buf, doneUs);
+  } else if (strcmp(op, "PMOD") == 0) {
+    snprintf(buf, sizeof(buf), "#%03dPMOD%d!", s.id, s.mode);
+    reply(buf, doneUs);
+  } else if (sscanf(op, "PMOD%d", &a) == 1 && a >= 1 && a <= 8) {
+    s.mode = (uint8_t)a;
+    snprintf(buf, sizeof(buf), "#%03dP!", s.id);
+    reply(buf, doneUs);
+  } else if (sscanf(op, "PID%d", &a) == 1 && a >= 0 && a < SIM_BROADCAST_ID) {
+    s.id = (uint8_t)a;
+    snprintf(buf, sizeof(buf), "#%03dP!", s.id);
+    reply(buf, doneUs);
+  } else if (strcmp(op, "PDST") == 0 || strcmp(op, "PULK") == 0) {
+    updateThermal(s, doneUs);
+    s.from = s.target = position(s, doneUs);
+    s.moveUs = 0;
+    if (op[1] == 'U') s.torque = false;
+  } else if (strcmp(op, "PULR") == 0) {
+    s.torque = true;
+  } else if (sscanf(op, "P%4dT%4d", &a, &b) == 2) {
+    if (!s.torque) return;  // 釋力狀態不響應運動指令
+    updateThermal(s, doneUs);
+    float target = (float)(a < 0 ? 0 : (a > SIM_POS_MAX ? SIM_POS_MAX : a));
+    float from = position(s, doneUs);
+    uint64_t minUs = cfg_.maxSpeed > 0.0f ? (uint64_t)(fabsf(target - from) / cfg_.maxSpeed * 1e6f) : 0;
+    uint64_t us = (uint64_t)b * 1000ULL;
+    s.from = from;
+    s.target = target;
+    s.moveStartUs = doneUs;
+    s.moveUs = us > minUs ? us : minUs;
+    if (s.moveUs == 0) s.from = target;
+  } else {
+    stats_.unknown++;
+  }
+}
+
+// 一階熱模型：運動時趨近 ambient + heat，靜止時回落到 ambient；跨越運動結束點時分段積分
+void ZlBusSim::updateThermal(SimServo& s, uint64_t nowUs) {
+  uint64_t t = s.thermalAtUs;
+  uint64_t moveEnd = s.moveStartUs + s.moveUs;
+  while (t < nowUs) {
+    bool moving = s.moveUs > 0 && t >= s.moveStartUs && t < moveEnd;
+    uint64_t segEnd = nowUs;
+    if (moving && moveEnd < segEnd) segEnd = moveEnd;
+    if (!moving && s.moveUs > 0 && t < s.moveStartUs && s.moveStartUs < segEnd) segEnd = s.moveStartUs;
+    float steady = cfg_.ambientTemp + (moving ? cfg_.heatTemp : 0.0f);
+    float dt = (float)(segEnd - t) / 1e6f;
+    s.temp += (steady - s.temp) * (1.0f - expf(-dt / cfg_.thermalTau));
+    t = segEnd;
+  }
+  s.thermalAtUs = nowUs;
+}
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file zl_servo_sim.h
+ * @brief ZL 總線舵機模擬器：以 #IDP...! 協議回應，供無實體舵機的測試與基準量測
+ * @details 模擬一條半雙工總線上的多顆舵機：
+ *          - 線路時序：每位元組 10 bit（8N1）依波特率佔用總線，請求與回覆共用同一線路
+ *          - 線路碰撞：主機在舵機回覆期間送出的位元組與回覆重疊，兩邊都損毀
+ *            （重疊的回覆位元組改為 0xFF，該筆主機指令整筆丟棄），因此查詢必須等回覆結束才能送出
+ *          - 回覆延遲：收完 '!' 後經 replyLatencyUs（+ 0..jitter）才開始回覆
+ *          - 位置動態：P####T#### 以線性插值移動，速度受 maxSpeed 限制；PDST 凍結於目前位置
+ *          - 溫度：運動時向 ambient + heat 趨近、靜止時回落（一階，時間常數 thermalTau）
+ *          - 故障注入：依機率丟棄或損毀（改寫一個位元組）回覆，亦可讓指定 ID 失聯
+ *          時間一律由呼叫端以微秒傳入，模擬器本身不讀時鐘，因此在虛擬時鐘下完全可重現。
+ *
+ *          支援指令（ID 為三位數，255 = 廣播）：
+ *            PRAD → #IDPxxxx!        PRTV → #IDVxxxxTxxx!     PVER → #IDPV<版本>!
+ *            PMOD → #IDPMODn!        PMODn → #IDP!            PIDnnn → #nnnP!
+ *            PDST / PULK / PULR / P####T####：無回覆
+ *          多條指令可連續送出；{#..!#..!} 群組內的指令先暫存，收到 '}' 時以同一時刻一起執行
+ *          （多軸同步起動）。位置刻度與固件相同（0-1000 對應 0-270 度）。
+ */
+
+#ifndef ZL_SERVO_SIM_H
+#define ZL_SERVO_SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SIM_MAX_SERVOS      8
+#define SIM_CMD_MAX         32        // 單一 #...! 指令最大長度（超過即丟棄）
+#define SIM_GROUP_MAX       8         // {...} 群組內最多指令數（超過即丟棄）
+#define SIM_OUT_QUEUE       1024      // 待送出回覆位元組上限
+#define SIM_POS_MAX         1000
+#define SIM_BROADCAST_ID    255
+#define SIM_VERSION         "ZLSIM1.0"
+
+struct SimConfig {
+  uint32_t baud;              // 總線波特率（決定每位元組佔線時間）
+  uint32_t replyLatencyUs;    // 收完指令到開始回覆的延遲
+  uint32_t replyJitterUs;     // 延遲額外隨機增加 0..jitter
+  float maxSpeed;             // 最大速度（位置單位/秒）
+  float ambientTemp;          // 環境溫度（°C）
+  float heatTemp;             // 持續運動時的穩態溫升（°C）
+  float thermalTau;           // 溫度時間常數（秒）
+  uint16_t voltageMv;         // 靜止電壓（mV）
+  uint16_t voltageSagMv;      // 運動時電壓下降（mV）
+  float dropRate;             // 回覆遺失機率（0-1）
+  float garbleRate;           // 回覆損毀機率（0-1）
+  uint32_t seed;              // 亂數種子（抖動與故障注入）
+};
+
+// 預設值：115200 bps、回覆延遲 300 µs、無故障
+SimConfig simDefaultConfig();
+
+struct SimServo {
+  uint8_t id;
+  uint8_t mode;               // PMOD 工作模式（1-8）
+  bool torque;                // PULK 釋放 / PULR 恢復
+  bool offline;               // 故障注入：不回應任何指令
+  float from;                 // 目前運動起點（位置單位）
+  float target;
+  uint64_t moveStartUs;
+  uint64_t moveUs;            // 0 = 靜止
+  float temp;                 // °C
+  uint64_t thermalAtUs;       // 溫度最近一次更新時間
+};
+
+// 統計（供基準與測試判斷）
+struct SimStats {
+  uint32_t commands;          // 完整解析的指令數
+  uint32_t unknown;           // 無法辨識或格式錯誤的指令
+  uint32_t replies;           // 排入佇列的回覆數
+  uint32_t dropped;           // 故障注入丟棄的回覆
+  uint32_t garbled;           // 故障注入損毀的回覆
+  uint32_t overflow;          // 回覆佇列滿而捨棄的位元組
+  uint32_t collisions;        // 主機位元組與回覆重疊的次數（每個重疊的主機位元組計一次）
+};
+
+class ZlBusSim {
+ public:
+  explicit ZlBusSim(const SimConfig& cfg);
+
+  // 新增一顆舵機（初始位置 pos）；超過 SIM_MAX_SERVOS 返回 NULL
+  SimServo* addServo(uint8_t id, uint16_t pos = SIM_POS_MAX / 2);
+  SimServo* servo(uint8_t id);
+
+  // 主機（固件）在 nowUs 寫出一個位元組：依線路時序計算實際到達時間
+  void receive(uint8_t b, uint64_t nowUs);
+
+  // 取出 nowUs 前已完整送達主機的回覆位元組，返回個數
+  size_t transmit(uint64_t nowUs, uint8_t* out, size_t max);
+
+  // 下一個回覆位元組的送達時間；無待送資料返回 UINT64_MAX
+  uint64_t nextTxUs() const;
+
+  // 舵機在 nowUs 的位置（位置單位）
+  float position(const SimServo& s, uint64_t nowUs) const;
+
+  const SimStats& stats() const { return stats_; }
+  SimConfig& config() { return cfg_; }
+
+ private:
+  void execute(const char* cmd, uint64_t doneUs);
+  void handle(SimServo& s, const char* op, uint64_t doneUs);
+  void reply(const char* text, uint64_t doneUs);
+  void updateThermal(SimServo& s, uint64_t nowUs);
+  bool collide(uint64_t startUs, uint64_t endUs);
+  float random01();
+
+  SimConfig cfg_;
+  SimServo servos_[SIM_MAX_SERVOS];
+  uint8_t servoCount_;
+  uint32_t byteUs_;           // 每位元組線路時間
+  uint64_t hostFreeUs_;       // 主機送出的最後一個位元組傳完的時間
+  uint64_t wireFreeUs_;       // 已排定回覆佔用線路的結束時間（多顆舵機回覆依序排隊）
+  uint64_t rxDoneUs_;         // 目前指令最後一個位元組到達時間
+  char cmd_[SIM_CMD_MAX + 1];
+  uint8_t cmdLen_;
+  bool inCmd_;
+  bool cmdBroken_;            // 目前指令有位元組碰撞損毀（收到 '!' 時丟棄）
+  char group_[SIM_GROUP_MAX][SIM_CMD_MAX + 1];
+  uint8_t groupCount_;
+  bool inGroup_;
+  uint8_t out_[SIM_OUT_QUEUE];
+  uint64_t outDue_[SIM_OUT_QUEUE];
+  size_t outHead_;
+  size_t outCount_;
+  uint32_t rng_;
+  SimStats stats_;
+};
+
+#endif // ZL_SERVO_SIM_H
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file zl_sim_link.h
+ * @brief 將模擬器接到固件 native 建置的總線埠（同一行程、記憶體串流）
+ * @details 在每次背景搬運結束時交換位元組：固件寫出的位元組以當下時間送入模擬器，
+ *          模擬器已送達的回覆注入總線接收端。配合 halNativeUseVirtualClock() 時整個
+ *          端到端流程（含線路時序與回覆延遲）完全可重現，適合在 CI 量測延遲與吞吐量。
+ *          需與 src/hal_native.cpp 一同以 -DPT2D_NATIVE -DPT2D_NATIVE_NO_MAIN 建置；
+ *          完整範例見 simtest/simtest_main.cpp（env:simtest）。
+ *
+ *          用法：
+ *            ZlBusSim sim(simDefaultConfig());
+ *            sim.addServo(DEFAULT_PAN_SERVO_ID); sim.addServo(DEFAULT_TILT_SERVO_ID);
+ *            halNativeUseVirtualClock();
+ *            halNativeUseMemory(HAL_PORT_PC);
+ *            simLinkAttach(sim);
+ *            setup();
+ */
+
+#ifndef ZL_SIM_LINK_H
+#define ZL_SIM_LINK_H
+
+#include "hal_native.h"
+#include "zl_servo_sim.h"
+
+static ZlBusSim* simLinkBus = NULL;
+
+static void simLinkPump() {
+  if (!simLinkBus) return;
+  uint64_t now = halMicros();
+  uint8_t buf[64];
+  size_t n;
+  while ((n = halNativeTake(HAL_PORT_BUS, buf, sizeof(buf))) > 0) {
+    for (size_t i = 0; i < n; i++) simLinkBus->receive(buf[i], now);
+  }
+  while ((n = simLinkBus->transmit(now, buf, sizeof(buf))) > 0) {
+    halNativeFeed(HAL_PORT_BUS, buf, n);
+  }
+}
+
+// 以記憶體串流連接總線埠並註冊搬運 hook（須在 setup() 之前呼叫）
+static inline void simLinkAttach(ZlBusSim& sim) {
+  simLinkBus = &sim;
+  halNativeUseMemory(HAL_PORT_BUS);
+  halNativeOnPump(simLinkPump);
+}
+
+#endif // ZL_SIM_LINK_H
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file zl_sim_main.cpp
+ * @brief 獨立模擬器程式（env:sim）：在偽終端上扮演 ZL 總線
+ * @details 啟動後印出從端路徑，native 固件以 --bus <路徑> 連接，實機 USB 轉 TTL
+ *          測試腳本亦可直接開啟。以實時時鐘運作；結束（Ctrl+C）時印出統計。
+ *
+ *          用法：zl_sim [--baud N] [--latency-us N] [--jitter-us N] [--drop P]
+ *                       [--garble P] [--seed N] [--servo ID[:POS]]... [--offline ID]...
+ *          未指定 --servo 時建立 ID 1（水平）與 ID 2（垂直），初始位置 500。
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "zl_servo_sim.h"
+
+#define SIM_POLL_MAX_MS     10
+
+static volatile sig_atomic_t stopRequested = 0;
+
+static void onSignal(int) { stopRequested = 1; }
+
+static uint64_t monotonicUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static int openPty() {
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0) return -1;
+  if (grantpt(fd) != 0 || unlockpt(fd) != 0) {
+    close(fd);
+    return -1;
+  }
+  struct termios tio;
+  if (tcgetattr(fd, &tio) == 0) {
+    cfmakeraw(&tio);
+    tcsetattr(fd, TCSANOW, &tio);
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  return fd;
+}
+
+static void usage(const char* prog) {
+  fprintf(stderr,
+          "usage: %s [--baud N] [--latency-us N] [--jitter-us N] [--drop P] [--garble P]\n"
+          "          [--seed N] [--servo ID[:POS]]... [--offline ID]...\n",
+          prog);
+}
+
+int main(int argc, char** argv) {
+  SimConfig cfg = simDefaultConfig();
+  int servoIds[SIM_MAX_SERVOS];
+  int servoPos[SIM_MAX_SERVOS];
+  int servoCount = 0;
+  int offlineIds[SIM_MAX_SERVOS];
+  int offlineCount = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const char* opt = argv[i];
+    const char* val = i + 1 < argc ? argv[i + 1] : NULL;
+    if (!val) { usage(argv[0]); return 2; }
+    i++;
+    if (strcmp(opt, "--baud") == 0) {
+      cfg.baud = (uint32_t)strtoul(val, NULL, 10);
+    } else if (strcmp(opt, "--latency-us") == 0) {
+      cfg.replyLatencyUs = (uint32_t)strtoul(val, NULL, 10);
+    } else if (strcmp(opt, "--jitter-us") == 0) {
+      cfg.replyJitterUs = (uint32_t)strtoul(val, NULL, 10);
+    } else if (strcmp(opt, "--drop") == 0) {
+      cfg.dropRate = (float)atof(val);
+    } else if (strcmp(opt, "--garble") == 0) {
+      cfg.garbleRate = (float)atof(val);
+    } else if (strcmp(opt, "--seed") == 0) {
+      cfg.seed = (uint32_t)strtoul(val, NULL, 10);
+    } else if (strcmp(opt, "--servo") == 0 && servoCount < SIM_MAX_SERVOS) {
+      const char* colon = strchr(val, ':');
+      servoIds[servoCount] = atoi(val);
+      servoPos[servoCount] = colon ? atoi(colon + 1) : SIM_POS_MAX / 2;
+      servoCount++;
+    } else if (strcmp(opt, "--offline") == 0 && offlineCount < SIM_MAX_SERVOS) {
+      offlineIds[offlineCount++] = atoi(val);
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  ZlBusSim sim(cfg);
+  if (servoCount == 0) {
+    sim.addServo(1);
+    sim.addServo(2);
+  }
+  for (int i = 0; i < servoCount; i++) sim.addServo((uint8_t)servoIds[i], (uint16_t)servoPos[i]);
+  for (int i = 0; i < offlineCount; i++) {
+    SimServo* s = sim.servo((uint8_t)offlineIds[i]);
+    if (s) s->offline = true;
+  }
+
+  int fd = openPty();
+  if (fd < 0) { perror("posix_openpt"); return 1; }
+  fprintf(stderr, "Bus port: %s\n", ptsname(fd));
+
+  signal(SIGINT, onSignal);
+  signal(SIGTERM, onSignal);
+
+  const uint64_t startUs = monotonicUs();
+  uint8_t buf[256];
+  while (!stopRequested) {
+    uint64_t now = monotonicUs() - startUs;
+
+    // 睡到下一個回覆位元組到期或有輸入為止
+    int timeoutMs = SIM_POLL_MAX_MS;
+    uint64_t due = sim.nextTxUs();
+    if (due != UINT64_MAX) timeoutMs = due > now ? (int)((due - now + 999) / 1000) : 0;
+    if (timeoutMs > SIM_POLL_MAX_MS) timeoutMs = SIM_POLL_MAX_MS;
+    struct pollfd pfd = {fd, POLLIN, 0};
+    poll(&pfd, 1, timeoutMs);
+
+    now = monotonicUs() - startUs;
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+      for (ssize_t i = 0; i < n; i++) sim.receive(buf[i], now);
+    }
+    if (n < 0 && errno == EIO) usleep(SIM_POLL_MAX_MS * 1000);  // 從端尚未開啟
+
+    size_t out;
+    while ((out = sim.transmit(now, buf, sizeof(buf))) > 0) {
+      if (write(fd, buf, out) < 0 && errno != EAGAIN) break;
+    }
+  }
+
+  const SimStats& st = sim.stats();
+  fprintf(stderr, "commands=%u unknown=%u replies=%u dropped=%u garbled=%u overflow=%u collisions=%u\n",
+          (unsigned)st.commands, (unsigned)st.unknown, (unsigned)st.replies,
+          (unsigned)st.dropped, (unsigned)st.garbled, (unsigned)st.overflow, (unsigned)st.collisions);
+  close(fd);
+  return 0;
+}
@@ -0,0 +1,501 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file simtest_main.cpp
+ * @brief 固件 + 總線舵機模擬器同行程端到端測試（env:simtest）
+ * @details 與 bench/ 相同直接編入 src/main.cpp（可檢查檔內 static 狀態），以 sim/zl_sim_link.h
+ *          把 ZlBusSim 接到記憶體總線埠，PC 埠亦改用記憶體串流，全程在虛擬時鐘下執行，
+ *          結果完全可重現。每個案例印出 ✅/❌，任一失敗時返回 1，可直接作為 CI 步驟：
+ *
+ *            pio run -e simtest && .pio/build/simtest/program
+ */
+
+#include "../src/main.cpp"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#include "zl_sim_link.h"
+
+#define SIMTEST_STEP_US   100       // 每次 loop() 之間推進的虛擬時間
+#define SIMTEST_PC_MAX    8192      // PC 輸出累積上限（每個案例開始前清空）
+
+static ZlBusSim sim(simDefaultConfig());
+static char pcText[SIMTEST_PC_MAX + 1];
+static size_t pcTextLen = 0;
+static int failures = 0;
+
+// ============================================
+// 輔助函數
+// ============================================
+
+static void check(bool ok, const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  printf("%s ", ok ? "✅" : "❌");
+  vprintf(fmt, ap);
+  printf("\n");
+  va_end(ap);
+  if (!ok) failures++;
+}
+
+static void title(const char* name) {
+  printf("\n============================================================\n");
+  printf("%s\n", name);
+  printf("============================================================\n");
+}
+
+static void collectPc() {
+  uint8_t buf[256];
+  size_t n;
+  while ((n = halNativeTake(HAL_PORT_PC, buf, sizeof(buf))) > 0) {
+    size_t room = SIMTEST_PC_MAX - pcTextLen;
+    if (n > room) n = room;
+    memcpy(pcText + pcTextLen, buf, n);
+    pcTextLen += n;
+  }
+  pcText[pcTextLen] = '\0';
+}
+
+static void clearPc() {
+  collectPc();
+  pcTextLen = 0;
+  pcText[0] = '\0';
+}
+
+static void stepOnce() {
+  halNativeAdvance(SIMTEST_STEP_US);
+  loop();
+  collectPc();
+}
+
+static void runMs(unsigned long ms) {
+  for (unsigned long i = 0; i < ms * 1000UL / SIMTEST_STEP_US; i++) stepOnce();
+}
+
+static void sendPc(const char* line) {
+  halNativeFeed(HAL_PORT_PC, (const uint8_t*)line, strlen(line));
+}
+
+// 執行到 PC 輸出出現 text；返回經過的虛擬時間（微秒），逾時返回 0
+static unsigned long waitPc(const char* text, unsigned long timeoutMs) {
+  unsigned long start = halMicros();
+  while (!strstr(pcText, text)) {
+    if (halMicros() - start > timeoutMs * 1000UL) return 0;
+    stepOnce();
+  }
+  return halMicros() - start;
+}
+
+// PC 輸出中 key 之後的整數（"key":123），找不到返回 fallback
+static long pcField(const char* key, long fallback) {
+  char pat[32];
+  snprintf(pat, sizeof(pat), "\"%s\":", key);
+  const char* p = strstr(pcText, pat);
+  return p ? strtol(p + strlen(pat), NULL, 10) : fallback;
+}
+
+// ============================================
+// 測試案例
+// ============================================
+
+// 開機：verifyServoPresence() 經模擬總線以電壓查詢確認兩顆舵機
+static void testBoot() {
+  title("測試 1: 開機驗證舵機 ID");
+  check(panServoId == DEFAULT_PAN_SERVO_ID && tiltServoId == DEFAULT_TILT_SERVO_ID,
+        "pan_id=%d tilt_id=%d", panServoId, tiltServoId);
+  check(!servoDisabled, "舵機控制已啟用");
+}
+
+// STATUS：四筆查詢經交易引擎送出，回覆欄位與模擬器一致；量測端到端延遲
+static void testStatus() {
+  title("測試 2: STATUS 聚合讀取");
+  clearPc();
+  sendPc("<STATUS>\n");
+  unsigned long us = waitPc("\"tilt_voltage\"", 1000);
+  check(us > 0, "STATUS 回覆，端到端延遲 %lu µs", us);
+  check(pcField("pan", -1) == SERVO_MAX_ANGLE / 2 && pcField("tilt", -1) == SERVO_MAX_ANGLE / 2,
+        "角度 pan=%ld tilt=%ld", pcField("pan", -1), pcField("tilt", -1));
+  check(pcField("pan_voltage", -1) == sim.config().voltageMv,
+        "電壓 %ld mV（模擬器 %u mV）", pcField("pan_voltage", -1), sim.config().voltageMv);
+}
+
+// 吞吐量：連續 1 秒逐一送出 STATUS，計算每秒完成數
+static void testThroughput() {
+  title("測試 3: STATUS 吞吐量（1 秒）");
+  unsigned long start = halMicros();
+  int done = 0;
+  while (halMicros() - start < 1000000UL) {
+    clearPc();
+    sendPc("<STATUS>\n");
+    if (!waitPc("\"tilt_voltage\"", 1000)) break;
+    done++;
+  }
+  check(done >= 50, "每秒完成 %d 次 STATUS（每次四筆總線查詢）", done);
+}
+
+// 舵機失聯：逾時後回報錯誤，不卡住後續命令
+static void testOffline() {
+  title("測試 4: 舵機失聯");
+  SimServo* tilt = sim.servo(DEFAULT_TILT_SERVO_ID);
+  tilt->offline = true;
+  clearPc();
+  sendPc("<STATUS>\n");
+  unsigned long us = waitPc("Bus read timeout", 1000);
+  check(us > 0, "逾時錯誤於 %lu µs 後回報（BUS_TXN_TIMEOUT %d ms）", us, BUS_TXN_TIMEOUT);
+  tilt->offline = false;
+  clearPc();
+  sendPc("<STATUS>\n");
+  check(waitPc("\"tilt_voltage\"", 1000) > 0, "恢復後 STATUS 正常");
+}
+
+// 半雙工碰撞：不等回覆連送兩筆查詢，第二筆與第一筆的回覆重疊，兩邊都損毀
+static void testCollision() {
+  title("測試 5: 總線碰撞模擬");
+  ZlBusSim bus(simDefaultConfig());
+  bus.addServo(DEFAULT_PAN_SERVO_ID);
+  bus.addServo(DEFAULT_TILT_SERVO_ID);
+  const char* burst = "#001PRAD!#002PRAD!";
+  for (const char* p = burst; *p; p++) bus.receive((uint8_t)*p, 0);
+  uint8_t out[64];
+  size_t n = bus.transmit(UINT64_MAX, out, sizeof(out));
+  check(bus.stats().collisions > 0 && bus.stats().commands == 1,
+        "連送兩筆：碰撞 %u 次，執行 %u 筆", bus.stats().collisions, bus.stats().commands);
+  check(n > 0 && memchr(out, 0xFF, n) != NULL, "第一筆回覆損毀（%u 位元組）", (unsigned)n);
+}
+
+// 角度 ↔ 位置換算：0..SERVO_MAX_ANGLE 每個角度轉位置再轉回都得到原角度
+static void testAngleRoundTrip() {
+  title("測試 6: 角度 / 位置換算往返");
+  int bad = 0;
+  int firstBad = -1;
+  for (int angle = 0; angle <= SERVO_MAX_ANGLE; angle++) {
+    if (positionToAngle(angleToPosition(angle)) != angle) {
+      if (firstBad < 0) firstBad = angle;
+      bad++;
+    }
+  }
+  check(bad == 0, "%d/%d 個角度往返不一致（第一個 %d）", bad, SERVO_MAX_ANGLE + 1, firstBad);
+  check(angleToPosition(SERVO_MAX_ANGLE) == 1000 && positionToAngle(1000) == SERVO_MAX_ANGLE,
+        "滿刻度 %d° ↔ 1000", SERVO_MAX_ANGLE);
+}
+
+// MOVE 後由總線讀回：讀回角度與指令一致，校正後的位置模型不漂移
+static void testMoveVerify() {
+  title("測試 7: MOVE 後 POS:VERIFY 讀回");
+  clearPc();
+  sendPc("<MOVE:200,120>\n");
+  runMs(3000);
+  clearPc();
+  sendPc("<POS:VERIFY>\n");
+  waitPc("\"tilt\"", 1000);
+  check(pcField("pan", -1) == 200 && pcField("tilt", -1) == 120,
+        "總線讀回 pan=%ld tilt=%ld（指令 200,120）", pcField("pan", -1), pcField("tilt", -1));
+  runMs(UPDATE_INTERVAL);
+  clearPc();
+  sendPc("<POS>\n");
+  waitPc("\"moving\"", 100);
+  check(pcField("pan", -1) == 200 && pcField("tilt", -1) == 120,
+        "校正後模型 pan=%ld tilt=%ld", pcField("pan", -1), pcField("tilt", -1));
+}
+
+// 軌跡規劃軌跡統計（每次 loop() 後取樣設定點）
+struct TrajTrace {
+  float maxVel[AXIS_COUNT];   // |vel| 最大值
+  float maxStep[AXIS_COUNT];  // 相鄰設定點最大位移
+  float lastStep[AXIS_COUNT]; // 最後一次位移（到達目標的那一步）
+  bool reversed[AXIS_COUNT];  // 出現與 dir 相反的位移
+};
+
+// read 不為 NULL 時，每次讀取完成（STATUS 回覆或逾時錯誤）後立即再送一次 read，reads 計數完成的讀取
+static void traceRun(unsigned long ms, const int dir[AXIS_COUNT], TrajTrace& tr, const char* read = NULL,
+                     int* reads = NULL) {
+  if (read) {
+    clearPc();
+    sendPc(read);
+  }
+  for (unsigned long n = 0; n < ms * 1000UL / SIMTEST_STEP_US; n++) {
+    if (read && (strstr(pcText, "\"tilt_voltage\"") || strstr(pcText, "Bus read timeout"))) {
+      (*reads)++;
+      clearPc();
+      sendPc(read);
+    }
+    float before[AXIS_COUNT];
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) before[i] = axes[i].pos;
+    stepOnce();
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+      float step = axes[i].pos - before[i];
+      if (fabs(axes[i].vel) > tr.maxVel[i]) tr.maxVel[i] = fabs(axes[i].vel);
+      if (step == 0.0f) continue;
+      if (fabs(step) > tr.maxStep[i]) tr.maxStep[i] = fabs(step);
+      if (step * dir[i] < 0.0f) tr.reversed[i] = true;
+      tr.lastStep[i] = step;
+    }
+  }
+}
+
+// 檢查一段運動：速度不超過 vmax、不反向、最後一步不跳動、停在目標上
+static void checkTrace(const char* name, const TrajTrace& tr, const int target[AXIS_COUNT]) {
+  static const char* const AXIS_NAMES[AXIS_COUNT] = { "pan", "tilt" };
+  const float vmaxFull[AXIS_COUNT] = { TRAJ_MAX_VEL_PAN, TRAJ_MAX_VEL_TILT };
+  const float dt = UPDATE_INTERVAL / 1000.0f;
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    float vmax = vmaxFull[i] * moveSpeed / 100.0f;
+    float limit = vmax * dt * 1.001f;
+    check(tr.maxVel[i] <= vmax * 1.001f && tr.maxStep[i] <= limit,
+          "%s %s: 最大速度 %.2f °/s、最大步距 %.3f°（vmax %.0f °/s，vmax·dt %.3f°）",
+          name, AXIS_NAMES[i], tr.maxVel[i], tr.maxStep[i], vmax, vmax * dt);
+    check(!tr.reversed[i], "%s %s: 設定點不反向", name, AXIS_NAMES[i]);
+    check(fabs(tr.lastStep[i]) <= limit && axes[i].pos == (float)target[i] && axes[i].vel == 0.0f,
+          "%s %s: 停在 %.3f（目標 %d），最後一步 %.4f°", name, AXIS_NAMES[i], axes[i].pos, target[i],
+          fabs(tr.lastStep[i]));
+  }
+}
+
+// S 曲線：SPEED 50 下 135,135 → 200,40，以及運動中途改為 180,100
+static void testTrajectory() {
+  title("測試 8: 軌跡規劃（SPEED 50）");
+  sendPc("<MOVE:135,135>\n");
+  runMs(3000);
+  sendPc("<SPEED:50>\n");
+  runMs(10);
+
+  const int dir[AXIS_COUNT] = { 1, -1 };
+  const int target[AXIS_COUNT] = { 200, 40 };
+  TrajTrace tr = {};
+  sendPc("<MOVE:200,40>\n");
+  traceRun(3000, dir, tr);
+  checkTrace("200,40", tr, target);
+
+  sendPc("<MOVE:135,135>\n");
+  runMs(3000);
+  const int retarget[AXIS_COUNT] = { 180, 100 };
+  TrajTrace tr2 = {};
+  sendPc("<MOVE:200,40>\n");
+  traceRun(400, dir, tr2);
+  sendPc("<MOVE:180,100>\n");
+  traceRun(3000, dir, tr2);
+  checkTrace("中途改 180,100", tr2, retarget);
+
+  runMs(UPDATE_INTERVAL * 2);
+  check(fabs(sim.position(*sim.servo(DEFAULT_PAN_SERVO_ID), halMicros()) - angleToPosition(180)) <= 1.0f &&
+        fabs(sim.position(*sim.servo(DEFAULT_TILT_SERVO_ID), halMicros()) - angleToPosition(100)) <= 1.0f,
+        "模擬舵機停在目標刻度");
+
+  // 運動中連續讀取：設定點與查詢交錯；讀不存在的 ID 時每筆查詢等到逾時，
+  // 暫存區滿的期間（含 pan 到達終點）設定點延後而不遺失
+  sendPc("<MOVE:135,135>\n");
+  runMs(3000);
+  unsigned collisions = sim.stats().collisions;
+  int reads = 0;
+  TrajTrace tr3 = {};
+  sendPc("<MOVE:200,40>\n");
+  traceRun(300, dir, tr3, "<STATUS>\n", &reads);
+  traceRun(1200, dir, tr3, "<READANGLE:9>\n", &reads);
+  traceRun(1500, dir, tr3, "<STATUS>\n", &reads);
+  checkTrace("讀取中 200,40", tr3, target);
+  runMs(UPDATE_INTERVAL * 2);
+  check(reads > 0 && sim.stats().collisions == collisions, "運動中完成 %d 次讀取，總線碰撞 %u 次", reads,
+        sim.stats().collisions - collisions);
+  check(fabs(sim.position(*sim.servo(DEFAULT_PAN_SERVO_ID), halMicros()) - angleToPosition(200)) < 0.5f &&
+        fabs(sim.position(*sim.servo(DEFAULT_TILT_SERVO_ID), halMicros()) - angleToPosition(40)) < 0.5f,
+        "模擬舵機收到最後設定點（pan %.1f tilt %.1f）", sim.position(*sim.servo(DEFAULT_PAN_SERVO_ID), halMicros()),
+        sim.position(*sim.servo(DEFAULT_TILT_SERVO_ID), halMicros()));
+  sendPc("<SPEED:100>\n");
+  runMs(10);
+}
+
+// 運動中讀取：MOVE 的設定點串流與 STATUS / POS:VERIFY 查詢共用總線，運動幀不得壓在回覆上
+static void testReadDuringMove() {
+  title("測試 9: 運動中讀取（STATUS / POS:VERIFY）");
+  unsigned collisions = sim.stats().collisions;
+  sendPc("<MOVE:60,160>\n");
+  unsigned long start = halMicros();
+  int tries = 0;
+  int done = 0;
+  for (; halMicros() - start < 1000000UL; tries++) {
+    bool status = tries % 2 == 0;
+    clearPc();
+    sendPc(status ? "<STATUS>\n" : "<POS:VERIFY>\n");
+    if (waitPc(status ? "\"tilt_voltage\"" : "\"tilt\"", 1000) && !strstr(pcText, "error")) done++;
+  }
+  check(done == tries, "運動中 %d/%d 次讀取成功", done, tries);
+  check(sim.stats().collisions == collisions, "運動中總線碰撞 %u 次", sim.stats().collisions - collisions);
+  runMs(3000);
+  check(axisAngle(axes[AXIS_PAN]) == 60 && axisAngle(axes[AXIS_TILT]) == 160, "運動完成於 %d,%d",
+        axisAngle(axes[AXIS_PAN]), axisAngle(axes[AXIS_TILT]));
+}
+
+// 模擬舵機目前角度（由位置刻度換算）
+static float simAngle(uint8_t id) {
+  return sim.position(*sim.servo(id), halMicros()) * SERVO_MAX_ANGLE / 1000.0f;
+}
+
+// 追蹤中讀取：以 30 fps 送入模擬舵機與固定目標的像素誤差，同時連續 STATUS；
+// 每 TRACK_INTERVAL 的設定點須與查詢交錯，讀取全部成功且雲台收斂到目標
+static void testTrackWithStatus() {
+  title("測試 10: TRACK 追蹤中 STATUS");
+  const float goal[AXIS_COUNT] = { 160.0f, 110.0f };
+  const float degPerPx = TRACK_MDEG_PER_PX / 1000.0f;
+  unsigned collisions = sim.stats().collisions;
+  int tries = 0;
+  int done = 0;
+  unsigned long start = halMicros();
+  unsigned long nextFrame = start;
+  clearPc();
+  while (halMicros() - start < 2000000UL) {
+    if ((long)(halMicros() - nextFrame) >= 0) {
+      char line[40];
+      int ex = (int)((goal[AXIS_PAN] - simAngle(DEFAULT_PAN_SERVO_ID)) / degPerPx);
+      int ey = TRACK_TILT_SIGN * (int)((goal[AXIS_TILT] - simAngle(DEFAULT_TILT_SERVO_ID)) / degPerPx);
+      snprintf(line, sizeof(line), "<TRACK:%d,%d,0>\n", ex, ey);
+      sendPc(line);
+      nextFrame += 33000UL;
+    }
+    bool ok = strstr(pcText, "\"tilt_voltage\"") != NULL;
+    if (tries == 0 || ok || strstr(pcText, "Bus ")) {
+      if (ok) done++;
+      clearPc();
+      sendPc("<STATUS>\n");
+      tries++;
+    }
+    stepOnce();
+  }
+  sendPc("<TRACK:OFF>\n");
+  runMs(50);
+  check(done >= tries - 1, "追蹤中 %d/%d 次 STATUS 成功", done, tries - 1);
+  check(sim.stats().collisions == collisions, "追蹤中總線碰撞 %u 次", sim.stats().collisions - collisions);
+  check(fabs(simAngle(DEFAULT_PAN_SERVO_ID) - goal[AXIS_PAN]) < 1.0f &&
+        fabs(simAngle(DEFAULT_TILT_SERVO_ID) - goal[AXIS_TILT]) < 1.0f,
+        "收斂到 %.1f,%.1f（目標 %.0f,%.0f）", simAngle(DEFAULT_PAN_SERVO_ID), simAngle(DEFAULT_TILT_SERVO_ID),
+        goal[AXIS_PAN], goal[AXIS_TILT]);
+}
+
+// 遙測推送統計：推送行數與含逾時欄位（-1）的行數
+struct TelemetryCount {
+  int frames;
+  int missing;
+};
+
+// 執行 ms 毫秒，逐行統計遙測推送（PC 輸出可能超過 SIMTEST_PC_MAX，完整的行處理後即移除）
+static void countTelemetry(unsigned long ms, TelemetryCount& tc) {
+  for (unsigned long n = 0; n < ms * 1000UL / SIMTEST_STEP_US; n++) {
+    stepOnce();
+    char* end;
+    while ((end = strchr(pcText, '\n')) != NULL) {
+      *end = '\0';
+      if (strstr(pcText, "\"tm\"")) {
+        tc.frames++;
+        if (strstr(pcText, ":-1")) tc.missing++;
+      }
+      pcTextLen -= end + 1 - pcText;
+      memmove(pcText, end + 1, pcTextLen + 1);
+    }
+  }
+}
+
+// 運動中遙測：SUBSCRIBE:ALL,20 的 PRAD/PRTV 與軌跡設定點 / 直接模式運動幀交錯，推送不得有逾時欄位
+static void testTelemetryDuringMove() {
+  title("測試 11: 運動中遙測訂閱（SUBSCRIBE:ALL,20）");
+  unsigned collisions = sim.stats().collisions;
+  clearPc();
+  sendPc("<SUBSCRIBE:ALL,20>\n");
+  TelemetryCount traj = {};
+  sendPc("<MOVE:60,160>\n");
+  countTelemetry(2500, traj);
+  check(traj.frames >= 100 && traj.missing == 0, "軌跡運動中推送 %d 筆，含 -1 欄位 %d 筆", traj.frames,
+        traj.missing);
+
+  TelemetryCount direct = {};
+  sendPc("<TRAJ:OFF>\n");
+  sendPc("<MOVE:200,60>\n");
+  countTelemetry(1500, direct);
+  sendPc("<TRAJ:ON>\n");
+  check(direct.frames >= 60 && direct.missing == 0, "直接模式運動中推送 %d 筆，含 -1 欄位 %d 筆",
+        direct.frames, direct.missing);
+
+  sendPc("<SUBSCRIBE:OFF>\n");
+  runMs(50);
+  check(sim.stats().collisions == collisions, "遙測期間總線碰撞 %u 次", sim.stats().collisions - collisions);
+  check(fabs(simAngle(DEFAULT_PAN_SERVO_ID) - 200.0f) < 1.0f && fabs(simAngle(DEFAULT_TILT_SERVO_ID) - 60.0f) < 1.0f,
+        "運動完成於 %.1f,%.1f", simAngle(DEFAULT_PAN_SERVO_ID), simAngle(DEFAULT_TILT_SERVO_ID));
+}
+
+// 總線透傳：無對應交易的回覆以完整一行轉給 PC，損毀（含非可列印字元）的回覆整段丟棄
+static void testPassthrough() {
+  title("測試 12: 總線回覆透傳");
+  clearPc();
+  sendPc("<RAW:#001PRAD!>\n");
+  waitPc("!\r\n", 100);
+  check(strncmp(pcText, "#001P", 5) == 0 && strstr(pcText, "!\r\n") != NULL, "RAW 讀取回覆為一行：%.*s",
+        (int)strcspn(pcText, "\r\n"), pcText);
+
+  clearPc();
+  const char noise[] = "#001P15\xFF" "0!#001P!";
+  halNativeFeed(HAL_PORT_BUS, (const uint8_t*)noise, sizeof(noise) - 1);
+  runMs(5);
+  check(strcmp(pcText, "#001P!\r\n") == 0 && !strchr(pcText, '\xFF'), "損毀回覆丟棄、確認幀一行透傳");
+
+  clearPc();
+  sendPc("<STATUS>\n");
+  halNativeFeed(HAL_PORT_BUS, (const uint8_t*)noise, sizeof(noise) - 1);
+  check(waitPc("\"tilt_voltage\"", 1000) > 0 && strncmp(pcText, "#001P!\r\n{", 9) == 0 && !strchr(pcText, '\xFF'),
+        "查詢期間的雜訊不插入 JSON 行");
+}
+
+// CONFIGSERVO：只接一顆舵機時以廣播修改 ID（放在最後：會改變模擬器上的 ID）
+static void testConfigServo() {
+  title("測試 13: CONFIGSERVO 修改舵機 ID");
+  sim.servo(DEFAULT_TILT_SERVO_ID)->offline = true;
+  clearPc();
+  sendPc("<CONFIGSERVO:5>\n");
+  check(waitPc("舵機硬件ID配置命令已發送", 2000) > 0, "收到舵機確認");
+  check(sim.servo(5) != NULL && sim.servo(DEFAULT_PAN_SERVO_ID) == NULL, "模擬器舵機 ID 已改為 5");
+}
+
+int main() {
+  setvbuf(stdout, NULL, _IONBF, 0);
+  sim.addServo(DEFAULT_PAN_SERVO_ID);
+  sim.addServo(DEFAULT_TILT_SERVO_ID);
+
+  halNativeUseVirtualClock();
+  halNativeUseMemory(HAL_PORT_PC);
+  simLinkAttach(sim);
+  setup();
+  runMs(100);
+
+  testBoot();
+  testStatus();
+  testThroughput();
+  testOffline();
+  testCollision();
+  testAngleRoundTrip();
+  testMoveVerify();
+  testTrajectory();
+  testReadDuringMove();
+  testTrackWithStatus();
+  testTelemetryDuringMove();
+  testPassthrough();
+  testConfigServo();
+
+  const SimStats& st = sim.stats();
+  printf("\n模擬器統計：指令 %u、回覆 %u、無法辨識 %u、線路碰撞 %u\n", st.commands, st.replies, st.unknown,
+         st.collisions);
+  check(st.collisions == 0, "固件總線流量無碰撞（BUS_TXN_WINDOW %d）", BUS_TXN_WINDOW);
+  printf("%s\n", failures == 0 ? "全部測試通過" : "有測試失敗");
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file hal_avr.cpp
+ * @brief 硬體抽象層 AVR 後端（env:uno / env:nano）
+ * @details PC 走硬體 UART（Serial）；總線在 UNO/Nano 為 SoftwareSerial，Mega 為 Serial1。
+ *          背景搬運由 Timer2 比較匹配中斷驅動（會佔用 D3/D11 的 PWM 與 tone()）。
+ */
+
+#if defined(ARDUINO_ARCH_AVR)
+
+#include <Arduino.h>
+#include <avr/wdt.h>
+#include <avr/interrupt.h>
+#include "config.h"
+#include "hal.h"
+
+#if !defined(__AVR_ATmega2560__)
+#include <SoftwareSerial.h>
+SoftwareSerial BUS_SERIAL(SERVO_TX_PIN, SERVO_RX_PIN);
+#else
+#define BUS_SERIAL Serial1
+#endif
+
+static void (*pumpFn)() = NULL;
+
+// ============================================
+// 串口
+// ============================================
+
+void halSerialBegin(uint8_t port, unsigned long baud) {
+  if (port == HAL_PORT_PC) Serial.begin(baud);
+  else BUS_SERIAL.begin(baud);
+}
+
+int halSerialRead(uint8_t port) {
+  if (port == HAL_PORT_PC) return Serial.available() ? Serial.read() : -1;
+  return BUS_SERIAL.available() ? BUS_SERIAL.read() : -1;
+}
+
+// 只寫驅動緩衝區容得下的量，不忙等
+uint8_t halSerialWriteRoom(uint8_t port) {
+  if (port == HAL_PORT_PC) return (uint8_t)Serial.availableForWrite();
+#if defined(__AVR_ATmega2560__)
+  return (uint8_t)BUS_SERIAL.availableForWrite();
+#else
+  return BUS_TX_BURST;  // SoftwareSerial 逐位元組忙等傳送，限制每次數量
+#endif
+}
+
+Print& halSerialPort(uint8_t port) {
+  if (port == HAL_PORT_PC) return Serial;
+  return BUS_SERIAL;
+}
+
+// ============================================
+// 時鐘 / GPIO / 看門狗
+// ============================================
+
+unsigned long halMillis() { return millis(); }
+unsigned long halMicros() { return micros(); }
+
+void halPinMode(uint8_t pin, uint8_t mode) { pinMode(pin, mode); }
+void halDigitalWrite(uint8_t pin, uint8_t level) { digitalWrite(pin, level); }
+int halDigitalRead(uint8_t pin) { return digitalRead(pin); }
+
+void halWatchdogEnable() { wdt_enable(WDTO_2S); }
+void halWatchdogDisable() { wdt_disable(); }
+void halWatchdogReset() { wdt_reset(); }
+
+// 開機最早階段（.init3，早於 .bss 清零與建構函數）保存並清除 MCUSR、關閉看門狗，
+// 避免看門狗重置後在初始化期間再次觸發。optiboot 會先清除 MCUSR，原值改由 r2 傳入。
+// （舊版 optiboot 在外部重置後以看門狗跳入應用程式，外部重置可能被報告為 watchdog）
+static uint8_t resetFlags __attribute__((section(".noinit")));
+
+void halSaveResetFlags() __attribute__((naked, used, section(".init3")));
+void halSaveResetFlags() {
+  uint8_t r2;
+  __asm__ __volatile__("mov %0, r2" : "=r"(r2));
+  resetFlags = MCUSR ? MCUSR : r2;
+  MCUSR = 0;
+  wdt_disable();
+}
+
+uint8_t halResetCause() {
+  return resetFlags & (_BV(PORF) | _BV(EXTRF) | _BV(BORF) | _BV(WDRF));
+}
+
+// ============================================
+// 背景搬運（Timer2）
+// ============================================
+
+// Timer2 比較匹配中斷：以 RX_PUMP_HZ 頻率執行搬運
+// ISR_NOBLOCK 允許 UART / SoftwareSerial 接收中斷搶佔，避免位元時序被拖延
+ISR(TIMER2_COMPA_vect, ISR_NOBLOCK) {
+  static volatile boolean busy = false;
+  if (busy || !pumpFn) return;  // 上一次搬運尚未結束
+  busy = true;
+  pumpFn();
+  busy = false;
+}
+
+// Timer2 設為 CTC 模式、64 分頻
+void halStartPump(void (*fn)()) {
+  HalAtomic lock;
+  pumpFn = fn;
+  TCCR2A = _BV(WGM21);
+  TCCR2B = _BV(CS22);
+  TCNT2 = 0;
+  OCR2A = (uint8_t)(F_CPU / 64 / RX_PUMP_HZ - 1);
+  TIMSK2 = _BV(OCIE2A);
+}
+
+void halIdle() {}
+
+// 臨界區：保存 SREG 後關中斷，離開時恢復（等同 ATOMIC_RESTORESTATE）
+HalAtomic::HalAtomic() : saved_(SREG) { cli(); }
+HalAtomic::~HalAtomic() { SREG = saved_; }
+
+#endif // ARDUINO_ARCH_AVR
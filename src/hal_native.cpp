@@ -0,0 +1,396 @@
+/*
+ * Copyright 2025 Arduino PT2D Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/**
+ * @file hal_native.cpp
+ * @brief 硬體抽象層 native 後端（env:native，Linux / POSIX）
+ * @details 單執行緒模擬中斷：每次讀取時鐘或 halIdle() 時，若已跨過搬運週期
+ *          （1/RX_PUMP_HZ）就地呼叫搬運函數，等同 Timer2 中斷在該處搶佔主迴圈。
+ *          搬運只操作 SPSC 環形緩衝區與傳送佇列，本來就允許在任意位置搶佔，
+ *          而單執行緒不需考慮主機的記憶體序問題。HalAtomic 區塊內延後搬運。
+ *          看門狗：啟用後超過 2 秒未餵狗即印出訊息並以結束碼 3 退出（對應 MCU 重置）。
+ */
+
+#if defined(PT2D_NATIVE)
+
+#include <errno.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "config.h"
+#include "hal.h"
+#include "hal_native.h"
+
+#define NATIVE_PIN_COUNT        32
+#define NATIVE_STREAM_SIZE      4096      // 記憶體串流每方向容量（位元組）
+#define NATIVE_FD_BUF_SIZE      256
+#define NATIVE_WDT_TIMEOUT_US   2000000UL
+#define NATIVE_LOOP_SLEEP_US    100       // 預設 main() 每輪迴圈休眠，避免空轉占滿 CPU
+
+static const uint64_t PUMP_PERIOD_US = 1000000UL / RX_PUMP_HZ;
+
+// 記憶體位元組佇列（單執行緒，不需原子操作）
+struct ByteQueue {
+  uint8_t data[NATIVE_STREAM_SIZE];
+  size_t head;
+  size_t count;
+
+  size_t push(const uint8_t* p, size_t n) {
+    size_t done = 0;
+    while (done < n && count < NATIVE_STREAM_SIZE) {
+      data[(head + count) % NATIVE_STREAM_SIZE] = p[done++];
+      count++;
+    }
+    return done;
+  }
+
+  int pop() {
+    if (count == 0) return -1;
+    uint8_t b = data[head];
+    head = (head + 1) % NATIVE_STREAM_SIZE;
+    count--;
+    return b;
+  }
+};
+
+enum StreamKind { STREAM_MEMORY = 0, STREAM_FD };
+
+// 串口埠：記憶體串流或檔案描述子（偽終端 / stdin / tty），並實作 Print 供 TxQueue 寫出
+class NativePort : public Print {
+ public:
+  NativePort() : kind(STREAM_MEMORY), rxFd(-1), txFd(-1), rxPos(0), rxLen(0), txLen(0) {
+    rx.head = rx.count = 0;
+    tx.head = tx.count = 0;
+  }
+
+  size_t write(uint8_t b) override {
+    if (kind == STREAM_MEMORY) return tx.push(&b, 1);
+    if (txLen == sizeof(txBuf)) flushOut();
+    txBuf[txLen++] = b;
+    return 1;
+  }
+
+  using Print::write;
+
+  int read() {
+    if (kind == STREAM_MEMORY) return rx.pop();
+    if (rxPos == rxLen) {
+      ssize_t n = ::read(rxFd, rxBuf, sizeof(rxBuf));
+      if (n <= 0) return -1;  // EAGAIN，或偽終端尚無從端（EIO）
+      rxPos = 0;
+      rxLen = (size_t)n;
+    }
+    return rxBuf[rxPos++];
+  }
+
+  uint8_t writeRoom() const {
+    if (kind == STREAM_FD) return 64;
+    size_t room = NATIVE_STREAM_SIZE - tx.count;
+    return room > 255 ? 255 : (uint8_t)room;
+  }
+
+  // 將累積的輸出一次寫往檔案描述子（每次搬運結束時呼叫）
+  void flushOut() {
+    size_t off = 0;
+    while (off < txLen) {
+      ssize_t n = ::write(txFd, txBuf + off, txLen - off);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) break;  // 從端未開啟或已關閉：丟棄（與實體串口無人接收相同）
+      off += (size_t)n;
+    }
+    txLen = 0;
+  }
+
+  uint8_t kind;
+  int rxFd;
+  int txFd;
+  ByteQueue rx;  // 記憶體模式：待接收
+  ByteQueue tx;  // 記憶體模式：已送出
+  uint8_t rxBuf[NATIVE_FD_BUF_SIZE];
+  size_t rxPos;
+  size_t rxLen;
+  uint8_t txBuf[NATIVE_FD_BUF_SIZE];
+  size_t txLen;
+};
+
+static NativePort ports[HAL_PORT_COUNT];
+static uint8_t pins[NATIVE_PIN_COUNT];
+
+static boolean virtualClock = false;
+static uint64_t virtualUs = 0;
+static uint64_t clockStartUs = 0;
+
+static void (*pumpFn)() = NULL;
+static void (*pumpHook)() = NULL;
+static uint64_t nextPumpUs = 0;
+static uint8_t atomicDepth = 0;
+static boolean pumping = false;
+
+static boolean wdtEnabled = false;
+static uint64_t wdtLastReset = 0;
+
+// ============================================
+// 時鐘與搬運
+// ============================================
+
+static uint64_t monotonicUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static uint64_t nowUs() {
+  if (virtualClock) return virtualUs;
+  if (clockStartUs == 0) clockStartUs = monotonicUs();
+  return monotonicUs() - clockStartUs;
+}
+
+// 模擬中斷：到期就執行一次搬運；落後多個週期時不補跑
+static void servicePump(uint64_t now) {
+  if (!pumpFn || pumping || atomicDepth > 0 || now < nextPumpUs) return;
+  pumping = true;
+  pumpFn();
+  for (uint8_t i = 0; i < HAL_PORT_COUNT; i++) {
+    if (ports[i].kind == STREAM_FD) ports[i].flushOut();
+  }
+  if (pumpHook) pumpHook();
+  if (wdtEnabled && now - wdtLastReset > NATIVE_WDT_TIMEOUT_US) {
+    fprintf(stderr, "pt2d-native: watchdog reset (%lu ms without wdt reset)\n",
+            (unsigned long)((now - wdtLastReset) / 1000));
+    _exit(3);
+  }
+  nextPumpUs += PUMP_PERIOD_US;
+  if (nextPumpUs <= now) nextPumpUs = now + PUMP_PERIOD_US;
+  pumping = false;
+}
+
+// 讀取時鐘即為搶佔點；虛擬時鐘每次讀取前進 1 µs
+static uint64_t tick() {
+  if (virtualClock) virtualUs++;
+  uint64_t now = nowUs();
+  servicePump(now);
+  return now;
+}
+
+unsigned long halMillis() { return (unsigned long)(tick() / 1000); }
+unsigned long halMicros() { return (unsigned long)tick(); }
+
+void halStartPump(void (*fn)()) {
+  pumpFn = fn;
+  nextPumpUs = nowUs() + PUMP_PERIOD_US;
+}
+
+// 等待搬運：虛擬時鐘直接跳到下一次搬運；實時時鐘休眠到下一次搬運
+void halIdle() {
+  uint64_t now = nowUs();
+  if (nextPumpUs > now) {
+    if (virtualClock) virtualUs = nextPumpUs;
+    else usleep((useconds_t)(nextPumpUs - now));
+  }
+  servicePump(nowUs());
+}
+
+HalAtomic::HalAtomic() : saved_(0) { atomicDepth++; }
+HalAtomic::~HalAtomic() { atomicDepth--; }
+
+// ============================================
+// 串口
+// ============================================
+
+void halSerialBegin(uint8_t port, unsigned long baud) {
+  (void)port;
+  (void)baud;  // 主機串流不限速
+}
+
+int halSerialRead(uint8_t port) { return ports[port].read(); }
+// 總線比照 AVR SoftwareSerial 每次搬運最多 BUS_TX_BURST 位元組，使接上模擬器時的時序接近實機
+uint8_t halSerialWriteRoom(uint8_t port) {
+  uint8_t room = ports[port].writeRoom();
+  if (port == HAL_PORT_BUS && room > BUS_TX_BURST) room = BUS_TX_BURST;
+  return room;
+}
+Print& halSerialPort(uint8_t port) { return ports[port]; }
+
+static void setRaw(int fd) {
+  struct termios tio;
+  if (tcgetattr(fd, &tio) != 0) return;  // 非終端（管線、檔案）
+  cfmakeraw(&tio);
+  tcsetattr(fd, TCSANOW, &tio);
+}
+
+static void setNonBlocking(int fd) {
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+void halNativeAttachFd(uint8_t port, int rxFd, int txFd) {
+  NativePort& p = ports[port];
+  p.kind = STREAM_FD;
+  p.rxFd = rxFd;
+  p.txFd = txFd;
+  setNonBlocking(rxFd);
+}
+
+const char* halNativeOpenPty(uint8_t port) {
+  int fd = posix_openpt(O_RDWR | O_NOCTTY);
+  if (fd < 0) return NULL;
+  if (grantpt(fd) != 0 || unlockpt(fd) != 0) {
+    close(fd);
+    return NULL;
+  }
+  setRaw(fd);  // Linux：主端 termios 即從端設定，避免回顯與換行轉換
+  halNativeAttachFd(port, fd, fd);
+  return ptsname(fd);
+}
+
+void halNativeUseMemory(uint8_t port) {
+  ports[port].kind = STREAM_MEMORY;
+}
+
+size_t halNativeFeed(uint8_t port, const uint8_t* data, size_t len) {
+  return ports[port].rx.push(data, len);
+}
+
+size_t halNativeTake(uint8_t port, uint8_t* out, size_t max) {
+  size_t n = 0;
+  int b;
+  while (n < max && (b = ports[port].tx.pop()) >= 0) out[n++] = (uint8_t)b;
+  return n;
+}
+
+void halNativeOnPump(void (*hook)()) {
+  pumpHook = hook;
+}
+
+// ============================================
+// GPIO / 看門狗 / 虛擬時鐘
+// ============================================
+
+void halPinMode(uint8_t pin, uint8_t mode) {
+  if (pin < NATIVE_PIN_COUNT && mode == INPUT_PULLUP) pins[pin] = HIGH;
+}
+
+void halDigitalWrite(uint8_t pin, uint8_t level) {
+  if (pin < NATIVE_PIN_COUNT) pins[pin] = level ? HIGH : LOW;
+}
+
+int halDigitalRead(uint8_t pin) {
+  return pin < NATIVE_PIN_COUNT ? pins[pin] : LOW;
+}
+
+void halNativeSetPin(uint8_t pin, uint8_t level) {
+  halDigitalWrite(pin, level);
+}
+
+void halWatchdogEnable() {
+  wdtEnabled = true;
+  wdtLastReset = nowUs();
+}
+
+void halWatchdogDisable() { wdtEnabled = false; }
+void halWatchdogReset() { wdtLastReset = nowUs(); }
+
+// 看門狗逾時即結束行程，每次啟動都是上電
+uint8_t halResetCause() { return HAL_RESET_POWERON; }
+
+void halNativeUseVirtualClock() {
+  virtualClock = true;
+  virtualUs = 0;
+}
+
+void halNativeAdvance(unsigned long us) {
+  uint64_t target = virtualUs + us;
+  while (pumpFn && nextPumpUs <= target) {
+    virtualUs = nextPumpUs;
+    servicePump(virtualUs);
+  }
+  virtualUs = target;
+}
+
+// ============================================
+// Arduino 核心數學函數
+// ============================================
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+  return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+long random(long howBig) {
+  return howBig == 0 ? 0 : random() % howBig;
+}
+
+long random(long howSmall, long howBig) {
+  return howSmall >= howBig ? howSmall : howSmall + random(howBig - howSmall);
+}
+
+void randomSeed(unsigned long seed) {
+  if (seed != 0) srandom((unsigned)seed);
+}
+
+// ============================================
+// 預設進入點
+// ============================================
+
+#ifndef PT2D_NATIVE_NO_MAIN
+
+void setup();
+void loop();
+
+// 用法：pt2d_native [--pc-stdio] [--bus <tty 路徑>]
+// 預設 PC 與總線各開一個偽終端，從端路徑印到 stderr（上位機以該路徑作為串口）
+int main(int argc, char** argv) {
+  boolean pcStdio = false;
+  const char* busPath = NULL;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--pc-stdio") == 0) {
+      pcStdio = true;
+    } else if (strcmp(argv[i], "--bus") == 0 && i + 1 < argc) {
+      busPath = argv[++i];
+    } else {
+      fprintf(stderr, "usage: %s [--pc-stdio] [--bus <tty>]\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if (pcStdio) {
+    halNativeAttachFd(HAL_PORT_PC, STDIN_FILENO, STDOUT_FILENO);
+  } else {
+    const char* pty = halNativeOpenPty(HAL_PORT_PC);
+    if (!pty) { perror("posix_openpt"); return 1; }
+    fprintf(stderr, "PC port: %s\n", pty);
+  }
+
+  if (busPath) {
+    int fd = open(busPath, O_RDWR | O_NOCTTY);
+    if (fd < 0) { perror(busPath); return 1; }
+    setRaw(fd);
+    halNativeAttachFd(HAL_PORT_BUS, fd, fd);
+  } else {
+    const char* pty = halNativeOpenPty(HAL_PORT_BUS);
+    if (!pty) { perror("posix_openpt"); return 1; }
+    fprintf(stderr, "Bus port: %s\n", pty);
+  }
+
+  setup();
+  for (;;) {
+    loop();
+    usleep(NATIVE_LOOP_SLEEP_US);
+  }
+}
+
+#endif // PT2D_NATIVE_NO_MAIN
+
+#endif // PT2D_NATIVE
@@ -22,28 +22,43 @@
  * - 解析 PC 端以 <...> 形式的命令（最小集合）
  * - 支援直接透傳以 # 開頭的總線指令（#...!）
  * - 分離 PC 調試串口與總線串口（UNO/Nano 使用 SoftwareSerial；Mega 使用 Serial1）
+ * - 硬體存取一律經 hal.h（AVR：hal_avr.cpp；Linux：hal_native.cpp / env:native）
  */
 
 #include <Arduino.h>
-#include <avr/wdt.h>  // 看門狗定時器
 #include "config.h"
-
-#if !defined(__AVR_ATmega2560__)
-#include <SoftwareSerial.h>
-SoftwareSerial BUS_SERIAL(SERVO_TX_PIN, SERVO_RX_PIN);
-#else
-#define BUS_SERIAL Serial1
-#endif
+#include "hal.h"
+#include "scheduler.h"
+#include "ring_buffer.h"
+#include "tx_queue.h"
+#include "bin_proto.h"
+#include "cmd_parse.h"
+#include "bus_txn.h"
+#include "latency_hist.h"
+#include "json_writer.h"
+#include "pid.h"
+
+// 非同步傳送佇列：所有 PC 回覆與總線指令先入佇列，由背景搬運（Timer2 ISR）寫出
+static TxQueue<PC_TX_QUEUE_SIZE> pcOut(halSerialPort(HAL_PORT_PC));
+static TxQueue<BUS_TX_QUEUE_SIZE> busOut(halSerialPort(HAL_PORT_BUS));
+
+// JSON 回覆先在固定緩衝區組成，整行一次交給 pcOut（與透傳位元組不會交錯）
+static_assert(JSON_BUF_SIZE < PC_TX_QUEUE_SIZE, "JSON_BUF_SIZE must fit in the PC TX queue");
+static JsonWriter<JSON_BUF_SIZE> json(pcOut);
 
 // 固定大小緩衝區（避免 String 類的 heap 碎片化）
 static char pcBuf[128];
 static uint8_t pcBufLen = 0;
-static char busBuf[64];
+static char busBuf[64];          // 回覆原文（無對應交易時以一行透傳到 PC）
 static uint8_t busBufLen = 0;
+static BusReplyParser busParser; // 與 busBuf 同步逐位元組解析
+
+// 中斷驅動接收環形緩衝區：Timer2 ISR 從串口驅動搬入，主迴圈任務取出
+static RingBuffer<PC_RX_RING_SIZE> pcRx;
+static RingBuffer<BUS_RX_RING_SIZE> busRx;
 
-enum BusCmdType { BUS_NONE = 0, BUS_READ_ANGLE, BUS_READ_VOLTEMP };
-static BusCmdType lastBusCmd = BUS_NONE;
-static int lastBusId = -1;
+// 總線查詢交易引擎：PC 讀取請求、舵機驗證與 CONFIGSERVO 共用，可同時進行
+static BusTxnEngine<BUS_TXN_SLOTS, BUS_TXN_WINDOW, BUS_POST_SIZE> busTxn(busOut);
 
 // 動態舵機 ID（執行時可修改）
 // 初始化為 0（無效值），必須通過 verifyServoPresence() 進行自動掃描
@@ -51,63 +66,192 @@ static int panServoId = 0;
 static int tiltServoId = 0;
 static boolean servoIdDetected = false;
 static boolean servoDisabled = false;  // 軟停機：舵機ID無效時僅禁用舵機相關命令
-static unsigned long lastErrorNotify = 0; // 非阻塞錯誤提示節流
+
+// 舵機驗證（非阻塞）：兩軸查詢一次提交（依序送出），全部完成後輸出結果
+static uint8_t verifyPending = 0;         // 未完成的驗證查詢數
+static boolean verifyPanOk = false;
+static boolean verifyTiltOk = false;
+static void (*verifyDoneHook)() = NULL;   // 驗證完成後的回呼（可為 NULL）
+
+// CONFIGSERVO（非阻塞）：等待舵機確認
+static boolean configPending = false;
+static int configTargetId = 0;
+
+// 蜂鳴器（非阻塞）：剩餘翻轉次數與下次翻轉時間
+static uint8_t beepToggles = 0;
+static unsigned long beepNext = 0;
 
 // 移動參數（全局）
 static int moveSpeed = DEFAULT_SPEED;
 static int moveTime = 1000;  // 預設時間（ms）
 
-// 聚合狀態：POS 與 STATUS（雙軸）
-enum AggType { AGG_NONE = 0, AGG_POS_BOTH, AGG_STATUS_BOTH };
-static AggType aggType = AGG_NONE;
-static int aggPhase = 0;
-static int aggPanAngle = -1;
-static int aggTiltAngle = -1;
-static int aggPanVolt = -1;
-static int aggPanTemp = -1;
-static int aggTiltVolt = -1;
-static int aggTiltTemp = -1;
-static unsigned long aggTimeout = 0;  // 聚合命令超時保護（毫秒）
-
-// 超時設定（毫秒）
-#define AGG_CMD_TIMEOUT 2000  // 聚合命令最大等待時間
+// 雙軸位置模型：POS 直接由此回覆，MOVEBY 以估算角度為基準
+enum { AXIS_PAN = 0, AXIS_TILT, AXIS_COUNT };
+
+struct AxisState {
+  int from;                 // 本段運動起點角度
+  int target;               // 指令目標角度
+  unsigned long moveStart;  // 本段運動開始時間（millis）
+  uint16_t moveMs;          // 本段運動時間（0 = 靜止）
+  int lastRead;             // 最近一次總線讀回角度（-1 = 尚未讀取）
+  // 軌跡規劃狀態（trajEnabled 時使用）
+  float pos;                // 目前設定點（度）
+  float vel;                // 度/秒
+  float acc;                // 度/秒²
+  float sent;               // 最近一次送往總線的設定點
+  unsigned long sentAt;     // 最近一次送出時間（millis）
+};
+static AxisState axes[AXIS_COUNT] = {
+  { PAN_INIT_ANGLE, PAN_INIT_ANGLE, 0, 0, -1, PAN_INIT_ANGLE, 0, 0, PAN_INIT_ANGLE, 0 },
+  { TILT_INIT_ANGLE, TILT_INIT_ANGLE, 0, 0, -1, TILT_INIT_ANGLE, 0, 0, TILT_INIT_ANGLE, 0 },
+};
+static boolean trajEnabled = TRAJ_ENABLED_DEFAULT;  // MOVE 類命令經軌跡規劃串流設定點
+static boolean trackActive = false;                 // 視覺伺服中：設定點由 taskTrack 直接送出
+
+// 回覆上下文：目前命令來自文字行或二進位幀，決定 sendOk/sendError 的輸出格式
+struct ReplyCtx {
+  boolean binary;
+  uint8_t opcode;  // 二進位請求操作碼（ACK 回填用）
+};
+static ReplyCtx reply = { false, 0 };
+
+// PC 讀取請求：拆成一至四筆總線交易，全部完成（或任一逾時）後回覆發起者
+enum ReadJobType { JOB_FREE = 0, JOB_POS, JOB_STATUS, JOB_READ_ANGLE, JOB_READ_VOLTEMP, JOB_TELEMETRY };
+
+// 欄位索引（與二進位 STATUS 幀 payload 順序一致）
+enum ReadField {
+  FIELD_PAN_ANGLE = 0, FIELD_TILT_ANGLE,
+  FIELD_PAN_TEMP, FIELD_TILT_TEMP,
+  FIELD_PAN_VOLT, FIELD_TILT_VOLT,
+  FIELD_COUNT
+};
+
+struct ReadJob {
+  uint8_t type;
+  uint8_t pending;     // 未完成的總線交易數
+  boolean failed;      // 任一交易逾時或回覆不完整
+  ReplyCtx reply;      // 發起時的回覆上下文
+  int id;              // READANGLE/READVOLTEMP 目標 ID；JOB_TELEMETRY 為採樣時的欄位位元
+  int val[FIELD_COUNT];
+  unsigned long rxAt;  // 發起命令的 RX 完成時間（micros，延遲量測）
+};
+static ReadJob jobs[BUS_JOB_SLOTS];
+
+// 遙測訂閱：每個週期以一個 JOB_TELEMETRY 讀取請求採樣，完成後主動推送
+static uint8_t subFields = 0;              // BIN_SUB_* 位元組合，0 = 未訂閱
+static uint16_t subPeriod = SUB_DEFAULT_PERIOD;
+static unsigned long subNext = 0;          // 下次採樣時間（millis）
+static unsigned long subSampledAt = 0;     // 進行中採樣的提交時間
+static boolean subInFlight = false;        // 上一輪採樣尚未完成
+static ReplyCtx subReply = { false, 0 };   // 訂閱時的回覆格式（JSON 或 TELEMETRY 幀）
+
+// 延遲量測（<STATS>）：RX 完成 → 分發 → 總線送出 / 回覆 → PC 回覆入佇列，單位 µs
+enum LatHistId {
+  LAT_RX_DISPATCH = 0,  // 命令所在批次由搬運收入 → 主迴圈開始處理
+  LAT_DISPATCH_BUS,     // 開始處理 → 該命令第一幀總線指令由搬運寫出
+  LAT_BUS_RTT,          // 總線查詢送出 → 回覆配對
+  LAT_CMD_LOCAL,        // 端到端（RX → 回覆入佇列）：不送總線指令的命令
+  LAT_CMD_MOTION,       // 端到端：送出運動 / 透傳總線指令的命令
+  LAT_CMD_READ,         // 端到端：總線讀取請求（POS 驗證 / STATUS / READ*）
+  LAT_HIST_COUNT
+};
+enum LatBusState { LAT_BUS_IDLE = 0, LAT_BUS_QUEUED, LAT_BUS_SENT };
+
+static LatHist latHist[LAT_HIST_COUNT];
+static volatile unsigned long pcRxAt = 0;      // 最近一次搬運收到 PC 位元組的時間（ISR 寫）
+static unsigned long latRxAt = 0;              // 目前命令的 RX 完成時間
+static unsigned long latDispatchAt = 0;
+static boolean latBusWant = false;             // 處理中：等待本命令的第一幀總線指令
+static boolean latTrajWant = false;            // 軌跡模式移動：第一幀由 taskTrajectory 送出
+static boolean latAsync = false;               // 本命令發起了讀取請求，於完成時記錄
+static unsigned long latBusFrom = 0;
+static volatile uint8_t latBusState = LAT_BUS_IDLE;
+static volatile unsigned long latBusTxAt = 0;  // ISR 寫
+
+// 迴圈剖析與重置紀錄（<PROFILE>）：放在 .noinit，看門狗重置後仍可讀出重置前卡在哪個任務
+#define RESET_REC_MAGIC     0x5A3C
+struct ResetRecord {
+  uint16_t magic;               // RESET_REC_MAGIC = 內容有效（上電時為隨機值）
+  uint16_t boots;               // 上電以來的開機次數（含本次）
+  uint8_t cause;                // 本次開機的 HalResetCause 位元
+  unsigned long wdtGapMaxMs;    // 兩次餵狗的最長間隔
+  LoopProfile loop;
+};
+static ResetRecord resetRec HAL_NOINIT;
+static ResetRecord prevRec;                    // 重置前的紀錄（magic 為 0 表示無）
+static unsigned long wdtLastFeed = 0;          // 最近一次餵狗時間（millis）
+
+// 二進位幀接收狀態（需先以 <BINARY:ON> 啟用）
+static boolean binaryEnabled = false;
+static boolean binActive = false;           // 正在接收幀（已收到 SYNC）
+static uint8_t binBuf[BIN_MAX_LEN + 2];     // LEN + OPCODE/PAYLOAD + CRC
+static uint8_t binLen = 0;
+static unsigned long binLastByte = 0;
 
 static void setup_led() {
-  pinMode(LED_PIN, OUTPUT);
-  digitalWrite(LED_PIN, HIGH); // 熄滅
+  halPinMode(LED_PIN, OUTPUT);
+  halDigitalWrite(LED_PIN, HIGH); // 熄滅
 }
 
 static void setup_beep() {
-  pinMode(BEEP_PIN, OUTPUT);
-  digitalWrite(BEEP_PIN, HIGH); // 關閉
+  halPinMode(BEEP_PIN, OUTPUT);
+  halDigitalWrite(BEEP_PIN, HIGH); // 關閉
 }
 
-// 蜂鳴器輔助函數：發出短促蜂鳴聲（3次）
-static void beep_short3() {
-  for (int i = 0; i < 3; i++) {
-    digitalWrite(BEEP_PIN, LOW);   // 開啟蜂鳴器
-    delay(100);
-    digitalWrite(BEEP_PIN, HIGH);  // 關閉蜂鳴器
-    delay(100);
-  }
+// 蜂鳴器輔助函數：啟動 count 次短促蜂鳴（由 taskBuzzer 在背景播放）
+static void beepStart(uint8_t count) {
+  beepToggles = count * 2;
+  beepNext = halMillis();
 }
 
 static void setup_laser() {
-  pinMode(LASER_PIN, OUTPUT);
-  digitalWrite(LASER_PIN, LOW); // 雷射關閉
+  halPinMode(LASER_PIN, OUTPUT);
+  halDigitalWrite(LASER_PIN, LOW); // 雷射關閉
 }
 
 static void setup_keys() {
-  pinMode(KEY1_PIN, INPUT_PULLUP);
-  pinMode(KEY2_PIN, INPUT_PULLUP);
+  halPinMode(KEY1_PIN, INPUT_PULLUP);
+  halPinMode(KEY2_PIN, INPUT_PULLUP);
 }
 
 static void setup_uart() {
-  Serial.begin(SERIAL_BAUDRATE);
+  halSerialBegin(HAL_PORT_PC, SERIAL_BAUDRATE);
 }
 
 static void setup_bus() {
-  BUS_SERIAL.begin(SERVO_BAUDRATE);
+  halSerialBegin(HAL_PORT_BUS, SERVO_BAUDRATE);
+}
+
+// 背景搬運（以 RX_PUMP_HZ 頻率於 Timer2 ISR 執行）：
+// 把串口驅動內的位元組搬入環形緩衝區，並把傳送佇列寫往串口（只寫驅動容得下的量，不忙等）
+static void pumpSerial() {
+  int b;
+  boolean pcGot = false;
+  while ((b = halSerialRead(HAL_PORT_PC)) >= 0) {
+    pcRx.push((uint8_t)b);
+    pcGot = true;
+  }
+  if (pcGot) pcRxAt = halMicros();
+  while ((b = halSerialRead(HAL_PORT_BUS)) >= 0) {
+    busRx.push((uint8_t)b);
+  }
+  pcOut.drain(halSerialWriteRoom(HAL_PORT_PC));
+  boolean busPending = !busOut.idle();
+  busOut.drain(halSerialWriteRoom(HAL_PORT_BUS));
+  if (busPending && latBusState == LAT_BUS_QUEUED) {
+    latBusTxAt = halMicros();
+    latBusState = LAT_BUS_SENT;
+  }
+}
+
+static void setup_rx_pump() {
+  halStartPump(pumpSerial);
+}
+
+// 讀取 ISR 更新的 16 位元計數（避免讀到半更新值）
+static uint16_t readOverflows(volatile uint16_t& counter) {
+  HalAtomic lock;
+  return counter;
 }
 
 // ============================================
@@ -124,122 +268,767 @@ static bool isValidAngle(int angle, int maxAngle) {
   return (angle >= 0 && angle <= maxAngle);
 }
 
-// 安全的整數解析（避免 toInt() 的未定義行為）
-static bool parseIntParam(const char* str, int& result) {
-  if (!str || *str == '\0') return false;
-  char* endptr;
-  long val = strtol(str, &endptr, 10);
-  if (*endptr != '\0' && *endptr != ',' && *endptr != ' ') return false;
-  result = (int)val;
+// 清空緩衝區
+static void clearBuf(char* buf, uint8_t& len) {
+  buf[0] = '\0';
+  len = 0;
+}
+
+// 二進位幀輸出：SYNC | LEN | OPCODE | PAYLOAD | CRC8
+static void sendFrame(uint8_t opcode, const uint8_t* payload, uint8_t len) {
+  uint8_t frameLen = len + 1;
+  uint8_t crc = crc8Update(0, frameLen);
+  crc = crc8Update(crc, opcode);
+  pcOut.write((uint8_t)BIN_SYNC);
+  pcOut.write(frameLen);
+  pcOut.write(opcode);
+  for (uint8_t i = 0; i < len; i++) {
+    crc = crc8Update(crc, payload[i]);
+    pcOut.write(payload[i]);
+  }
+  pcOut.write(crc);
+}
+
+static void sendAck(const ReplyCtx& ctx, uint8_t status) {
+  uint8_t payload[2] = { ctx.opcode, status };
+  sendFrame(BIN_RSP_ACK, payload, sizeof(payload));
+}
+
+// JSON 錯誤回應（二進位命令則回 ACK 錯誤）；ctx 為發起命令時的回覆上下文，msg 位於 PROGMEM
+static void sendErrorTo(const ReplyCtx& ctx, const char* msg) {
+  if (ctx.binary) {
+    sendAck(ctx, BIN_STATUS_ERROR);
+    return;
+  }
+  json.begin().fieldStrP(PSTR("status"), PSTR("error")).fieldStrP(PSTR("message"), msg).end();
+}
+
+static void sendError(const char* msg) {
+  sendErrorTo(reply, msg);
+}
+
+// 命令解析錯誤：附帶 CmdError 錯誤碼，{"status":"error","message":msg,"code":n}
+static void sendErrorCode(const char* msg, uint8_t code) {
+  json.begin()
+      .fieldStrP(PSTR("status"), PSTR("error"))
+      .fieldStrP(PSTR("message"), msg)
+      .field(PSTR("code"), (unsigned int)code)
+      .end();
+}
+
+static void sendOk() {
+  if (reply.binary) {
+    sendAck(reply, BIN_STATUS_OK);
+    return;
+  }
+  json.begin().fieldStrP(PSTR("status"), PSTR("ok")).fieldStrP(PSTR("message"), PSTR("OK")).end();
+}
+
+// 帶訊息的成功回應（二進位命令則回 ACK）；msg 位於 PROGMEM
+static void sendOkMsg(const char* msg) {
+  if (reply.binary) {
+    sendAck(reply, BIN_STATUS_OK);
+    return;
+  }
+  json.begin().fieldStrP(PSTR("status"), PSTR("ok")).fieldStrP(PSTR("message"), msg).end();
+}
+
+// 多處共用的回應訊息
+static const char MSG_SERVO_DISABLED[] PROGMEM = "Servo disabled";
+static const char MSG_INVALID_PARAM[] PROGMEM = "Invalid parameter";
+static const char MSG_INVALID_RESET[] PROGMEM = "Invalid parameter (RESET)";
+static const char MSG_BUS_BUSY[] PROGMEM = "Bus busy";
+
+// 帶一個整數欄位的資訊訊息：{"status":"info","message":msg,key:v}（msg、key 位於 PROGMEM）
+static void sendInfoId(const char* msg, const char* key, int v) {
+  json.begin().fieldStrP(PSTR("status"), PSTR("info")).fieldStrP(PSTR("message"), msg).field(key, v).end();
+}
+
+// ============================================
+// 延遲量測
+// ============================================
+
+// 開始處理一個命令：RX 完成時間取最近一次搬運收到 PC 位元組的時間
+// （命令最後一個位元組在該批或更早，因此 RX → 處理的值可能略為低估）
+static void latDispatch() {
+  {
+    HalAtomic lock;
+    latRxAt = pcRxAt;
+  }
+  latDispatchAt = halMicros();
+  latHist[LAT_RX_DISPATCH].record(latDispatchAt - latRxAt);
+  latBusWant = true;
+  latTrajWant = false;
+  latAsync = false;
+}
+
+// 命令處理結束：同步回覆的命令在此記錄端到端延遲
+static void latDispatchDone() {
+  if (!latAsync) {
+    boolean bus = !latBusWant || latTrajWant;
+    latHist[bus ? LAT_CMD_MOTION : LAT_CMD_LOCAL].record(halMicros() - latRxAt);
+  }
+  if (!latTrajWant) latBusWant = false;
+}
+
+// 本命令的第一幀總線指令已入佇列：由搬運在實際寫出時記錄時間
+static void latBusQueued() {
+  if (!latBusWant) return;
+  latBusWant = false;
+  if (latBusState != LAT_BUS_IDLE) return;  // 上一筆尚未記錄：略過本筆
+  latBusFrom = latDispatchAt;
+  latBusState = LAT_BUS_QUEUED;
+}
+
+// 主迴圈：記錄搬運已寫出的總線首幀
+static void latPoll() {
+  if (latBusState != LAT_BUS_SENT) return;
+  latHist[LAT_DISPATCH_BUS].record(latBusTxAt - latBusFrom);
+  latBusState = LAT_BUS_IDLE;
+}
+
+// 將 #...! 指令交給交易引擎寫入總線（立即返回，由 ISR 背景送出；查詢等回覆期間先暫存）。
+// 暫存區已滿返回 false
+static bool sendBus(const char* cmd) {
+  if (!busTxn.post(cmd)) return false;
+  latBusQueued();
   return true;
 }
 
-// 解析逗號分隔的兩個整數
-static bool parseTwoInts(const char* params, int& val1, int& val2) {
-  const char* comma = strchr(params, ',');
-  if (!comma) return false;
+// ============================================
+// 雙軸位置模型：依指令目標與 moveTime 線性插值估算目前角度
+// ============================================
 
-  char buf1[16], buf2[16];
-  int len1 = comma - params;
-  if (len1 >= 16) return false;
-  strncpy(buf1, params, len1);
-  buf1[len1] = '\0';
+// 角度轉位置函數（四捨五入到最近刻度；map() 截斷會讓讀回值系統性偏低）
+static uint16_t angleToPosition(int angle) {
+  if (angle < 0) angle = 0;
+  if (angle > SERVO_MAX_ANGLE) angle = SERVO_MAX_ANGLE;
+  return (uint16_t)(((long)angle * 1000 + SERVO_MAX_ANGLE / 2) / SERVO_MAX_ANGLE);
+}
+
+// 位置轉角度（angleToPosition 的反函數，用於總線讀回值）：同樣四捨五入，
+// 每度約 3.7 個刻度，任何角度轉位置再轉回都得到原角度
+static int positionToAngle(int pos) {
+  if (pos < 0) pos = 0;
+  if (pos > 1000) pos = 1000;
+  return (int)(((long)pos * SERVO_MAX_ANGLE + 500) / 1000);
+}
+
+// 軌跡規劃的 float 角度轉位置（保留小數以得到較細的設定點）
+static uint16_t trajPosition(float angle) {
+  return (uint16_t)(angle * (1000.0f / SERVO_MAX_ANGLE) + 0.5f);
+}
 
-  strncpy(buf2, comma + 1, 15);
-  buf2[15] = '\0';
+static bool axisMoving(const AxisState& a) {
+  if (trajEnabled) return a.vel != 0.0f || a.pos != (float)a.target;
+  return halMillis() - a.moveStart < a.moveMs;
+}
+
+// 目前估算角度：軌跡模式為規劃器設定點；否則運動中依經過時間插值，結束後即為目標
+static int axisAngle(const AxisState& a) {
+  if (trajEnabled) return (int)(a.pos + 0.5f);
+  unsigned long elapsed = halMillis() - a.moveStart;
+  if (elapsed >= a.moveMs) return a.target;
+  return a.from + (int)((long)(a.target - a.from) * (long)elapsed / a.moveMs);
+}
 
-  return parseIntParam(buf1, val1) && parseIntParam(buf2, val2);
+// 將模型重設為靜止於 angle
+static void axisRest(AxisState& a, int angle) {
+  a.from = a.target = angle;
+  a.moveMs = 0;
+  a.pos = (float)angle;
+  a.vel = a.acc = 0.0f;
 }
 
-// 字串轉大寫（in-place）
-static void toUpperCase(char* str) {
-  while (*str) {
-    if (*str >= 'a' && *str <= 'z') *str -= 32;
-    str++;
+// 記錄總線讀回角度；靜止時以實測值校正模型
+// （最後一個設定點送出後 UPDATE_INTERVAL 內舵機可能仍在插值，不校正）
+static void axisObserve(AxisState& a, int angle) {
+  a.lastRead = angle;
+  // 設定點可能在查詢等回覆期間暫存、晚於 sentAt 才送出，以實際寫入總線的時間為準
+  unsigned long now = halMillis();
+  if (!axisMoving(a) && now - a.sentAt >= UPDATE_INTERVAL && !busTxn.postedWithin(now, UPDATE_INTERVAL)) {
+    axisRest(a, angle);
+    a.sent = a.pos;  // 舵機已在此位置，無需再送設定點
   }
 }
 
-// 清空緩衝區
-static void clearBuf(char* buf, uint8_t& len) {
-  buf[0] = '\0';
-  len = 0;
+// 停止：凍結在目前估算角度
+static void axisHold(AxisState& a) {
+  axisRest(a, axisAngle(a));
+  a.sent = a.pos;
 }
 
-// 重置聚合狀態
-static void resetAggState() {
-  aggType = AGG_NONE;
-  aggPhase = 0;
-  aggPanAngle = aggTiltAngle = -1;
-  aggPanVolt = aggTiltVolt = -1;
-  aggPanTemp = aggTiltTemp = -1;
-  aggTimeout = 0;
-  clearBuf(busBuf, busBufLen);
+static int clampAngle(int angle, int lo, int hi) {
+  if (angle < lo) return lo;
+  if (angle > hi) return hi;
+  return angle;
 }
 
-// JSON 錯誤回應
-static void sendError(const char* msg) {
-  Serial.print("{\"status\":\"error\",\"message\":\"");
-  Serial.print(msg);
-  Serial.println("\"}");
+// 多軸運動群組幀的最大長度（含 {} 與 NUL）
+#define AXIS_FRAME_MAX  (AXIS_COUNT * (BUS_FRAME_MAX - 1) + 3)
+
+// 總線能否再接受一個運動幀（查詢等回覆期間由交易引擎暫存）
+static bool busCanMove() {
+  return busTxn.postRoom() >= AXIS_FRAME_MAX;
 }
 
-static void sendOk() {
-  Serial.println("{\"status\":\"ok\",\"message\":\"OK\"}");
+// 多軸運動指令：mask 中的軸各送 #IDPxxxxTxxxx!（pos 為位置刻度，ms 為運動時間）。
+// 兩軸以上包成 ZL 群組幀 {#..!#..!}，舵機收到 '}' 後同時起動；逐幀送出時
+// 後一軸要晚一整幀的傳輸時間才起動，直線路徑會先偏向先動的軸。
+// 整個幀一次交給交易引擎，不會被查詢切開或壓在回覆上；暫存區已滿返回 false
+static bool sendAxisMoves(const uint16_t pos[AXIS_COUNT], const uint16_t ms[AXIS_COUNT], uint8_t mask) {
+  const int id[AXIS_COUNT] = { panServoId, tiltServoId };
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    if (mask & (1 << i)) n++;
+  }
+  if (n == 0) return true;
+
+  char frame[AXIS_FRAME_MAX];
+  size_t len = 0;
+  if (n > 1) frame[len++] = '{';
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    if (!(mask & (1 << i))) continue;
+    len += snprintf_P(frame + len, sizeof(frame) - len, PSTR("#%03dP%04uT%04u!"), id[i], pos[i], ms[i]);
+  }
+  if (n > 1) frame[len++] = '}';
+  frame[len] = '\0';
+  return sendBus(frame);
 }
 
-// 驗證預設舵機 ID（只檢查電壓是否存在）
-static void verifyServoPresence() {
-  Serial.println("{\"status\":\"info\",\"message\":\"驗證舵機電壓（預設ID）\"}");
+// 各軸移動到指定角度（限制在安全範圍內）：
+// 軌跡模式只更新目標，由 taskTrajectory 串流設定點；否則以一個群組幀同時送出（時間 ms，0 = moveTime）。
+// 直接模式下總線暫存區已滿時不改變位置模型並返回 false
+static bool moveAxesTo(int panAngle, int tiltAngle, uint16_t ms = 0) {
+  const int angle[AXIS_COUNT] = {
+    clampAngle(panAngle, PAN_MIN_ANGLE, PAN_MAX_ANGLE),
+    clampAngle(tiltAngle, TILT_MIN_ANGLE, TILT_MAX_ANGLE),  // 安全限制
+  };
+  if (ms == 0) ms = moveTime;
+  if (!trajEnabled && !busCanMove()) return false;
+  unsigned long now = halMillis();
+  uint16_t pos[AXIS_COUNT];
+  uint16_t t[AXIS_COUNT];
+
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    AxisState& a = axes[i];
+    if (trajEnabled) {
+      a.target = angle[i];
+      latTrajWant = true;
+      continue;
+    }
+    a.from = axisAngle(a);
+    a.target = angle[i];
+    a.moveStart = now;
+    a.moveMs = ms;
+    pos[i] = angleToPosition(angle[i]);
+    t[i] = ms;
+  }
+  return trajEnabled || sendAxisMoves(pos, t, (1 << AXIS_COUNT) - 1);
+}
 
-  // 使用預設 ID
-  panServoId = DEFAULT_PAN_SERVO_ID;    // 預設 ID 1（水平 Pan）
-  tiltServoId = DEFAULT_TILT_SERVO_ID;  // 預設 ID 2（垂直 Tilt）
+// ============================================
+// 軌跡規劃：每 UPDATE_INTERVAL 推進一步，速度/加速度/加加速度受限（S 曲線）
+// ============================================
+
+static const float TRAJ_VMAX[AXIS_COUNT] PROGMEM = { TRAJ_MAX_VEL_PAN, TRAJ_MAX_VEL_TILT };
+static const float TRAJ_AMAX[AXIS_COUNT] PROGMEM = { TRAJ_MAX_ACC_PAN, TRAJ_MAX_ACC_TILT };
+static const float TRAJ_JMAX[AXIS_COUNT] PROGMEM = { TRAJ_MAX_JERK_PAN, TRAJ_MAX_JERK_TILT };
+
+// 到達判定：剩餘距離小於此值（度，遠小於舵機刻度 0.27°）即停在目標上
+static const float TRAJ_SETTLE = 0.01f;
+
+struct TrajLimits {
+  float vmax;
+  float amax;
+  float jmax;
+  float dt;
+};
+
+// 由速度 v（加速度 0）以 -jmax 爬升、-amax 保持、+jmax 回零制動到靜止的距離（對稱曲線，平均速度 v/2）
+static float trajBrakeDist(float v, const TrajLimits& k) {
+  if (v <= 0.0f) return 0.0f;
+  if (v >= k.amax * k.amax / k.jmax) return 0.5f * v * (v / k.amax + k.amax / k.jmax);
+  return v * sqrt(v / k.jmax);
+}
+
+// 由 (v, a) 停止所需距離（v ≥ 0 為朝向目標），含加速度先回零 / 已在減速的部分
+static float trajStopDist(float v, float a, const TrajLimits& k) {
+  const float j = k.jmax;
+  if (a >= 0.0f) {
+    // 先以 -jmax 把加速度降到 0：期間速度再增加 a²/2j
+    float t = a / j;
+    return v * t + a * a * a / (3.0f * j * j) + trajBrakeDist(v + a * a / (2.0f * j), k);
+  }
+  float b = -a;
+  float vv = v + b * b / (2.0f * j);  // 減速度由 0 爬升到 b 之前的速度
+  float peak = sqrt(vv * j);
+  if (peak > k.amax) peak = k.amax;
+  if (peak >= b) {
+    // 仍在完整制動曲線上：扣除虛擬爬升段（由 vv 起 t 秒）已走的距離
+    float t = b / j;
+    return trajBrakeDist(vv, k) - (vv * t - j * t * t * t / 6.0f);
+  }
+  // 減速過猛：加速度回零前速度已歸零
+  float disc = b * b - 2.0f * j * v;
+  float t = (b - sqrt(disc > 0.0f ? disc : 0.0f)) / j;
+  return v * t - 0.5f * b * t * t + j * t * t * t / 6.0f;
+}
+
+// 下一步加速度 an 是否可行：加速度以 jmax 回零後不超過 vmax，且仍能在剩餘距離 d 內停下
+static bool trajFeasible(float d, float v, float an, const TrajLimits& k) {
+  float vn = v + an * k.dt;
+  if (vn + (an > 0.0f ? an * an / (2.0f * k.jmax) : 0.0f) > k.vmax) return false;
+  if (vn <= 0.0f) return true;
+  return trajStopDist(vn, an, k) <= d - vn * k.dt;
+}
+
+// 單軸推進一步：在 jmax·dt 允許的加速度範圍內取最大的可行值（可行性對加速度單調，二分搜尋），
+// 因此速度在加速度回零時恰達 vmax、到達目標時速度與加速度同時歸零，不會過衝。
+// 狀態連續，運動中途更換目標時自然銜接；朝目標運動時不反向，到達時最後一步不超過 vmax·dt。
+static void trajStep(AxisState& a, uint8_t axis) {
+  TrajLimits k;
+  k.dt = UPDATE_INTERVAL / 1000.0f;
+  k.vmax = pgm_read_float(&TRAJ_VMAX[axis]) * moveSpeed / 100.0f;
+  k.amax = pgm_read_float(&TRAJ_AMAX[axis]);
+  k.jmax = pgm_read_float(&TRAJ_JMAX[axis]);
+
+  // 以目標方向為正的座標：d 為剩餘距離，v / acc > 0 表示朝向目標
+  float dist = (float)a.target - a.pos;
+  float dir = dist < 0.0f ? -1.0f : 1.0f;
+  float d = dist * dir;
+  float v = a.vel * dir;
+  float acc = a.acc * dir;
+
+  float lo = acc - k.jmax * k.dt;
+  float hi = acc + k.jmax * k.dt;
+  if (lo < -k.amax) lo = -k.amax;
+  if (hi > k.amax) hi = k.amax;
+  float an;
+  if (trajFeasible(d, v, hi, k)) {
+    an = hi;
+  } else if (!trajFeasible(d, v, lo, k)) {
+    an = lo;  // 中途改目標等無法及時停下的情況：全力制動
+  } else {
+    for (uint8_t i = 0; i < 8; i++) {
+      float mid = 0.5f * (lo + hi);
+      if (trajFeasible(d, v, mid, k)) lo = mid;
+      else hi = mid;
+    }
+    an = lo;
+  }
 
-  boolean panOk = false;
-  boolean tiltOk = false;
+  float vn = v + an * k.dt;
+  if (v >= 0.0f && vn < 0.0f) vn = an = 0.0f;  // 朝目標運動時只減速到停，不反向
 
-  // 檢查 Pan 舵機（ID 1）
-  Serial.print("{\"status\":\"info\",\"message\":\"檢查 Pan 舵機\",\"id\":");
-  Serial.print(panServoId);
-  Serial.println("}");
+  // 終端：本步到達（或越過）目標、或只剩 TRAJ_SETTLE 以內時停在目標上（跳動 ≤ 本步位移）
+  if (v >= 0.0f && (vn * k.dt >= d || (d - vn * k.dt < TRAJ_SETTLE && vn < k.amax * k.dt))) {
+    a.pos = (float)a.target;
+    a.vel = a.acc = 0.0f;
+    return;
+  }
+  a.acc = an * dir;
+  a.vel = vn * dir;
+  a.pos += vn * k.dt * dir;
+}
 
-  char buf[16];
-  snprintf(buf, sizeof(buf), "#%03dPRTV!", panServoId);
-  sendBus(buf);
-  delay(200);
+// 軌跡任務：推進各軸，設定點變化達 SMOOTH_MOVE_STEP（或到達終點）時送出，
+// T 取自上次送出至今的時間，使舵機在設定點之間等速銜接；同一步要送的軸合併為一個群組幀。
+// 查詢等回覆期間幀由交易引擎暫存；暫存區已滿時規劃照常推進，設定點留到下一步連同新位置再送
+static void taskTrajectory() {
+  if (!trajEnabled || servoDisabled || trackActive) return;
+  unsigned long now = halMillis();
+  uint16_t pos[AXIS_COUNT];
+  uint16_t ms[AXIS_COUNT];
+  uint8_t mask = 0;
+
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    AxisState& a = axes[i];
+    if (!axisMoving(a) && a.sent == a.pos) continue;
+    if (a.vel == 0.0f && a.acc == 0.0f) a.sentAt = now - UPDATE_INTERVAL;  // 由靜止起步
+    trajStep(a, i);
+
+    boolean done = !axisMoving(a);
+    if (fabs(a.pos - a.sent) < SMOOTH_MOVE_STEP && !(done && a.sent != a.pos)) continue;
+
+    unsigned long t = now - a.sentAt;
+    if (t < UPDATE_INTERVAL) t = UPDATE_INTERVAL;
+    if (t > 9999) t = 9999;
+    pos[i] = trajPosition(a.pos);
+    ms[i] = (uint16_t)t;
+    mask |= 1 << i;
+  }
+  if (!sendAxisMoves(pos, ms, mask)) return;
 
-  // 清空 Pan 舵機回應
-  while (BUS_SERIAL.available()) {
-    BUS_SERIAL.read();
-    panOk = true;  // 有回應表示舵機存在
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    if (!(mask & (1 << i))) continue;
+    axes[i].sent = axes[i].pos;
+    axes[i].sentAt = now;
   }
+}
 
-  // 檢查 Tilt 舵機（ID 2）
-  Serial.print("{\"status\":\"info\",\"message\":\"檢查 Tilt 舵機\",\"id\":");
-  Serial.print(tiltServoId);
-  Serial.println("}");
+// ============================================
+// 自動掃描：依時間計算掃描路徑，每 SCAN_UPDATE_INTERVAL 更新目標（經軌跡規劃平滑）
+// ============================================
+
+enum ScanMode { SCAN_OFF = 0, SCAN_LINEAR, SCAN_SINE, SCAN_RANDOM };
+static uint8_t scanMode = SCAN_OFF;
+static unsigned long scanStart = 0;  // 掃描開始時間（millis）
+static unsigned long scanNext = 0;   // 隨機掃描下一次選點時間
 
-  snprintf(buf, sizeof(buf), "#%03dPRTV!", tiltServoId);
-  sendBus(buf);
-  delay(200);
+// 掃描角速度（度/秒）：SCAN_SPEED 與 SPEED 同一刻度（100 = TRAJ_MAX_VEL_PAN）
+static const float SCAN_VEL = TRAJ_MAX_VEL_PAN * SCAN_SPEED / 100.0f;
+static const int SCAN_TILT_SPAN = SCAN_ROW_STEP * (SCAN_ROWS - 1);
 
-  // 清空 Tilt 舵機回應
-  while (BUS_SERIAL.available()) {
-    BUS_SERIAL.read();
-    tiltOk = true;  // 有回應表示舵機存在
+static void scanStop() {
+  scanMode = SCAN_OFF;
+}
+
+// 掃描任務：光柵 = Pan 等速往返、每趟換一行 Tilt；
+// 正弦 = Pan 正弦擺動、Tilt 以非整數倍頻率起伏（Lissajous 覆蓋）；
+// 隨機 = 在掃描範圍內隨機選點，到點停留 SCAN_DWELL_MS 後再選下一點
+static void taskScan() {
+  if (scanMode == SCAN_OFF || servoDisabled) return;
+  unsigned long now = halMillis();
+  float t = (now - scanStart) / 1000.0f;
+  const float half = SCAN_RANGE / 2.0f;
+  int pan, tilt;
+
+  if (scanMode == SCAN_LINEAR) {
+    float pass = SCAN_RANGE / SCAN_VEL;  // 單趟秒數
+    unsigned long k = (unsigned long)(t / pass);
+    float phase = (t - k * pass) / pass;
+    pan = SCAN_CENTER_PAN - half + SCAN_RANGE * ((k & 1) ? 1.0f - phase : phase);
+    // 行序 0,1,..,N-1,N-2,..,1 往返
+    uint8_t cycle = SCAN_ROWS > 1 ? 2 * (SCAN_ROWS - 1) : 1;
+    uint8_t row = k % cycle;
+    if (row >= SCAN_ROWS) row = cycle - row;
+    tilt = SCAN_TILT_ANGLE + row * SCAN_ROW_STEP;
+  } else if (scanMode == SCAN_SINE) {
+    float w = SCAN_VEL / half;  // 峰值角速度 = SCAN_VEL
+    pan = SCAN_CENTER_PAN + half * sin(w * t);
+    tilt = SCAN_TILT_ANGLE + SCAN_TILT_SPAN * 0.5f * (1.0f - cos(w * t * 0.382f));
+  } else {
+    if (!deadlineReached(now, scanNext)) return;
+    pan = SCAN_CENTER_PAN + (int)random(-(long)half, (long)half + 1);
+    tilt = SCAN_TILT_ANGLE + (int)random(0, SCAN_TILT_SPAN + 1);
+    float travel = fabs(pan - axisAngle(axes[AXIS_PAN])) / SCAN_VEL;
+    scanNext = now + (unsigned long)(travel * 1000.0f) + SCAN_DWELL_MS;
   }
 
+  moveAxesTo(pan, tilt, SCAN_UPDATE_INTERVAL);
+}
+
+// ============================================
+// 裝置端視覺伺服：<TRACK:ex,ey,age_ms> 送入像素誤差，每 TRACK_INTERVAL 以 PID 輸出角速度，
+// 積分為各軸指令角度後直接送出。影像之間以「拍攝後雲台已轉過的角度」
+// 修正最近一次誤差，控制迴路不受影像幀率與 PC 往返延遲抖動影響
+// ============================================
+
+struct TrackAxis {
+  PidState pid;
+  float errDeg;    // 最近一次影像的誤差（度，已換算為軸角度方向）
+  float capAngle;  // 該影像拍攝時的軸角度（由角度歷史查得）
+  float target;    // 指令角度（浮點，以 trajPosition 送出，不受整數角度限制）
+};
+
+static TrackAxis track[AXIS_COUNT];
+static PidGains trackGains = {
+  TRACK_KP_DEFAULT / 1000.0f, TRACK_KI_DEFAULT / 1000.0f, TRACK_KD_DEFAULT / 1000.0f,
+};
+static uint16_t trackMdegPerPx = TRACK_MDEG_PER_PX;
+static unsigned long trackLastUpdate = 0;
+static uint16_t trackSent[AXIS_COUNT];              // 最近一次送出的位置刻度
+
+// 角度歷史：每個控制週期記錄一次位置模型角度（0.1 度），用於查出影像拍攝當時的角度
+static int16_t trackHist[TRACK_HISTORY][AXIS_COUNT];
+static uint8_t trackHistHead = 0;
+static uint8_t trackHistCount = 0;
+
+static void trackStop() {
+  trackActive = false;
+}
+
+// 停止所有自動運動（MOVE/MOVER/HOME/STOP 與 KEY1 接手控制時呼叫）
+static void autoMotionStop() {
+  scanStop();
+  trackStop();
+}
+
+// 位置模型角度（浮點）：軌跡模式為規劃器設定點，否則依經過時間插值
+static float axisAngleF(const AxisState& a) {
+  if (trajEnabled) return a.pos;
+  unsigned long elapsed = halMillis() - a.moveStart;
+  if (elapsed >= a.moveMs) return (float)a.target;
+  return a.from + (a.target - a.from) * (float)elapsed / a.moveMs;
+}
+
+// 約 ageMs 之前的軸角度；超過歷史長度時取最舊一筆
+static float trackHistAt(uint8_t axis, uint16_t ageMs) {
+  if (trackHistCount == 0) return axisAngleF(axes[axis]);
+  uint8_t back = (ageMs + TRACK_INTERVAL / 2) / TRACK_INTERVAL;
+  if (back >= trackHistCount) back = trackHistCount - 1;
+  uint8_t i = (trackHistHead + TRACK_HISTORY - 1 - back) % TRACK_HISTORY;
+  return trackHist[i][axis] / 10.0f;
+}
+
+// 收到一筆影像誤差（ex 向右、ey 向下為正，ageMs = 拍攝至今的時間）；未追蹤時由目前角度起步
+static void trackUpdate(int ex, int ey, uint16_t ageMs) {
+  const int px[AXIS_COUNT] = { ex, TRACK_TILT_SIGN * ey };
+  if (!trackActive) {
+    scanStop();
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+      pidReset(track[i].pid);
+      track[i].target = axisAngleF(axes[i]);
+      trackSent[i] = trajPosition(track[i].target);
+    }
+    trackActive = true;
+  }
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    track[i].errDeg = px[i] * (trackMdegPerPx / 1000.0f);
+    track[i].capAngle = trackHistAt(i, ageMs);
+  }
+  trackLastUpdate = halMillis();
+}
+
+// 視覺伺服任務：記錄角度歷史；追蹤中推進 PID，直接串流設定點（時間 = TRACK_INTERVAL）。
+// 追蹤時不經軌跡規劃：PID 已限制角速度，再經 S 曲線會多一段延遲與過衝而使迴路振盪。
+// 設定點經交易引擎與讀取查詢交錯；暫存區已滿時本週期不送，下一週期以新的 PID 輸出再送
+static void taskTrack() {
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    trackHist[trackHistHead][i] = (int16_t)(axisAngleF(axes[i]) * 10.0f + 0.5f);
+  }
+  trackHistHead = (trackHistHead + 1) % TRACK_HISTORY;
+  if (trackHistCount < TRACK_HISTORY) trackHistCount++;
+
+  if (!trackActive || servoDisabled) return;
+  unsigned long now = halMillis();
+  if (now - trackLastUpdate > TRACK_TIMEOUT_MS) {
+    trackStop();  // 目標遺失：停在目前指令角度
+    return;
+  }
+
+  const float dt = TRACK_INTERVAL / 1000.0f;
+  const float deadband = TRACK_DEADBAND_PX * (trackMdegPerPx / 1000.0f);
+  const int lo[AXIS_COUNT] = { PAN_MIN_ANGLE, TILT_MIN_ANGLE };
+  const int hi[AXIS_COUNT] = { PAN_MAX_ANGLE, TILT_MAX_ANGLE };
+  uint16_t pos[AXIS_COUNT];
+  uint16_t ms[AXIS_COUNT];
+  uint8_t mask = 0;
+
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    TrackAxis& t = track[i];
+    AxisState& a = axes[i];
+    // 影像之間的插值：拍攝後雲台已朝目標轉過的角度，從量得的誤差中扣除
+    float err = t.errDeg - (axisAngleF(a) - t.capAngle);
+    float vel = pidStep(t.pid, trackGains, err, dt, deadband, TRACK_D_ALPHA, TRACK_MAX_VEL);
+    t.target += vel * dt;
+    if (t.target < lo[i]) t.target = (float)lo[i];
+    if (t.target > hi[i]) t.target = (float)hi[i];
+
+    pos[i] = trajPosition(t.target);
+    if (pos[i] == trackSent[i]) continue;
+    ms[i] = TRACK_INTERVAL;
+    mask |= 1 << i;
+  }
+  if (!sendAxisMoves(pos, ms, mask)) return;
+
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    if (!(mask & (1 << i))) continue;
+    AxisState& a = axes[i];
+    trackSent[i] = pos[i];
+    // 位置模型：直接模式為 TRACK_INTERVAL 內的線性移動，軌跡模式為已送出的靜止設定點
+    a.from = axisAngle(a);
+    a.target = (int)(track[i].target + 0.5f);
+    a.moveStart = now;
+    a.moveMs = TRACK_INTERVAL;
+    a.pos = a.sent = track[i].target;
+    a.vel = a.acc = 0.0f;
+    a.sentAt = now;
+  }
+}
+
+// 開機/重新掃描後讀取實際角度作為模型起點
+static void onAxisSeed(uint8_t ctx, const BusReply* r) {
+  if (r && r->count >= 1) axisObserve(axes[ctx], positionToAngle(r->v[0]));
+}
+
+static void seedAxisModel() {
+  busTxn.submit(BUSQ_READ_POS, panServoId, 0, BUS_TXN_TIMEOUT, onAxisSeed, AXIS_PAN);
+  busTxn.submit(BUSQ_READ_POS, tiltServoId, 0, BUS_TXN_TIMEOUT, onAxisSeed, AXIS_TILT);
+}
+
+// ============================================
+// 總線讀取請求
+// ============================================
+
+static void sendPosFrame(int pan, int tilt) {
+  uint8_t payload[4];
+  writeLe16(payload, pan);
+  writeLe16(payload + 2, tilt);
+  sendFrame(BIN_RSP_POS, payload, sizeof(payload));
+}
+
+// 各讀取欄位的 JSON 鍵（依 ReadField 順序，STATUS 與遙測推送共用）
+static const char FIELD_KEY_PAN[] PROGMEM = "pan";
+static const char FIELD_KEY_TILT[] PROGMEM = "tilt";
+static const char FIELD_KEY_PAN_TEMP[] PROGMEM = "pan_temp";
+static const char FIELD_KEY_TILT_TEMP[] PROGMEM = "tilt_temp";
+static const char FIELD_KEY_PAN_VOLT[] PROGMEM = "pan_voltage";
+static const char FIELD_KEY_TILT_VOLT[] PROGMEM = "tilt_voltage";
+
+static const char* const FIELD_KEYS[FIELD_COUNT] PROGMEM = {
+  FIELD_KEY_PAN, FIELD_KEY_TILT,
+  FIELD_KEY_PAN_TEMP, FIELD_KEY_TILT_TEMP,
+  FIELD_KEY_PAN_VOLT, FIELD_KEY_TILT_VOLT,
+};
+
+// 讀取結果輸出：POS（JSON 或二進位 POS 幀）
+static void emitPos(const ReadJob& job) {
+  if (job.reply.binary) {
+    sendPosFrame(job.val[FIELD_PAN_ANGLE], job.val[FIELD_TILT_ANGLE]);
+    return;
+  }
+  json.begin()
+      .field(PSTR("pan"), job.val[FIELD_PAN_ANGLE])
+      .field(PSTR("tilt"), job.val[FIELD_TILT_ANGLE])
+      .end();
+}
+
+// 讀取結果輸出：STATUS（JSON 或二進位 STATUS 幀）
+static void emitStatus(const ReadJob& job) {
+  if (job.reply.binary) {
+    uint8_t payload[FIELD_COUNT * 2];
+    for (uint8_t i = 0; i < FIELD_COUNT; i++) writeLe16(payload + i * 2, job.val[i]);
+    sendFrame(BIN_RSP_STATUS, payload, sizeof(payload));
+    return;
+  }
+  json.begin();
+  for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+    json.field((const char*)pgm_read_ptr(&FIELD_KEYS[f]), job.val[f]);
+  }
+  json.end();
+}
+
+// 讀取結果輸出：單一舵機 READANGLE / READVOLTEMP
+static void emitSingleRead(const ReadJob& job) {
+  json.begin().field(PSTR("id"), job.id);
+  if (job.type == JOB_READ_ANGLE) {
+    json.field(PSTR("angle"), job.val[FIELD_PAN_ANGLE]);
+  } else {
+    json.field(PSTR("voltage"), job.val[FIELD_PAN_VOLT]).field(PSTR("temp"), job.val[FIELD_PAN_TEMP]);
+  }
+  json.end();
+}
+
+// 讀取結果輸出：遙測推送（只含訂閱欄位；逾時欄位為 -1）
+// 欄位 f 屬於 BIN_SUB_* 位元 (1 << (f >> 1))：角度 / 溫度 / 電壓各兩軸
+static void emitTelemetry(const ReadJob& job) {
+  subInFlight = false;
+  if (subFields == 0) return;  // 採樣期間已取消訂閱
+
+  uint8_t fields = (uint8_t)job.id;
+  if (job.reply.binary) {
+    uint8_t payload[3 + FIELD_COUNT * 2];
+    uint8_t n = 3;
+    payload[0] = fields;
+    writeLe16(payload + 1, (int16_t)(uint16_t)subSampledAt);
+    for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+      if (!(fields & (1 << (f >> 1)))) continue;
+      writeLe16(payload + n, job.val[f]);
+      n += 2;
+    }
+    sendFrame(BIN_RSP_TELEMETRY, payload, n);
+    return;
+  }
+  json.begin().field(PSTR("tm"), subSampledAt);
+  for (uint8_t f = 0; f < FIELD_COUNT; f++) {
+    if (!(fields & (1 << (f >> 1)))) continue;
+    json.field((const char*)pgm_read_ptr(&FIELD_KEYS[f]), job.val[f]);
+  }
+  json.end();
+}
+
+// 總線交易完成回呼：ctx 高位為 jobs[] 索引，低 3 位為欄位
+static void onJobReply(uint8_t ctx, const BusReply* r) {
+  ReadJob& job = jobs[ctx >> 3];
+  uint8_t field = ctx & 0x07;
+  boolean volTemp = (field == FIELD_PAN_TEMP || field == FIELD_TILT_TEMP);
+
+  if (!r || r->count < (volTemp ? 2 : 1)) {
+    job.failed = true;
+  } else if (volTemp) {
+    job.val[field + 2] = r->v[0];  // 電壓（*_VOLT 與 *_TEMP 相隔 2）
+    job.val[field] = r->v[1];      // 溫度
+  } else {
+    job.val[field] = positionToAngle(r->v[0]);
+    // 雙軸讀取同時校正位置模型（FIELD_*_ANGLE 與 AXIS_* 索引一致）
+    if (job.type != JOB_READ_ANGLE) axisObserve(axes[field], job.val[field]);
+  }
+  if (--job.pending > 0) return;
+
+  if (job.type == JOB_TELEMETRY) {
+    emitTelemetry(job);  // 逾時不中斷訂閱，照常推送
+  } else if (job.failed) {
+    sendErrorTo(job.reply, PSTR("Bus read timeout"));
+  } else if (job.type == JOB_POS) {
+    emitPos(job);
+  } else if (job.type == JOB_STATUS) {
+    emitStatus(job);
+  } else {
+    emitSingleRead(job);
+  }
+  if (job.type != JOB_TELEMETRY) latHist[LAT_CMD_READ].record(halMicros() - job.rxAt);
+  job.type = JOB_FREE;
+}
+
+// 配置一個讀取請求並預留 txns 筆交易；忙碌時返回 NULL
+static ReadJob* allocJob(uint8_t type, uint8_t txns) {
+  if (busTxn.freeSlots() >= txns) {
+    for (uint8_t i = 0; i < BUS_JOB_SLOTS; i++) {
+      ReadJob& job = jobs[i];
+      if (job.type != JOB_FREE) continue;
+      job.type = type;
+      job.pending = 0;
+      job.failed = false;
+      job.reply = reply;
+      job.id = 0;
+      for (uint8_t f = 0; f < FIELD_COUNT; f++) job.val[f] = -1;
+      job.rxAt = latRxAt;
+      if (type != JOB_TELEMETRY) latAsync = true;
+      return &job;
+    }
+  }
+  return NULL;
+}
+
+// 同 allocJob，忙碌時回覆錯誤
+static ReadJob* startJob(uint8_t type, uint8_t txns) {
+  ReadJob* job = allocJob(type, txns);
+  if (!job) sendError(MSG_BUS_BUSY);
+  return job;
+}
+
+// 為讀取請求提交一筆總線查詢，結果寫入 field
+static void jobQuery(ReadJob& job, uint8_t query, uint8_t id, uint8_t field) {
+  job.pending++;
+  busTxn.submit(query, id, 0, BUS_TXN_TIMEOUT, onJobReply, (uint8_t)(((&job - jobs) << 3) | field));
+  if (job.type != JOB_TELEMETRY) latBusQueued();
+}
+
+// 驗證結果輸出
+static void finishVerify(boolean panOk, boolean tiltOk) {
   servoIdDetected = true;
 
-  // 驗證結果
   if (panOk && tiltOk) {
-    Serial.println("{\"status\":\"ok\",\"message\":\"舵機驗證成功\",\"pan_id\":1,\"tilt_id\":2}");
+    pcOut.println(F("{\"status\":\"ok\",\"message\":\"舵機驗證成功\",\"pan_id\":1,\"tilt_id\":2}"));
   } else {
-    Serial.print("{\"status\":\"error\",\"message\":\"舵機驗證失敗\",\"pan_ok\":");
-    Serial.print(panOk ? "true" : "false");
-    Serial.print(",\"tilt_ok\":");
-    Serial.print(tiltOk ? "true" : "false");
-    Serial.println("}");
+    json.begin()
+        .fieldStrP(PSTR("status"), PSTR("error"))
+        .fieldStrP(PSTR("message"), PSTR("舵機驗證失敗"))
+        .fieldBool(PSTR("pan_ok"), panOk)
+        .fieldBool(PSTR("tilt_ok"), tiltOk)
+        .end();
 
     if (!panOk) {
       panServoId = 0;
@@ -248,71 +1037,90 @@ static void verifyServoPresence() {
       tiltServoId = 0;
     }
   }
+
+  if (verifyDoneHook) {
+    void (*done)() = verifyDoneHook;
+    verifyDoneHook = NULL;
+    done();
+  }
 }
 
-static void sendBus(const char* cmd) {
-  // 將 #...! 指令送往總線
-  BUS_SERIAL.print(cmd);
-  BUS_SERIAL.flush();
+// 驗證查詢完成：ctx 0 = Pan，1 = Tilt；任何電壓回應即表示舵機存在
+static void onVerifyReply(uint8_t ctx, const BusReply* r) {
+  if (ctx == 0) verifyPanOk = (r != NULL);
+  else verifyTiltOk = (r != NULL);
+  if (--verifyPending == 0) finishVerify(verifyPanOk, verifyTiltOk);
 }
 
-// 角度轉位置函數
-static uint16_t angleToPosition(int angle) {
-  if (angle < 0) angle = 0;
-  if (angle > SERVO_MAX_ANGLE) angle = SERVO_MAX_ANGLE;
-  return (uint16_t)map(angle, 0, SERVO_MAX_ANGLE, 0, 1000);
+// 驗證預設舵機 ID（只檢查電壓是否存在）
+// 非阻塞：Pan、Tilt 查詢一次提交，完成後呼叫 done（可為 NULL）
+static void verifyServoPresence(void (*done)()) {
+  pcOut.println(F("{\"status\":\"info\",\"message\":\"驗證舵機電壓（預設ID）\"}"));
+
+  // 使用預設 ID
+  panServoId = DEFAULT_PAN_SERVO_ID;    // 預設 ID 1（水平 Pan）
+  tiltServoId = DEFAULT_TILT_SERVO_ID;  // 預設 ID 2（垂直 Tilt）
+  verifyPanOk = verifyTiltOk = false;
+  verifyDoneHook = done;
+
+  sendInfoId(PSTR("檢查 Pan 舵機"), PSTR("id"), panServoId);
+  sendInfoId(PSTR("檢查 Tilt 舵機"), PSTR("id"), tiltServoId);
+
+  verifyPending = 2;
+  busTxn.submit(BUSQ_READ_VOLTEMP, panServoId, 0, SERVO_VERIFY_WAIT, onVerifyReply, 0);
+  busTxn.submit(BUSQ_READ_VOLTEMP, tiltServoId, 0, SERVO_VERIFY_WAIT, onVerifyReply, 1);
+}
+
+// CONFIGSERVO 結果輸出
+static void onConfigReply(uint8_t ctx, const BusReply* r) {
+  configPending = false;
+  if (r) {
+    json.begin()
+        .fieldStrP(PSTR("status"), PSTR("ok"))
+        .fieldStrP(PSTR("message"), PSTR("舵機硬件ID配置命令已發送"))
+        .field(PSTR("target_id"), configTargetId)
+        .end();
+    pcOut.println(F("{\"status\":\"info\",\"message\":\"請重啟Arduino以使配置生效\"}"));
+  } else {
+    json.begin()
+        .fieldStrP(PSTR("status"), PSTR("warning"))
+        .fieldStrP(PSTR("message"), PSTR("未收到舵機回應，但命令已發送"))
+        .field(PSTR("target_id"), configTargetId)
+        .end();
+    pcOut.println(F("{\"status\":\"info\",\"message\":\"請重啟Arduino確認配置\"}"));
+  }
 }
 
 // ============================================
-// 命令處理函數
+// 命令處理函數（統一簽名，參數已由 cmdScanArgs 依命令表格式解析）
 // ============================================
 
-// 處理 LED 命令
-static void handleLed(const char* params) {
-  char paramsCopy[16];
-  strncpy(paramsCopy, params, 15);
-  paramsCopy[15] = '\0';
-  toUpperCase(paramsCopy);
+// 處理 RAW 命令：原樣透傳到總線
+static void handleRaw(const CmdArgs& args) {
+  if (!sendBus(args.text)) sendError(MSG_BUS_BUSY);
+}
 
-  if (strcmp(paramsCopy, "ON") == 0) {
-    digitalWrite(LED_PIN, LOW);
-  } else {
-    digitalWrite(LED_PIN, HIGH);
-  }
-  Serial.println("{\"status\":\"ok\",\"message\":\"LED\"}");
+// 處理 LED 命令（LED 低電位點亮）
+static void handleLed(const CmdArgs& args) {
+  halDigitalWrite(LED_PIN, args.v[0] ? LOW : HIGH);
+  sendOkMsg(PSTR("LED"));
 }
 
 // 處理 BEEP 命令
-static void handleBeep() {
-  beep_short3();
-  Serial.println("{\"status\":\"ok\",\"message\":\"BEEP\"}");
+static void handleBeep(const CmdArgs& args) {
+  beepStart(3);
+  sendOkMsg(PSTR("BEEP"));
 }
 
 // 處理 LASER 命令
-static void handleLaser(const char* params) {
-  char paramsCopy[16];
-  strncpy(paramsCopy, params, 15);
-  paramsCopy[15] = '\0';
-  toUpperCase(paramsCopy);
-
-  if (strcmp(paramsCopy, "ON") == 0) {
-    digitalWrite(LASER_PIN, HIGH);  // 雷射開啟
-    Serial.println("{\"status\":\"ok\",\"message\":\"LASER_ON\"}");
-  } else if (strcmp(paramsCopy, "OFF") == 0) {
-    digitalWrite(LASER_PIN, LOW);   // 雷射關閉
-    Serial.println("{\"status\":\"ok\",\"message\":\"LASER_OFF\"}");
-  } else {
-    sendError("Invalid parameter (ON/OFF)");
-  }
+static void handleLaser(const CmdArgs& args) {
+  halDigitalWrite(LASER_PIN, args.v[0] ? HIGH : LOW);  // HIGH = 雷射開啟
+  sendOkMsg(args.v[0] ? PSTR("LASER_ON") : PSTR("LASER_OFF"));
 }
 
-// 處理 SPEED 命令
-static void handleSpeed(const char* params) {
-  int val;
-  if (!parseIntParam(params, val)) {
-    sendError("Invalid parameter");
-    return;
-  }
+// 處理 SPEED 命令（1-100），換算為舵機移動時間
+static void handleSpeed(const CmdArgs& args) {
+  int val = args.v[0];
   if (val < 1) val = 1;
   if (val > 100) val = 100;
   moveSpeed = val;
@@ -322,447 +1130,700 @@ static void handleSpeed(const char* params) {
 
 // 處理 CONFIGSERVO 命令 - 修改舵機硬件 ID
 // 用法：<CONFIGSERVO:id> 發送廣播命令 #255PIDXXX! 修改舵機硬件 ID
-static void handleConfigServo(const char* params) {
-  int servoId = -1;
-  if (!parseIntParam(params, servoId)) {
-    sendError("Invalid parameter");
+static void handleConfigServo(const CmdArgs& args) {
+  int servoId = args.v[0];
+  if (!isValidServoId(servoId)) {
+    sendError(PSTR("Invalid servo ID (1-254)"));
     return;
   }
-  if (!isValidServoId(servoId)) {
-    sendError("Invalid servo ID (1-254)");
+  if (configPending || busTxn.freeSlots() == 0) {
+    sendError(MSG_BUS_BUSY);
     return;
   }
 
-  Serial.print("{\"status\":\"info\",\"message\":\"配置舵機硬件ID\",\"target_id\":");
-  Serial.print(servoId);
-  Serial.println("}");
+  sendInfoId(PSTR("配置舵機硬件ID"), PSTR("target_id"), servoId);
 
   // 發送廣播命令修改舵機硬件 ID
   // #255PIDXXX! 其中 XXX 是目標舵機 ID
-  char buf[16];
-  snprintf(buf, sizeof(buf), "#255PID%03d!", servoId);
-  sendBus(buf);
+  // 等待舵機確認（非阻塞，結果由 onConfigReply 輸出）
+  configPending = true;
+  configTargetId = servoId;
+  busTxn.submit(BUSQ_SET_ID, BUS_ID_ANY, servoId, SERVO_CONFIG_WAIT, onConfigReply, 0);
+}
 
-  delay(300);  // 等待舵機確認
+// 處理 MOVE/MOVETO 命令（絕對移動）
+static void handleMove(const CmdArgs& args) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  autoMotionStop();
+  if (!moveAxesTo(args.v[0], args.v[1])) { sendError(MSG_BUS_BUSY); return; }
+  sendOk();
+}
 
-  boolean foundId = false;
-  while (BUS_SERIAL.available()) {
-    char c = (char)BUS_SERIAL.read();
-    if (c == '#') {
-      foundId = true;
-      break;
+// 處理 STOP 命令
+static void handleStop(const CmdArgs& args) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  autoMotionStop();
+  char buf[2 * BUS_FRAME_MAX];
+  snprintf_P(buf, sizeof(buf), PSTR("#%03dPDST!#%03dPDST!"), panServoId, tiltServoId);
+  if (!sendBus(buf)) { sendError(MSG_BUS_BUSY); return; }
+  axisHold(axes[AXIS_PAN]);
+  axisHold(axes[AXIS_TILT]);
+  sendOk();
+}
+
+// 處理 HOME 命令
+static void handleHome(const CmdArgs& args) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  autoMotionStop();
+  if (!moveAxesTo(PAN_INIT_ANGLE, TILT_INIT_ANGLE)) { sendError(MSG_BUS_BUSY); return; }
+  sendOk();
+}
+
+// 從總線讀取雙軸實際角度（兩筆查詢一次提交），並校正位置模型
+static void readPosFromBus() {
+  ReadJob* job = startJob(JOB_POS, 2);
+  if (!job) return;
+  jobQuery(*job, BUSQ_READ_POS, panServoId, FIELD_PAN_ANGLE);
+  jobQuery(*job, BUSQ_READ_POS, tiltServoId, FIELD_TILT_ANGLE);
+}
+
+// 處理 POS/GETPOS 命令：由位置模型立即回覆；<POS:VERIFY> 改為從總線讀取
+static void handleGetPos(const CmdArgs& args) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  if (args.count > 0) {
+    bool verify = cmdArgIs(args, 0, cmdHash("VERIFY")) || (args.kind[0] == ARG_INT && args.v[0] == 1);
+    if (args.count == 1 && verify) {
+      readPosFromBus();
+    } else {
+      sendError(MSG_INVALID_PARAM);
     }
+    return;
   }
 
-  // 清空剩餘回應
-  while (BUS_SERIAL.available()) {
-    BUS_SERIAL.read();
+  const AxisState& pan = axes[AXIS_PAN];
+  const AxisState& tilt = axes[AXIS_TILT];
+  if (reply.binary) {
+    sendPosFrame(axisAngle(pan), axisAngle(tilt));
+    return;
   }
+  json.begin()
+      .field(PSTR("pan"), axisAngle(pan))
+      .field(PSTR("tilt"), axisAngle(tilt))
+      .fieldBool(PSTR("moving"), axisMoving(pan) || axisMoving(tilt))
+      .end();
+}
 
-  if (foundId) {
-    Serial.print("{\"status\":\"ok\",\"message\":\"舵機硬件ID配置命令已發送\",\"target_id\":");
-    Serial.print(servoId);
-    Serial.println("}");
-    Serial.println("{\"status\":\"info\",\"message\":\"請重啟Arduino以使配置生效\"}");
-  } else {
-    Serial.print("{\"status\":\"warning\",\"message\":\"未收到舵機回應，但命令已發送\",\"target_id\":");
-    Serial.print(servoId);
-    Serial.println("}");
-    Serial.println("{\"status\":\"info\",\"message\":\"請重啟Arduino確認配置\"}");
-  }
+// 處理 READ/READPOS 命令（強制從總線讀取）
+static void handleReadPos(const CmdArgs& args) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  readPosFromBus();
 }
 
-// 處理 MOVE/MOVETO 命令
-static void handleMove(const char* params) {
-  if (servoDisabled) { sendError("Servo disabled"); return; }
-  int panAngle, tiltAngle;
-  if (!parseTwoInts(params, panAngle, tiltAngle)) {
-    sendError("Invalid parameter");
+// 處理 STATUS/INFO/TEMP/VOLT 命令（雙軸位置與電壓溫度四筆查詢一次提交，由交易引擎依序送出）
+static void handleStatus(const CmdArgs& args) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  ReadJob* job = startJob(JOB_STATUS, 4);
+  if (!job) return;
+  jobQuery(*job, BUSQ_READ_POS, panServoId, FIELD_PAN_ANGLE);
+  jobQuery(*job, BUSQ_READ_VOLTEMP, panServoId, FIELD_PAN_TEMP);
+  jobQuery(*job, BUSQ_READ_POS, tiltServoId, FIELD_TILT_ANGLE);
+  jobQuery(*job, BUSQ_READ_VOLTEMP, tiltServoId, FIELD_TILT_TEMP);
+}
+
+// 處理 GETINFO 命令 - 返回舵機ID和角度限制（簡單版本，不涉及聚合讀取）
+static void handleGetInfo(const CmdArgs& args) {
+  json.begin()
+      .fieldStrP(PSTR("status"), PSTR("ok"))
+      .fieldStrP(PSTR("message"), PSTR("System Info"))
+      .field(PSTR("pan_id"), panServoId)
+      .field(PSTR("tilt_id"), tiltServoId)
+      .field(PSTR("pan_min"), PAN_MIN_ANGLE)
+      .field(PSTR("pan_max"), PAN_MAX_ANGLE)
+      .field(PSTR("tilt_min"), TILT_MIN_ANGLE)
+      .field(PSTR("tilt_max"), TILT_MAX_ANGLE)
+      .field(PSTR("pc_rx_overflow"), readOverflows(pcRx.overflows))
+      .field(PSTR("bus_rx_overflow"), readOverflows(busRx.overflows))
+      .field(PSTR("pc_tx_hwm"), pcOut.highWater())
+      .field(PSTR("bus_tx_hwm"), busOut.highWater())
+      .fieldStrP(PSTR("firmware_version"), PSTR(FIRMWARE_VERSION))
+      .end();
+}
+
+// 單一舵機讀取（READANGLE / READVOLTEMP 共用）
+static void startSingleRead(uint8_t type, uint8_t query, uint8_t field, int id) {
+  if (!isValidServoId(id)) {
+    sendError(MSG_INVALID_PARAM);
     return;
   }
+  ReadJob* job = startJob(type, 1);
+  if (!job) return;
+  job->id = id;
+  jobQuery(*job, query, id, field);
+}
 
-  // 限制角度範圍：使用 config.h 定義的常數
-  if (panAngle < PAN_MIN_ANGLE) panAngle = PAN_MIN_ANGLE;
-  if (panAngle > PAN_MAX_ANGLE) panAngle = PAN_MAX_ANGLE;
-  if (tiltAngle < TILT_MIN_ANGLE) tiltAngle = TILT_MIN_ANGLE;  // 安全限制
-  if (tiltAngle > TILT_MAX_ANGLE) tiltAngle = TILT_MAX_ANGLE;  // 安全限制
-
-  uint16_t panPos = angleToPosition(panAngle);
-  uint16_t tiltPos = angleToPosition(tiltAngle);
-  char buf[32];
-  snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", panServoId, panPos, moveTime);
-  sendBus(buf);
-  snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", tiltServoId, tiltPos, moveTime);
-  sendBus(buf);
-  sendOk();
+// 處理 READANGLE 命令
+static void handleReadAngle(const CmdArgs& args) {
+  startSingleRead(JOB_READ_ANGLE, BUSQ_READ_POS, FIELD_PAN_ANGLE, args.v[0]);
 }
 
-// 處理 STOP 命令
-static void handleStop() {
-  if (servoDisabled) { sendError("Servo disabled"); return; }
-  char buf[24];
-  snprintf(buf, sizeof(buf), "#%03dPDST!", panServoId);
-  sendBus(buf);
-  snprintf(buf, sizeof(buf), "#%03dPDST!", tiltServoId);
-  sendBus(buf);
-  sendOk();
+// 處理 READVOLTEMP 命令
+static void handleReadVolTemp(const CmdArgs& args) {
+  startSingleRead(JOB_READ_VOLTEMP, BUSQ_READ_VOLTEMP, FIELD_PAN_TEMP, args.v[0]);
 }
 
-// 處理 HOME 命令
-static void handleHome() {
-  if (servoDisabled) { sendError("Servo disabled"); return; }
-  uint16_t panPos = angleToPosition(PAN_INIT_ANGLE);
-  uint16_t tiltPos = angleToPosition(TILT_INIT_ANGLE);
-  char buf[32];
-  snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", panServoId, panPos, moveTime);
-  sendBus(buf);
-  snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", tiltServoId, tiltPos, moveTime);
-  sendBus(buf);
+// 處理 MOVER/MOVEBY 命令（相對移動：以位置模型的目前估算角度為基準）
+static void handleMoveBy(const CmdArgs& args) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  autoMotionStop();
+  if (!moveAxesTo(axisAngle(axes[AXIS_PAN]) + args.v[0], axisAngle(axes[AXIS_TILT]) + args.v[1])) {
+    sendError(MSG_BUS_BUSY);
+    return;
+  }
   sendOk();
 }
 
-// 處理 POS/GETPOS 命令（啟動聚合讀取雙軸角度）
-static void handleGetPos() {
-  if (servoDisabled) { sendError("Servo disabled"); return; }
-  aggType = AGG_POS_BOTH;
-  aggPhase = 0;
-  aggPanAngle = aggTiltAngle = -1;
-  aggTimeout = millis() + AGG_CMD_TIMEOUT;
-  clearBuf(busBuf, busBufLen);
+// 處理 BINARY 命令：啟用/停用二進位幀協議
+static void handleBinary(const CmdArgs& args) {
+  binaryEnabled = args.v[0] != 0;
+  sendOkMsg(binaryEnabled ? PSTR("BINARY_ON") : PSTR("BINARY_OFF"));
+}
 
-  char buf[24];
-  snprintf(buf, sizeof(buf), "#%03dPRAD!", panServoId);
-  sendBus(buf);
+// 處理 TRAJ 命令：啟用/停用軌跡規劃（停用時 MOVE 類命令直接送出單幀）
+static void handleTraj(const CmdArgs& args) {
+  for (uint8_t i = 0; i < AXIS_COUNT; i++) {
+    AxisState& a = axes[i];
+    int now = axisAngle(a);
+    axisRest(a, now);
+    a.sent = a.pos;
+  }
+  trajEnabled = args.v[0] != 0;
+  sendOkMsg(trajEnabled ? PSTR("TRAJ_ON") : PSTR("TRAJ_OFF"));
 }
 
-// 處理 STATUS/INFO 命令（啟動聚合讀取雙軸完整狀態）
-static void handleStatus() {
-  if (servoDisabled) { sendError("Servo disabled"); return; }
-  aggType = AGG_STATUS_BOTH;
-  aggPhase = 0;
-  aggPanAngle = aggTiltAngle = -1;
-  aggPanVolt = aggTiltVolt = -1;
-  aggPanTemp = aggTiltTemp = -1;
-  aggTimeout = millis() + AGG_CMD_TIMEOUT;
-  clearBuf(busBuf, busBufLen);
+// 處理 SCAN 命令：<SCAN> / <SCAN:LINEAR|SINE|RANDOM> 啟動裝置端掃描，<SCAN:OFF> 停止；
+// 任何 MOVE/MOVER/HOME/STOP 命令立即中止掃描
+static void handleScan(const CmdArgs& args) {
+  uint8_t mode;
+  if (args.count == 0 || (args.count == 1 && cmdArgIs(args, 0, cmdHash("LINEAR")))) mode = SCAN_LINEAR;
+  else if (args.count == 1 && cmdArgIs(args, 0, cmdHash("SINE"))) mode = SCAN_SINE;
+  else if (args.count == 1 && cmdArgIs(args, 0, cmdHash("RANDOM"))) mode = SCAN_RANDOM;
+  else if (args.count == 1 && cmdArgIs(args, 0, cmdHash("OFF"))) mode = SCAN_OFF;
+  else { sendError(PSTR("Invalid parameter (LINEAR/SINE/RANDOM/OFF)")); return; }
+
+  if (mode != SCAN_OFF && servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+  if (mode != SCAN_OFF) trackStop();
+  scanMode = mode;
+  scanStart = scanNext = halMillis();
+  if (mode == SCAN_RANDOM) randomSeed(halMicros());
+  sendOkMsg(mode == SCAN_OFF ? PSTR("SCAN_OFF") : PSTR("SCAN_ON"));
+}
 
-  char buf[24];
-  snprintf(buf, sizeof(buf), "#%03dPRAD!", panServoId);
-  sendBus(buf);
+// 前 n 個參數皆為逗號分隔的整數
+static bool argsAreInts(const CmdArgs& args, uint8_t n) {
+  for (uint8_t i = 0; i < n; i++) {
+    if (args.kind[i] != ARG_INT || (i > 0 && args.sep[i] != ',')) return false;
+  }
+  return true;
 }
 
-// 處理 GETINFO 命令 - 返回舵機ID和角度限制（簡單版本，不涉及聚合讀取）
-static void handleGetInfo() {
-  Serial.print("{\"status\":\"ok\",\"message\":\"System Info\",");
-  Serial.print("\"pan_id\":");
-  Serial.print(panServoId);
-  Serial.print(",\"tilt_id\":");
-  Serial.print(tiltServoId);
-  Serial.print(",\"pan_min\":");
-  Serial.print(PAN_MIN_ANGLE);
-  Serial.print(",\"pan_max\":");
-  Serial.print(PAN_MAX_ANGLE);
-  Serial.print(",\"tilt_min\":");
-  Serial.print(TILT_MIN_ANGLE);
-  Serial.print(",\"tilt_max\":");
-  Serial.print(TILT_MAX_ANGLE);
-  Serial.print(",\"firmware_version\":\"");
-  Serial.print(FIRMWARE_VERSION);
-  Serial.println("\"}");
+// 視覺伺服誤差輸入；文字與二進位命令共用（不回覆，由呼叫端回覆）
+static bool trackInput(int ex, int ey, long ageMs) {
+  if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return false; }
+  if (ageMs < 0) ageMs = 0;
+  if (ageMs > 1000) ageMs = 1000;
+  trackUpdate(ex, ey, (uint16_t)ageMs);
+  return true;
 }
 
-// 處理 READANGLE 命令
-static void handleReadAngle(const char* params) {
-  int id;
-  if (!parseIntParam(params, id) || !isValidServoId(id)) {
-    sendError("Invalid parameter");
+// 處理 TRACK 命令：<TRACK:ex,ey[,age_ms]> 送入目標相對影像中心的像素誤差
+// （ex 向右、ey 向下為正，age_ms = 影像拍攝至今的時間），<TRACK:OFF> 停止
+static void handleTrack(const CmdArgs& args) {
+  if (args.count == 1 && cmdArgIs(args, 0, cmdHash("OFF"))) {
+    trackStop();
+    sendOkMsg(PSTR("TRACK_OFF"));
+    return;
+  }
+  if ((args.count != 2 && args.count != 3) || !argsAreInts(args, args.count)) {
+    sendError(MSG_INVALID_PARAM);
     return;
   }
+  if (trackInput(args.v[0], args.v[1], args.count == 3 ? args.v[2] : 0)) sendOk();
+}
 
-  char buf[24];
-  snprintf(buf, sizeof(buf), "#%03dPRAD!", id);
-  lastBusCmd = BUS_READ_ANGLE;
-  lastBusId = id;
-  clearBuf(busBuf, busBufLen);
-  sendBus(buf);
+// 處理 TRACKPID 命令：<TRACKPID> 查詢、<TRACKPID:kp,ki,kd[,mdeg_per_px]> 設定
+// （增益為 ×0.001 的整數：kp /秒、ki /秒²、kd 無單位；mdeg_per_px = 每像素毫度）
+static void handleTrackPid(const CmdArgs& args) {
+  if (args.count != 0) {
+    if ((args.count != 3 && args.count != 4) || !argsAreInts(args, args.count)) {
+      sendError(MSG_INVALID_PARAM);
+      return;
+    }
+    for (uint8_t i = 0; i < args.count; i++) {
+      if (args.v[i] < 0) { sendError(MSG_INVALID_PARAM); return; }
+    }
+    trackGains.kp = args.v[0] / 1000.0f;
+    trackGains.ki = args.v[1] / 1000.0f;
+    trackGains.kd = args.v[2] / 1000.0f;
+    if (args.count == 4) trackMdegPerPx = (uint16_t)args.v[3];
+    for (uint8_t i = 0; i < AXIS_COUNT; i++) pidReset(track[i].pid);
+  }
+  json.begin()
+      .field(PSTR("kp"), (int)(trackGains.kp * 1000.0f + 0.5f))
+      .field(PSTR("ki"), (int)(trackGains.ki * 1000.0f + 0.5f))
+      .field(PSTR("kd"), (int)(trackGains.kd * 1000.0f + 0.5f))
+      .field(PSTR("mdeg_per_px"), (unsigned int)trackMdegPerPx)
+      .fieldBool(PSTR("active"), trackActive)
+      .end();
 }
 
-// 處理 READVOLTEMP 命令
-static void handleReadVolTemp(const char* params) {
-  int id;
-  if (!parseIntParam(params, id) || !isValidServoId(id)) {
-    sendError("Invalid parameter");
-    return;
+// 啟用（fields != 0）或取消遙測訂閱；文字與二進位命令共用
+static void subscribeTo(uint8_t fields, long period) {
+  if (fields != 0) {
+    if (servoDisabled) { sendError(MSG_SERVO_DISABLED); return; }
+    if (period < SUB_MIN_PERIOD || period > SUB_MAX_PERIOD) { sendError(MSG_INVALID_PARAM); return; }
+    subPeriod = (uint16_t)period;
+    subReply = reply;
+    subNext = halMillis();
   }
+  subFields = fields;
+  sendOkMsg(fields ? PSTR("SUBSCRIBED") : PSTR("UNSUBSCRIBED"));
+}
 
-  char buf[24];
-  snprintf(buf, sizeof(buf), "#%03dPRTV!", id);
-  lastBusCmd = BUS_READ_VOLTEMP;
-  lastBusId = id;
-  clearBuf(busBuf, busBufLen);
-  sendBus(buf);
+// 處理 SUBSCRIBE 命令：<SUBSCRIBE:POS+TEMP+VOLT,period_ms> 週期推送遙測（ALL = 全部，
+// 省略欄位 = POS，省略週期 = SUB_DEFAULT_PERIOD），<SUBSCRIBE:OFF> 取消
+static void handleSubscribe(const CmdArgs& args) {
+  uint8_t fields = 0;
+  boolean off = false;
+  uint8_t i = 0;
+  for (; i < args.count && args.sep[i] != ','; i++) {
+    if (cmdArgIs(args, i, cmdHash("POS"))) fields |= BIN_SUB_POS;
+    else if (cmdArgIs(args, i, cmdHash("TEMP"))) fields |= BIN_SUB_TEMP;
+    else if (cmdArgIs(args, i, cmdHash("VOLT"))) fields |= BIN_SUB_VOLT;
+    else if (cmdArgIs(args, i, cmdHash("ALL"))) fields |= BIN_SUB_POS | BIN_SUB_TEMP | BIN_SUB_VOLT;
+    else if (cmdArgIs(args, i, cmdHash("OFF"))) off = true;
+    else { sendError(PSTR("Invalid parameter (POS/TEMP/VOLT/ALL/OFF)")); return; }
+  }
+
+  // 週期：逗號後唯一一個整數
+  int period = SUB_DEFAULT_PERIOD;
+  if (i < args.count) {
+    if (i + 1 != args.count || args.kind[i] != ARG_INT) { sendError(MSG_INVALID_PARAM); return; }
+    period = args.v[i];
+  }
+  if (off) fields = 0;
+  else if (fields == 0) fields = BIN_SUB_POS;
+  subscribeTo(fields, period);
 }
 
-// 處理 MOVER/MOVEBY 命令（相對移動）
-static void handleMoveBy(const char* params) {
-  if (servoDisabled) { sendError("Servo disabled"); return; }
-  int panDelta, tiltDelta;
-  if (!parseTwoInts(params, panDelta, tiltDelta)) {
-    sendError("Invalid parameter");
+// 延遲直方圖的 JSON 鍵（依 LatHistId 順序）
+static const char LAT_KEY_RX_DISPATCH[] PROGMEM = "rx_dispatch";
+static const char LAT_KEY_DISPATCH_BUS[] PROGMEM = "dispatch_bus";
+static const char LAT_KEY_BUS_RTT[] PROGMEM = "bus_rtt";
+static const char LAT_KEY_CMD_LOCAL[] PROGMEM = "cmd_local";
+static const char LAT_KEY_CMD_MOTION[] PROGMEM = "cmd_motion";
+static const char LAT_KEY_CMD_READ[] PROGMEM = "cmd_read";
+
+static const char* const LAT_HIST_KEYS[LAT_HIST_COUNT] PROGMEM = {
+  LAT_KEY_RX_DISPATCH, LAT_KEY_DISPATCH_BUS, LAT_KEY_BUS_RTT,
+  LAT_KEY_CMD_LOCAL, LAT_KEY_CMD_MOTION, LAT_KEY_CMD_READ,
+};
+
+// 處理 STATS 命令：<STATS> 輸出各段延遲直方圖，<STATS:RESET> 清除
+static void handleStats(const CmdArgs& args) {
+  if (args.count == 1 && cmdArgIs(args, 0, cmdHash("RESET"))) {
+    for (uint8_t i = 0; i < LAT_HIST_COUNT; i++) latHist[i].reset();
+    sendOkMsg(PSTR("STATS RESET"));
     return;
   }
+  if (args.count != 0) { sendError(MSG_INVALID_RESET); return; }
+
+  json.begin().fieldStrP(PSTR("unit"), PSTR("us")).field(PSTR("bucket0_lt"), 1 << LAT_BUCKET_SHIFT);
+  for (uint8_t i = 0; i < LAT_HIST_COUNT; i++) {
+    const LatHist& h = latHist[i];
+    json.object((const char*)pgm_read_ptr(&LAT_HIST_KEYS[i]))
+        .field(PSTR("n"), h.count)
+        .field(PSTR("mean"), h.meanUs())
+        .field(PSTR("max"), h.maxUs)
+        .array(PSTR("hist"));
+    for (uint8_t k = 0; k < LAT_BUCKETS; k++) json.item(h.bucket[k]);
+    json.closeArray().closeObject();
+  }
+  json.end();
+}
 
-  // 讀取當前位置後加上偏移
-  int currentPan = 135;  // 預設中心
-  int currentTilt = 90;
-  int newPan = currentPan + panDelta;
-  int newTilt = currentTilt + tiltDelta;
-
-  // 限制在範圍內
-  if (newPan < 0) newPan = 0;
-  if (newPan > SERVO_MAX_ANGLE) newPan = SERVO_MAX_ANGLE;
-  if (newTilt < 0) newTilt = 0;
-  if (newTilt > 180) newTilt = 180;
-
-  uint16_t panPos = angleToPosition(newPan);
-  uint16_t tiltPos = angleToPosition(newTilt);
-  char buf[32];
-  snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", panServoId, panPos, moveTime);
-  sendBus(buf);
-  snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", tiltServoId, tiltPos, moveTime);
-  sendBus(buf);
-  sendOk();
+// 剖析輸出與清除定義於任務表之後
+static void printProfile();
+static void resetProfile();
+
+// 處理 PROFILE 命令：<PROFILE> 輸出迴圈 / 任務執行時間、看門狗餘裕與重置紀錄，<PROFILE:RESET> 清除
+static void handleProfile(const CmdArgs& args) {
+  if (args.count == 1 && cmdArgIs(args, 0, cmdHash("RESET"))) {
+    resetProfile();
+    sendOkMsg(PSTR("PROFILE RESET"));
+    return;
+  }
+  if (args.count != 0) { sendError(MSG_INVALID_RESET); return; }
+  printProfile();
+}
+
+// ============================================
+// 命令表（PROGMEM）：命令名雜湊 → 參數格式 + 處理函數，別名即多一列
+// ============================================
+
+#define CMD(name, schema, fn) { cmdHash(name), schema, fn }
+
+static constexpr CmdEntry CMD_TABLE[] PROGMEM = {
+  CMD("RAW",         ARGS_RAW,    handleRaw),
+  CMD("LED",         ARGS_SWITCH, handleLed),
+  CMD("BINARY",      ARGS_SWITCH, handleBinary),
+  CMD("TRAJ",        ARGS_SWITCH, handleTraj),
+  CMD("SCAN",        ARGS_TOKENS, handleScan),
+  CMD("SUBSCRIBE",   ARGS_TOKENS, handleSubscribe),
+  CMD("STATS",       ARGS_TOKENS, handleStats),
+  CMD("PROFILE",     ARGS_TOKENS, handleProfile),
+  CMD("TRACK",       ARGS_TOKENS, handleTrack),
+  CMD("TRACKPID",    ARGS_TOKENS, handleTrackPid),
+  CMD("BEEP",        ARGS_NONE,   handleBeep),
+  CMD("LASER",       ARGS_SWITCH, handleLaser),
+  CMD("SPEED",       ARGS_INT1,   handleSpeed),
+  CMD("CONFIGSERVO", ARGS_INT1,   handleConfigServo),
+  CMD("GETINFO",     ARGS_NONE,   handleGetInfo),
+  CMD("MOVE",        ARGS_INT2,   handleMove),
+  CMD("MOVETO",      ARGS_INT2,   handleMove),
+  CMD("STOP",        ARGS_NONE,   handleStop),
+  CMD("HOME",        ARGS_NONE,   handleHome),
+  CMD("POS",         ARGS_TOKENS, handleGetPos),
+  CMD("GETPOS",      ARGS_TOKENS, handleGetPos),
+  CMD("READ",        ARGS_NONE,   handleReadPos),
+  CMD("READPOS",     ARGS_NONE,   handleReadPos),
+  CMD("STATUS",      ARGS_NONE,   handleStatus),
+  CMD("INFO",        ARGS_NONE,   handleStatus),
+  CMD("READANGLE",   ARGS_INT1,   handleReadAngle),
+  CMD("READVOLTEMP", ARGS_INT1,   handleReadVolTemp),
+  CMD("MOVER",       ARGS_INT2,   handleMoveBy),
+  CMD("MOVEBY",      ARGS_INT2,   handleMoveBy),
+  CMD("TEMP",        ARGS_NONE,   handleStatus),
+  CMD("TEMPERATURE", ARGS_NONE,   handleStatus),
+  CMD("VOLT",        ARGS_NONE,   handleStatus),
+  CMD("VOLTAGE",     ARGS_NONE,   handleStatus),
+};
+
+#undef CMD
+
+static const uint8_t CMD_COUNT = sizeof(CMD_TABLE) / sizeof(CMD_TABLE[0]);
+static_assert(cmdTableUnique(CMD_TABLE, sizeof(CMD_TABLE) / sizeof(CMD_TABLE[0])),
+              "command name hash collision: rename a command or change CMD_HASH_SEED");
+
+// 依雜湊查表，找到時將表項從 PROGMEM 讀出到 out
+static bool findCommand(uint16_t hash, CmdEntry& out) {
+  for (uint8_t i = 0; i < CMD_COUNT; i++) {
+    if (pgm_read_word(&CMD_TABLE[i].hash) == hash) {
+      out.hash = hash;
+      out.schema = pgm_read_byte(&CMD_TABLE[i].schema);
+      out.fn = (CmdHandler)pgm_read_ptr(&CMD_TABLE[i].fn);
+      return true;
+    }
+  }
+  return false;
+}
+
+// ============================================
+// 二進位幀處理
+// ============================================
+
+// 分發一個已通過 CRC 檢查的二進位請求（與文字命令共用處理函數）
+static void handleBinaryFrame(uint8_t opcode, const uint8_t* payload, uint8_t len) {
+  reply.binary = true;
+  reply.opcode = opcode;
+
+  CmdArgs args;
+  args.count = 0;
+  args.v[0] = args.v[1] = 0;
+  args.kind[0] = args.kind[1] = ARG_INT;
+  args.sep[0] = ':';
+  args.sep[1] = ',';
+  args.text = "";
+
+  switch (opcode) {
+    case BIN_OP_PING:
+    case BIN_OP_STOP:
+    case BIN_OP_HOME:
+    case BIN_OP_STATUS:
+    case BIN_OP_TEXT:
+      if (len != 0) { sendAck(reply, BIN_STATUS_BAD_LEN); break; }
+      if (opcode == BIN_OP_PING) sendOk();
+      else if (opcode == BIN_OP_STOP) handleStop(args);
+      else if (opcode == BIN_OP_HOME) handleHome(args);
+      else if (opcode == BIN_OP_STATUS) handleStatus(args);
+      else handleBinary(args);  // v[0] = 0：退出二進位模式
+      break;
+    case BIN_OP_POS:
+      // 無 payload：位置模型；uint8 verify 非 0：從總線讀取
+      if (len > 1) { sendAck(reply, BIN_STATUS_BAD_LEN); break; }
+      if (len == 1 && payload[0] != 0) {
+        args.count = 1;
+        args.v[0] = 1;
+      }
+      handleGetPos(args);
+      break;
+    case BIN_OP_MOVE:
+    case BIN_OP_MOVEBY:
+      if (len != 4) { sendAck(reply, BIN_STATUS_BAD_LEN); break; }
+      args.count = 2;
+      args.v[0] = readLe16(payload);
+      args.v[1] = readLe16(payload + 2);
+      if (opcode == BIN_OP_MOVE) handleMove(args);
+      else handleMoveBy(args);
+      break;
+    case BIN_OP_SUBSCRIBE:
+      // uint8 fields（BIN_SUB_* 位元，0 = 取消）, uint16 period
+      if (len != 3) { sendAck(reply, BIN_STATUS_BAD_LEN); break; }
+      subscribeTo(payload[0] & (BIN_SUB_POS | BIN_SUB_TEMP | BIN_SUB_VOLT), (uint16_t)readLe16(payload + 1));
+      break;
+    case BIN_OP_TRACK:
+      // int16 ex, int16 ey, uint16 age_ms；無 payload = 停止
+      if (len == 0) {
+        trackStop();
+        sendOk();
+        break;
+      }
+      if (len != 6) { sendAck(reply, BIN_STATUS_BAD_LEN); break; }
+      if (trackInput(readLe16(payload), readLe16(payload + 2), (uint16_t)readLe16(payload + 4))) sendOk();
+      break;
+    case BIN_OP_LASER:
+    case BIN_OP_SPEED:
+      if (len != 1) { sendAck(reply, BIN_STATUS_BAD_LEN); break; }
+      args.count = 1;
+      if (opcode == BIN_OP_LASER) {
+        args.v[0] = payload[0] != 0;
+        handleLaser(args);
+      } else {
+        args.v[0] = payload[0];
+        handleSpeed(args);
+      }
+      break;
+    default:
+      sendAck(reply, BIN_STATUS_UNKNOWN);
+      break;
+  }
+
+  reply.binary = false;
+  reply.opcode = 0;
+}
+
+// 接收二進位幀的一個位元組（SYNC 之後）；收齊後校驗並分發
+static void binaryRxByte(uint8_t b) {
+  binLastByte = halMillis();
+  binBuf[binLen++] = b;
+
+  uint8_t frameLen = binBuf[0];
+  if (frameLen == 0 || frameLen > BIN_MAX_LEN) {
+    ReplyCtx bad = { true, 0 };
+    sendAck(bad, BIN_STATUS_BAD_LEN);
+    binActive = false;
+    return;
+  }
+  if (binLen < frameLen + 2) return;  // LEN + 內容 + CRC 尚未收齊
+
+  binActive = false;
+  uint8_t crc = 0;
+  for (uint8_t i = 0; i <= frameLen; i++) crc = crc8Update(crc, binBuf[i]);
+  if (crc != binBuf[frameLen + 1]) {
+    ReplyCtx bad = { true, binBuf[1] };
+    sendAck(bad, BIN_STATUS_BAD_CRC);
+    return;
+  }
+  latDispatch();
+  handleBinaryFrame(binBuf[1], binBuf + 2, frameLen - 1);
+  latDispatchDone();
 }
+
 // ============================================
 // 主命令處理函數（重構為簡潔的命令分發器）
 // ============================================
 
-static void handlePcLine(const char* line) {
+static void handlePcLine(char* line) {
   // 1) 直接透傳 #...! 指令到總線
   if (line[0] == '#') {
-    sendBus(line);
+    if (!sendBus(line)) sendError(MSG_BUS_BUSY);
     return;
   }
 
   // 2) 解析 <CMD:PARAMS> 格式
-  if (line[0] != '<' || line[strlen(line)-1] != '>') {
+  size_t len = strlen(line);
+  if (line[0] != '<' || line[len - 1] != '>') {
     return;  // 格式錯誤，靜默忽略
   }
 
-  // 提取內容（去除 < 和 >）
-  char inner[120];
-  strncpy(inner, line + 1, sizeof(inner) - 1);
-  inner[sizeof(inner) - 1] = '\0';
-  inner[strlen(inner) - 1] = '\0';  // 移除 >
+  // 就地去除 >：參數直接指向 line 內部，不另行複製
+  line[len - 1] = '\0';
 
-  // 分離命令類型和參數
-  char* colon = strchr(inner, ':');
-  char cmdType[20];
-  const char* params = "";
+  // 3) 單次掃描命令名：邊轉大寫邊計算雜湊，直到 ':' 或結尾
+  uint16_t hash;
+  const char* params = cmdScanName(line + 1, hash);
 
-  if (colon) {
-    int cmdLen = colon - inner;
-    if (cmdLen >= sizeof(cmdType)) cmdLen = sizeof(cmdType) - 1;
-    strncpy(cmdType, inner, cmdLen);
-    cmdType[cmdLen] = '\0';
-    params = colon + 1;
-  } else {
-    strncpy(cmdType, inner, sizeof(cmdType) - 1);
-    cmdType[sizeof(cmdType) - 1] = '\0';
-  }
-
-  toUpperCase(cmdType);
-
-  // 3) 命令分發（使用提取的函數）
-  if (strcmp(cmdType, "RAW") == 0) {
-    lastBusCmd = BUS_NONE;
-    lastBusId = -1;
-    sendBus(params);
-  }
-  else if (strcmp(cmdType, "LED") == 0) handleLed(params);
-  else if (strcmp(cmdType, "BEEP") == 0) handleBeep();
-  else if (strcmp(cmdType, "LASER") == 0) handleLaser(params);
-  else if (strcmp(cmdType, "SPEED") == 0) handleSpeed(params);
-  else if (strcmp(cmdType, "CONFIGSERVO") == 0) handleConfigServo(params);
-  else if (strcmp(cmdType, "GETINFO") == 0) handleGetInfo();
-  else if (strcmp(cmdType, "MOVE") == 0 || strcmp(cmdType, "MOVETO") == 0) handleMove(params);
-  else if (strcmp(cmdType, "STOP") == 0) handleStop();
-  else if (strcmp(cmdType, "HOME") == 0) handleHome();
-  else if (strcmp(cmdType, "POS") == 0 || strcmp(cmdType, "GETPOS") == 0) handleGetPos();
-  else if (strcmp(cmdType, "STATUS") == 0 || strcmp(cmdType, "INFO") == 0) handleStatus();
-  else if (strcmp(cmdType, "READANGLE") == 0) handleReadAngle(params);
-  else if (strcmp(cmdType, "READVOLTEMP") == 0) handleReadVolTemp(params);
-  else if (strcmp(cmdType, "MOVER") == 0 || strcmp(cmdType, "MOVEBY") == 0) handleMoveBy(params);
-  else if (strcmp(cmdType, "READ") == 0 || strcmp(cmdType, "READPOS") == 0) handleGetPos();
-  else if (strcmp(cmdType, "TEMP") == 0 || strcmp(cmdType, "TEMPERATURE") == 0) {
-    if (servoDisabled) { sendError("Servo disabled"); return; }
-    // 復用 STATUS 流程但只輸出溫度
-    aggType = AGG_STATUS_BOTH;
-    aggPhase = 0;
-    aggPanAngle = aggTiltAngle = -1;
-    aggPanVolt = aggTiltVolt = -1;
-    aggPanTemp = aggTiltTemp = -1;
-    aggTimeout = millis() + AGG_CMD_TIMEOUT;
-    clearBuf(busBuf, busBufLen);
-    char buf[24];
-    snprintf(buf, sizeof(buf), "#%03dPRTV!", panServoId);
-    sendBus(buf);
-  }
-  else if (strcmp(cmdType, "VOLT") == 0 || strcmp(cmdType, "VOLTAGE") == 0) {
-    if (servoDisabled) { sendError("Servo disabled"); return; }
-    // 復用 STATUS 流程但只輸出電壓
-    aggType = AGG_STATUS_BOTH;
-    aggPhase = 0;
-    aggPanAngle = aggTiltAngle = -1;
-    aggPanVolt = aggTiltVolt = -1;
-    aggPanTemp = aggTiltTemp = -1;
-    aggTimeout = millis() + AGG_CMD_TIMEOUT;
-    clearBuf(busBuf, busBufLen);
-    char buf[24];
-    snprintf(buf, sizeof(buf), "#%03dPRTV!", panServoId);
-    sendBus(buf);
+  // 4) 查表，從同一位置繼續分詞並依參數格式驗證，最後分發
+  CmdEntry cmd;
+  if (!findCommand(hash, cmd)) {
+    sendErrorCode(PSTR("Unknown command"), CMD_ERR_UNKNOWN);
+    return;
   }
-  else {
-    sendError("Unknown command");
+
+  CmdArgs args;
+  uint8_t err = cmdScanArgs(params, cmd.schema, args);
+  if (err != CMD_OK) {
+    sendErrorCode(cmd.schema == ARGS_SWITCH ? PSTR("Invalid parameter (ON/OFF)") : MSG_INVALID_PARAM, err);
+    return;
   }
+  cmd.fn(args);
 }
 
-void setup() {
-  // 禁用看門狗（防止啟動時重置）
-  wdt_disable();
-
-  setup_led();
-  setup_beep();
-  setup_laser();  // 初始化雷射控制
-  setup_keys();   // 初始化按鍵
-  setup_uart();
-  setup_bus();
+// ============================================
+// 排程任務（皆為非阻塞）
+// ============================================
 
-  Serial.print(F("{\"status\":\"info\",\"message\":\"PT2D Bridge Firmware v"));
-  Serial.print(FIRMWARE_VERSION);
-  Serial.println(F("\"}"));
-  Serial.println(F("{\"status\":\"info\",\"message\":\"PC <...> / BUS #...!\"}"));
-  beep_short3();
+// 看門狗餵狗，並記錄最長餵狗間隔（與逾時之差即為餘裕）
+static void taskWatchdog() {
+  unsigned long now = halMillis();
+  if (now - wdtLastFeed > resetRec.wdtGapMaxMs) resetRec.wdtGapMaxMs = now - wdtLastFeed;
+  wdtLastFeed = now;
+  halWatchdogReset();
+}
 
-  // 啟動時驗證預設舵機 ID 是否存在（讀取電壓確認）
-  Serial.print(F("{\"status\":\"info\",\"message\":\"等待舵機啟動中...\",\"wait_ms\":"));
-  Serial.print(SERVO_STARTUP_DELAY);
-  Serial.println(F("}"));
-  delay(SERVO_STARTUP_DELAY);  // 等待舵機啟動（默認1秒，可調整）
+// 軟停機提示（節流輸出，週期由任務表決定）
+static void taskServoNotify() {
+  if (servoDisabled) {
+    pcOut.println(F("{\"status\":\"error\",\"message\":\"舵機ID無效，舵機相關命令已禁用\"}"));
+  }
+}
 
-  verifyServoPresence();
+// 蜂鳴器圖樣播放
+static void taskBuzzer() {
+  if (beepToggles == 0) return;
+  unsigned long now = halMillis();
+  if (!deadlineReached(now, beepNext)) return;
 
-  // 檢查舵機 ID 是否有效
-  if (panServoId == 0 || tiltServoId == 0 || panServoId == tiltServoId) {
-    // 舵機設置失敗，通知上位機，啟用軟停機（不阻塞）
-    Serial.print(F("{\"status\":\"error\",\"message\":\"舵機ID設置失敗\",\"pan_id\":"));
-    Serial.print(panServoId);
-    Serial.print(F(",\"tilt_id\":"));
-    Serial.print(tiltServoId);
-    Serial.println(F("}"));
+  // 偶數段開啟、奇數段關閉（低電平觸發）
+  halDigitalWrite(BEEP_PIN, (beepToggles & 1) ? HIGH : LOW);
+  beepToggles--;
+  beepNext = now + BEEP_TOGGLE_MS;
+}
 
-    Serial.println(F("{\"status\":\"error\",\"message\":\"舵機控制已禁用，請檢查硬體連接\"}"));
+// KEY2 重新掃描完成：更新軟停機狀態
+static void onKeyRescanDone() {
+  if (panServoId != 0 && tiltServoId != 0 && panServoId != tiltServoId) {
+    servoDisabled = false;
+    seedAxisModel();
+    pcOut.print(F("{\"status\":\"ok\",\"message\":\"舵機ID已設置\",\"pan_id\":"));
+    pcOut.print(panServoId);
+    pcOut.print(F(",\"tilt_id\":"));
+    pcOut.print(tiltServoId);
+    pcOut.println(F("}"));
+  } else {
     servoDisabled = true;
+    pcOut.println(F("{\"status\":\"error\",\"message\":\"舵機ID仍無效\"}"));
   }
+}
 
-  Serial.print(F("{\"status\":\"ok\",\"message\":\"舵機ID已設置\",\"pan_id\":"));
-  Serial.print(panServoId);
-  Serial.print(F(",\"tilt_id\":"));
-  Serial.print(tiltServoId);
-  Serial.print(F(",\"pan_min\":"));
-  Serial.print(PAN_MIN_ANGLE);
-  Serial.print(F(",\"pan_max\":"));
-  Serial.print(PAN_MAX_ANGLE);
-  Serial.print(F(",\"tilt_min\":"));
-  Serial.print(TILT_MIN_ANGLE);
-  Serial.print(F(",\"tilt_max\":"));
-  Serial.print(TILT_MAX_ANGLE);
-  Serial.println(F("}"));
-
-  // 啟用看門狗定時器（2秒超時）
-  wdt_enable(WDTO_2S);
-  Serial.println(F("{\"status\":\"ok\",\"message\":\"看門狗已啟用 (2秒)\"}"));
+// KEY1 按下：移動到初始位置
+static void onKey1Press() {
+  pcOut.println(F("{\"status\":\"info\",\"message\":\"KEY1：移動到初始位置\"}"));
+  autoMotionStop();
+  moveAxesTo(PAN_INIT_ANGLE, TILT_INIT_ANGLE);
 }
 
-void loop() {
-  // 0) 重置看門狗（防止超時重啟）
-  wdt_reset();
+// KEY2 按下：重新掃描舵機 ID
+static void onKey2Press() {
+  if (verifyPending != 0 || busTxn.freeSlots() < 2) return;  // 掃描進行中或總線忙，忽略按鍵
+  pcOut.println(F("{\"status\":\"info\",\"message\":\"KEY2：重新掃描舵機ID\"}"));
+  beepStart(3);
+  verifyServoPresence(onKeyRescanDone);
+}
 
-  // 0.2) 軟停機提示（非阻塞，節流輸出）
-  if (servoDisabled) {
-    unsigned long now = millis();
-    if (now - lastErrorNotify > 3000) {
-      Serial.println(F("{\"status\":\"error\",\"message\":\"舵機ID無效，舵機相關命令已禁用\"}"));
-      lastErrorNotify = now;
+// 按鍵防抖狀態
+struct KeyState {
+  uint8_t pin;
+  uint8_t stable;           // 防抖後電平
+  uint8_t raw;              // 最近一次讀值
+  unsigned long changedAt;  // raw 最近一次變化時間
+  void (*onPress)();
+};
+
+static KeyState keys[] = {
+  { KEY1_PIN, HIGH, HIGH, 0, onKey1Press },
+  { KEY2_PIN, HIGH, HIGH, 0, onKey2Press },
+};
+
+// 按鍵掃描：電平穩定超過 KEY_DEBOUNCE_MS 才視為有效變化，按下（LOW）時觸發
+static void taskKeys() {
+  unsigned long now = halMillis();
+  for (uint8_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+    KeyState& k = keys[i];
+    uint8_t level = halDigitalRead(k.pin);
+    if (level != k.raw) {
+      k.raw = level;
+      k.changedAt = now;
+    } else if (level != k.stable && now - k.changedAt >= KEY_DEBOUNCE_MS) {
+      k.stable = level;
+      if (level == LOW) k.onPress();
     }
   }
+}
 
-  // 0.5) 檢查按鍵
-  if (digitalRead(KEY1_PIN) == LOW) {
-    // KEY1 按下：移動到初始位置
-    delay(20);  // 防抖
-    if (digitalRead(KEY1_PIN) == LOW) {
-      Serial.println(F("{\"status\":\"info\",\"message\":\"KEY1：移動到初始位置\"}"));
-      uint16_t panPos = angleToPosition(PAN_INIT_ANGLE);
-      uint16_t tiltPos = angleToPosition(TILT_INIT_ANGLE);
-      char buf[32];
-      snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", panServoId, panPos, moveTime);
-      sendBus(buf);
-      snprintf(buf, sizeof(buf), "#%03dP%04dT%04d!", tiltServoId, tiltPos, moveTime);
-      sendBus(buf);
-
-      // 等待按鍵釋放
-      while (digitalRead(KEY1_PIN) == LOW) {
-        delay(10);
-        wdt_reset();
-      }
-      delay(50);  // 防抖
-    }
+// 遙測採樣：每 subPeriod 毫秒提交一輪 PRAD/PRTV 查詢，運動設定點由交易引擎排在各筆回覆之間送出；
+// 上一輪未完成時延後，總線交易槽不足時略過本輪（不補發）
+static void taskTelemetry() {
+  if (subFields == 0 || subInFlight || servoDisabled) return;
+  unsigned long now = halMillis();
+  if (!deadlineReached(now, subNext)) return;
+  subNext += subPeriod;
+  if (deadlineReached(now, subNext)) subNext = now + subPeriod;  // 落後超過一個週期：重新對齊
+
+  boolean pos = subFields & BIN_SUB_POS;
+  boolean volTemp = subFields & (BIN_SUB_TEMP | BIN_SUB_VOLT);
+  ReadJob* job = allocJob(JOB_TELEMETRY, (pos ? 2 : 0) + (volTemp ? 2 : 0));
+  if (!job) return;
+  job->reply = subReply;
+  job->id = subFields;
+  subSampledAt = now;
+  subInFlight = true;
+  if (pos) {
+    jobQuery(*job, BUSQ_READ_POS, panServoId, FIELD_PAN_ANGLE);
+    jobQuery(*job, BUSQ_READ_POS, tiltServoId, FIELD_TILT_ANGLE);
   }
-
-  if (digitalRead(KEY2_PIN) == LOW) {
-    // KEY2 按下：重新掃描舵機 ID
-    delay(20);  // 防抖
-    if (digitalRead(KEY2_PIN) == LOW) {
-      Serial.println(F("{\"status\":\"info\",\"message\":\"KEY2：重新掃描舵機ID\"}"));
-      beep_short3();
-      verifyServoPresence();
-
-      // 更新軟停機狀態
-      if (panServoId != 0 && tiltServoId != 0 && panServoId != tiltServoId) {
-        servoDisabled = false;
-        Serial.print(F("{\"status\":\"ok\",\"message\":\"舵機ID已設置\",\"pan_id\":"));
-        Serial.print(panServoId);
-        Serial.print(F(",\"tilt_id\":"));
-        Serial.print(tiltServoId);
-        Serial.println(F("}"));
-      } else {
-        servoDisabled = true;
-        Serial.println(F("{\"status\":\"error\",\"message\":\"舵機ID仍無效\"}"));
-      }
-
-      // 等待按鍵釋放
-      while (digitalRead(KEY2_PIN) == LOW) {
-        delay(10);
-        wdt_reset();
-      }
-      delay(50);  // 防抖
-    }
+  if (volTemp) {
+    jobQuery(*job, BUSQ_READ_VOLTEMP, panServoId, FIELD_PAN_TEMP);
+    jobQuery(*job, BUSQ_READ_VOLTEMP, tiltServoId, FIELD_TILT_TEMP);
   }
+}
 
-  // 1) 檢查聚合命令超時
-  if (aggType != AGG_NONE && aggTimeout > 0 && millis() > aggTimeout) {
-    sendError("Aggregate command timeout");
-    resetAggState();
+// 讀取 PC 指令（文字以 \n 分隔；二進位幀以 SYNC 起始）
+static void taskPcRx() {
+  // 半幀逾時：丟棄並回到文字解析
+  if (binActive && halMillis() - binLastByte > BIN_FRAME_TIMEOUT) {
+    binActive = false;
   }
 
-  // 2) 讀取 PC 指令（以 \n 分隔）
-  while (Serial.available()) {
-    char c = (char)Serial.read();
+  int b;
+  while ((b = pcRx.pop()) >= 0) {
+    if (binActive) {
+      binaryRxByte((uint8_t)b);
+      continue;
+    }
+    if (binaryEnabled && pcBufLen == 0 && b == BIN_SYNC) {
+      binActive = true;
+      binLen = 0;
+      binLastByte = halMillis();
+      continue;
+    }
+
+    char c = (char)b;
     if (c == '\n' || c == '\r') {
       if (pcBufLen > 0) {
         pcBuf[pcBufLen] = '\0';  // 終止字串
+        latDispatch();
         handlePcLine(pcBuf);
+        latDispatchDone();
         clearBuf(pcBuf, pcBufLen);
       }
     } else {
@@ -771,191 +1832,234 @@ void loop() {
       } else {
         // 緩衝區滿，清空並報錯
         clearBuf(pcBuf, pcBufLen);
-        sendError("Command too long");
+        sendErrorCode(PSTR("Command too long"), CMD_ERR_TOO_LONG);
       }
     }
   }
+}
+
+// 總線回覆處理：以 '!' 或換行分段，依 ID 配對等待中的交易；無對應交易則透傳到 PC
+// 無對應交易的回覆（透傳指令的回應、確認幀等）以完整一行轉給 PC；含非可列印字元的
+// （碰撞或雜訊損毀）整段丟棄，避免插進 PC 端逐行解析的 JSON 串流
+static void forwardBusLine(char* s, uint8_t len) {
+  while (len > 0 && (s[len - 1] == '\n' || s[len - 1] == '\r')) s[--len] = '\0';
+  if (len == 0) return;
+  for (uint8_t i = 0; i < len; i++) {
+    if ((uint8_t)s[i] < 0x20 || (uint8_t)s[i] > 0x7E) return;
+  }
+  pcOut.println(s);
+}
+
+static void taskBusRx() {
+  int b;
+  while ((b = busRx.pop()) >= 0) {
+    char c = (char)b;
+    if (busBufLen == 0 && (c == '\n' || c == '\r')) continue;
 
-  // 3) 轉發總線回覆
-  if (lastBusCmd == BUS_NONE) {
-    // 若有聚合狀態，則分階段解析；否則直接透傳
-    if (aggType == AGG_NONE) {
-      forwardBusResponse();
+    busBuf[busBufLen++] = c;
+    uint8_t res = busParser.feed(c);
+    if (res == BUSP_MORE && busBufLen < sizeof(busBuf) - 1) continue;
+
+    // 回覆結束（或過長）：ID 與欄位已在接收時解出，直接配對交易
+    busBuf[busBufLen] = '\0';
+    if (res != BUSP_DONE || !busTxn.complete(busParser.reply())) {
+      forwardBusLine(busBuf, busBufLen);
     } else {
-      // 聚合命令解析
-      while (BUS_SERIAL.available()) {
-        char c = (char)BUS_SERIAL.read();
-        if (busBufLen < sizeof(busBuf) - 1) {
-          busBuf[busBufLen++] = c;
-        }
-
-        if (c == '!' || c == '\n' || c == '\r' || busBufLen >= sizeof(busBuf) - 1) {
-          busBuf[busBufLen] = '\0';
-
-          // 提取整數
-          int values[4];
-          int vcount = 0;
-          char* ptr = busBuf;
-          char num[16];
-          int numLen = 0;
-
-          while (*ptr && vcount < 4) {
-            if ((*ptr >= '0' && *ptr <= '9') || *ptr == '-') {
-              if (numLen < 15) num[numLen++] = *ptr;
-            } else {
-              if (numLen > 0) {
-                num[numLen] = '\0';
-                values[vcount++] = atoi(num);
-                numLen = 0;
-              }
-            }
-            ptr++;
-          }
-          if (numLen > 0 && vcount < 4) {
-            num[numLen] = '\0';
-            values[vcount++] = atoi(num);
-          }
-
-          // 聚合流程
-          if (aggType == AGG_POS_BOTH) {
-            if (aggPhase == 0 && vcount >= 1) {
-              aggPanAngle = values[0];
-              aggPhase = 1;
-              clearBuf(busBuf, busBufLen);
-              char buf[24];
-              snprintf(buf, sizeof(buf), "#%03dPRAD!", tiltServoId);
-              sendBus(buf);
-              break;
-            } else if (aggPhase == 1 && vcount >= 1) {
-              aggTiltAngle = values[0];
-              Serial.print("{\"pan\":");
-              Serial.print(aggPanAngle);
-              Serial.print(",\"tilt\":");
-              Serial.print(aggTiltAngle);
-              Serial.println("}");
-              resetAggState();
-              break;
-            } else {
-              Serial.print(busBuf);
-              resetAggState();
-              break;
-            }
-          } else if (aggType == AGG_STATUS_BOTH) {
-            if (aggPhase == 0 && vcount >= 1) {
-              aggPanAngle = values[0];
-              aggPhase = 1;
-              clearBuf(busBuf, busBufLen);
-              char buf[24];
-              snprintf(buf, sizeof(buf), "#%03dPRTV!", panServoId);
-              sendBus(buf);
-              break;
-            } else if (aggPhase == 1 && vcount >= 2) {
-              aggPanVolt = values[0];
-              aggPanTemp = values[1];
-              aggPhase = 2;
-              clearBuf(busBuf, busBufLen);
-              char buf[24];
-              snprintf(buf, sizeof(buf), "#%03dPRAD!", tiltServoId);
-              sendBus(buf);
-              break;
-            } else if (aggPhase == 2 && vcount >= 1) {
-              aggTiltAngle = values[0];
-              aggPhase = 3;
-              clearBuf(busBuf, busBufLen);
-              char buf[24];
-              snprintf(buf, sizeof(buf), "#%03dPRTV!", tiltServoId);
-              sendBus(buf);
-              break;
-            } else if (aggPhase == 3 && vcount >= 2) {
-              aggTiltVolt = values[0];
-              aggTiltTemp = values[1];
-              Serial.print("{\"pan\":");
-              Serial.print(aggPanAngle);
-              Serial.print(",\"tilt\":");
-              Serial.print(aggTiltAngle);
-              Serial.print(",\"pan_temp\":");
-              Serial.print(aggPanTemp);
-              Serial.print(",\"tilt_temp\":");
-              Serial.print(aggTiltTemp);
-              Serial.print(",\"pan_voltage\":");
-              Serial.print(aggPanVolt);
-              Serial.print(",\"tilt_voltage\":");
-              Serial.print(aggTiltVolt);
-              Serial.println("}");
-              resetAggState();
-              break;
-            } else {
-              Serial.print(busBuf);
-              resetAggState();
-              break;
-            }
-          }
-        }
-      }
+      latHist[LAT_BUS_RTT].record(busTxn.lastRttUs());
     }
+    clearBuf(busBuf, busBufLen);
+    busParser.reset();
+  }
+
+  // 逾時處理與補送排隊中的查詢
+  busTxn.poll(halMillis());
+  latPoll();
+}
+
+// 任務表（依序執行；PC 與總線接收每輪都執行以保證命令拾取延遲）
+static Task tasks[] = {
+  { taskWatchdog,    WDT_SERVICE_INTERVAL,  0 },
+  { taskPcRx,        0,                     0 },
+  { taskBusRx,       0,                     0 },
+  { taskScan,        SCAN_UPDATE_INTERVAL,  0 },
+  { taskTrack,       TRACK_INTERVAL,        0 },
+  { taskTrajectory,  UPDATE_INTERVAL,       0 },
+  { taskTelemetry,   0,                     0 },
+  { taskKeys,        KEY_SCAN_INTERVAL,     0 },
+  { taskBuzzer,      0,                     0 },
+  { taskServoNotify, SERVO_NOTIFY_INTERVAL, 0 },
+};
+static const uint8_t TASK_COUNT = sizeof(tasks) / sizeof(tasks[0]);
+static TaskStats taskStats[TASK_COUNT];
+
+// 任務名稱（<PROFILE> 與開機訊息用，與任務表逐列對應）
+static const char TASK_NAME_WATCHDOG[] PROGMEM = "watchdog";
+static const char TASK_NAME_PC_RX[] PROGMEM = "pc_rx";
+static const char TASK_NAME_BUS_RX[] PROGMEM = "bus_rx";
+static const char TASK_NAME_SCAN[] PROGMEM = "scan";
+static const char TASK_NAME_TRACK[] PROGMEM = "track";
+static const char TASK_NAME_TRAJECTORY[] PROGMEM = "trajectory";
+static const char TASK_NAME_TELEMETRY[] PROGMEM = "telemetry";
+static const char TASK_NAME_KEYS[] PROGMEM = "keys";
+static const char TASK_NAME_BUZZER[] PROGMEM = "buzzer";
+static const char TASK_NAME_SERVO_NOTIFY[] PROGMEM = "servo_notify";
+
+static const char* const TASK_NAMES[] PROGMEM = {
+  TASK_NAME_WATCHDOG, TASK_NAME_PC_RX, TASK_NAME_BUS_RX, TASK_NAME_SCAN, TASK_NAME_TRACK,
+  TASK_NAME_TRAJECTORY, TASK_NAME_TELEMETRY, TASK_NAME_KEYS, TASK_NAME_BUZZER, TASK_NAME_SERVO_NOTIFY,
+};
+static_assert(sizeof(TASK_NAMES) / sizeof(TASK_NAMES[0]) == sizeof(tasks) / sizeof(tasks[0]),
+              "TASK_NAMES must match tasks[]");
+
+// 任務名稱（PROGMEM）；running 亦可為 SCHED_IDLE / SCHED_SETUP
+static const char* taskName(uint8_t running) {
+  if (running < TASK_COUNT) return (const char*)pgm_read_ptr(&TASK_NAMES[running]);
+  return running == SCHED_SETUP ? PSTR("setup") : PSTR("idle");
+}
+
+// 重置原因名稱（PROGMEM；多個位元同時成立時取最具診斷意義者）
+static const char* resetCauseName(uint8_t cause) {
+  if (cause & HAL_RESET_WATCHDOG) return PSTR("watchdog");
+  if (cause & HAL_RESET_BROWNOUT) return PSTR("brownout");
+  if (cause & HAL_RESET_EXTERNAL) return PSTR("external");
+  if (cause & HAL_RESET_POWERON) return PSTR("poweron");
+  return PSTR("unknown");
+}
+
+// 開機時接管 .noinit 紀錄：有效且非上電則保存為上次紀錄，再為本次開機重新計數
+static void resetRecordBegin() {
+  uint8_t cause = halResetCause();
+  if (resetRec.magic == RESET_REC_MAGIC && !(cause & HAL_RESET_POWERON)) {
+    prevRec = resetRec;
   } else {
-    // 單次命令回覆解析
-    while (BUS_SERIAL.available()) {
-      char c = (char)BUS_SERIAL.read();
-      if (busBufLen < sizeof(busBuf) - 1) {
-        busBuf[busBufLen++] = c;
-      }
+    memset(&prevRec, 0, sizeof(prevRec));
+    resetRec.boots = 0;
+  }
+  resetRec.magic = RESET_REC_MAGIC;
+  resetRec.boots++;
+  resetRec.cause = cause;
+  resetRec.wdtGapMaxMs = 0;
+  memset(&resetRec.loop, 0, sizeof(resetRec.loop));
+  resetRec.loop.running = SCHED_SETUP;
+}
 
-      if (c == '!' || c == '\n' || c == '\r' || busBufLen >= sizeof(busBuf) - 1) {
-        busBuf[busBufLen] = '\0';
-
-        // 提取整數
-        int values[4];
-        int vcount = 0;
-        char* ptr = busBuf;
-        char num[16];
-        int numLen = 0;
-
-        while (*ptr && vcount < 4) {
-          if ((*ptr >= '0' && *ptr <= '9') || *ptr == '-') {
-            if (numLen < 15) num[numLen++] = *ptr;
-          } else {
-            if (numLen > 0) {
-              num[numLen] = '\0';
-              values[vcount++] = atoi(num);
-              numLen = 0;
-            }
-          }
-          ptr++;
-        }
-        if (numLen > 0 && vcount < 4) {
-          num[numLen] = '\0';
-          values[vcount++] = atoi(num);
-        }
-
-        // 根據最後指令類型輸出 JSON
-        if (lastBusCmd == BUS_READ_ANGLE && vcount >= 1) {
-          Serial.print("{\"id\":");
-          Serial.print(lastBusId);
-          Serial.print(",\"angle\":");
-          Serial.print(values[0]);
-          Serial.println("}");
-        } else if (lastBusCmd == BUS_READ_VOLTEMP && vcount >= 2) {
-          Serial.print("{\"id\":");
-          Serial.print(lastBusId);
-          Serial.print(",\"voltage\":");
-          Serial.print(values[0]);
-          Serial.print(",\"temp\":");
-          Serial.print(values[1]);
-          Serial.println("}");
-        } else {
-          // 解析失敗則原樣透傳
-          Serial.print(busBuf);
-        }
-
-        // 重置狀態
-        lastBusCmd = BUS_NONE;
-        lastBusId = -1;
-        clearBuf(busBuf, busBufLen);
-        break;
-      }
-    }
+// cause / mcusr / boots 欄位；有上次紀錄時附上重置前執行中的任務與最大值
+static void writeResetRecord() {
+  json.fieldStrP(PSTR("cause"), resetCauseName(resetRec.cause))
+      .field(PSTR("mcusr"), resetRec.cause)
+      .field(PSTR("boots"), resetRec.boots);
+  if (prevRec.magic != RESET_REC_MAGIC) return;
+  json.fieldStrP(PSTR("last_task"), taskName(prevRec.loop.running))
+      .field(PSTR("last_loop_max_us"), prevRec.loop.maxUs)
+      .field(PSTR("last_wdt_gap_ms"), prevRec.wdtGapMaxMs);
+}
+
+static void printProfile() {
+  const LoopProfile& lp = resetRec.loop;
+  json.begin()
+      .fieldStrP(PSTR("unit"), PSTR("us"))
+      .object(PSTR("loop"))
+      .field(PSTR("n"), lp.periods)
+      .field(PSTR("mean"), lp.periods ? lp.totalUs / lp.periods : 0)
+      .field(PSTR("max"), lp.maxUs)
+      .closeObject()
+      .field(PSTR("wdt_timeout_ms"), WDT_TIMEOUT_MS)
+      .field(PSTR("wdt_gap_max_ms"), resetRec.wdtGapMaxMs)
+      .field(PSTR("wdt_margin_ms"), (long)WDT_TIMEOUT_MS - (long)resetRec.wdtGapMaxMs)
+      .object(PSTR("tasks"));
+  for (uint8_t i = 0; i < TASK_COUNT; i++) {
+    const TaskStats& t = taskStats[i];
+    json.object(taskName(i))
+        .field(PSTR("n"), t.runs)
+        .field(PSTR("mean"), t.runs ? t.totalUs / t.runs : 0)
+        .field(PSTR("max"), t.maxUs)
+        .closeObject();
+  }
+  json.closeObject();
+  writeResetRecord();
+  json.end();
+}
+
+static void resetProfile() {
+  schedulerResetProfile(taskStats, TASK_COUNT, resetRec.loop);
+  resetRec.wdtGapMaxMs = 0;
+}
+
+void setup() {
+  // 禁用看門狗（防止啟動時重置）
+  halWatchdogDisable();
+  resetRecordBegin();
+
+  setup_led();
+  setup_beep();
+  setup_laser();  // 初始化雷射控制
+  setup_keys();   // 初始化按鍵
+  setup_uart();
+  setup_bus();
+  setup_rx_pump();  // 啟動中斷驅動接收
+
+  pcOut.print(F("{\"status\":\"info\",\"message\":\"PT2D Bridge Firmware v"));
+  pcOut.print(FIRMWARE_VERSION);
+  pcOut.println(F("\"}"));
+  pcOut.println(F("{\"status\":\"info\",\"message\":\"PC <...> / BUS #...!\"}"));
+  json.begin().fieldStrP(PSTR("status"), PSTR("info")).fieldStrP(PSTR("message"), PSTR("重置原因"));
+  writeResetRecord();
+  json.end();
+  beepStart(3);
+
+  // 啟動時驗證預設舵機 ID 是否存在（讀取電壓確認）
+  pcOut.print(F("{\"status\":\"info\",\"message\":\"等待舵機啟動中...\",\"wait_ms\":"));
+  pcOut.print(SERVO_STARTUP_DELAY);
+  pcOut.println(F("}"));
+
+  // 等待舵機啟動（默認1秒，可調整），期間繼續播放蜂鳴
+  unsigned long startupEnd = halMillis() + SERVO_STARTUP_DELAY;
+  while (!deadlineReached(halMillis(), startupEnd)) {
+    taskBuzzer();
+  }
+
+  verifyServoPresence(NULL);
+  while (verifyPending != 0) {
+    taskBusRx();
+    taskBuzzer();
   }
 
-  delay(5);
+  // 檢查舵機 ID 是否有效
+  if (panServoId == 0 || tiltServoId == 0 || panServoId == tiltServoId) {
+    // 舵機設置失敗，通知上位機，啟用軟停機（不阻塞）
+    pcOut.print(F("{\"status\":\"error\",\"message\":\"舵機ID設置失敗\",\"pan_id\":"));
+    pcOut.print(panServoId);
+    pcOut.print(F(",\"tilt_id\":"));
+    pcOut.print(tiltServoId);
+    pcOut.println(F("}"));
+
+    pcOut.println(F("{\"status\":\"error\",\"message\":\"舵機控制已禁用，請檢查硬體連接\"}"));
+    servoDisabled = true;
+  }
+
+  pcOut.print(F("{\"status\":\"ok\",\"message\":\"舵機ID已設置\",\"pan_id\":"));
+  pcOut.print(panServoId);
+  pcOut.print(F(",\"tilt_id\":"));
+  pcOut.print(tiltServoId);
+  pcOut.print(F(",\"pan_min\":"));
+  pcOut.print(PAN_MIN_ANGLE);
+  pcOut.print(F(",\"pan_max\":"));
+  pcOut.print(PAN_MAX_ANGLE);
+  pcOut.print(F(",\"tilt_min\":"));
+  pcOut.print(TILT_MIN_ANGLE);
+  pcOut.print(F(",\"tilt_max\":"));
+  pcOut.print(TILT_MAX_ANGLE);
+  pcOut.println(F("}"));
+
+  if (!servoDisabled) seedAxisModel();
+
+  // 啟用看門狗定時器（2秒超時）
+  halWatchdogEnable();
+  wdtLastFeed = halMillis();
+  pcOut.println(F("{\"status\":\"ok\",\"message\":\"看門狗已啟用 (2秒)\"}"));
+}
+
+void loop() {
+  // 協作式排程：所有任務非阻塞，不再使用 delay()
+  schedulerRun(tasks, taskStats, TASK_COUNT, resetRec.loop);
 }